@@ -13,20 +13,27 @@ vk_buffer::vk_buffer(vk_device& device,
                      vk::BufferUsageFlags buffer_usage,
                      VmaMemoryUsage memory_usage,
                      VmaAllocationCreateFlags flags,
-                     const std::vector<uint32_t>& queue_family_indices) :
-    vk_unit(nullptr, &device), size(size_)
+                     const std::vector<uint32_t>& queue_family_indices,
+                     MemoryCategory category) :
+    vk_unit(nullptr, &device), size(size_), category(category), usage(buffer_usage)
 {
     persistent = (flags & VMA_ALLOCATION_CREATE_MAPPED_BIT) != 0;
 
     vk::BufferCreateInfo buffer_create_info({}, size, buffer_usage);
     if (queue_family_indices.size() >= 2) {
+        concurrent                               = true;
         buffer_create_info.sharingMode           = vk::SharingMode::eConcurrent;
         buffer_create_info.queueFamilyIndexCount = static_cast<uint32_t>(queue_family_indices.size());
         buffer_create_info.pQueueFamilyIndices   = queue_family_indices.data();
     }
 
+    auto& telemetry = device.get_memory_telemetry();
+    if (!telemetry.request(category, size)) {
+        throw MemoryBudgetExceeded{fmt::format("创建缓冲区失败: 内存类别 {} 超出预算", to_string(category))};
+    }
+
     VmaAllocationCreateInfo memory_info{};
-    memory_info.flags = flags;
+    memory_info.flags = flags | telemetry.get_allocation_flags(category);
     memory_info.usage = memory_usage;
 
     VmaAllocationInfo allocation_info{};
@@ -36,10 +43,23 @@ vk_buffer::vk_buffer(vk_device& device,
                                   reinterpret_cast<VkBuffer*>(&handle()), &allocation,
                                   &allocation_info);
 
+    // 超出堆预算时先让该类别回收一部分再重试一次
+    if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY && telemetry.evict(category, size)) {
+        result = vmaCreateBuffer(device.get_memory_allocator(),
+                                 reinterpret_cast<VkBufferCreateInfo*>(&buffer_create_info), &memory_info,
+                                 reinterpret_cast<VkBuffer*>(&handle()), &allocation,
+                                 &allocation_info);
+    }
+
     if (result != VK_SUCCESS) {
         throw VulkanException{vk::Result(result), "创建缓冲区失败"};
     }
 
+    allocation_size = allocation_info.size;
+    telemetry.on_allocated(category, allocation_size);
+    vmaSetAllocationName(device.get_memory_allocator(), allocation, to_string(category));
+    vmaSetAllocationUserData(device.get_memory_allocator(), allocation, &owner);
+
     memory = static_cast<vk::DeviceMemory>(allocation_info.deviceMemory);
 
     if (persistent) {
@@ -53,13 +73,24 @@ vk_buffer::vk_buffer(vk_buffer&& other) noexcept :
     memory(std::exchange(other.memory, {})),
     size(std::exchange(other.size, {})),
     mapped_data(std::exchange(other.mapped_data, {})),
-    mapped(std::exchange(other.mapped, {})) {}
+    persistent(std::exchange(other.persistent, {})),
+    mapped(std::exchange(other.mapped, {})),
+    category(other.category),
+    allocation_size(std::exchange(other.allocation_size, {})),
+    usage(other.usage),
+    concurrent(other.concurrent)
+{
+    if (allocation != VK_NULL_HANDLE) {
+        vmaSetAllocationUserData(device().get_memory_allocator(), allocation, &owner);
+    }
+}
 
 vk_buffer::~vk_buffer()
 {
     if (handle() && (allocation != VK_NULL_HANDLE)) {
         unmap();
         vmaDestroyBuffer(device().get_memory_allocator(), static_cast<VkBuffer>(handle()), allocation);
+        device().get_memory_telemetry().on_freed(category, allocation_size);
     }
 }
 
@@ -73,6 +104,45 @@ vk::DeviceMemory vk_buffer::get_memory() const
     return memory;
 }
 
+MemoryCategory vk_buffer::get_memory_category() const
+{
+    return category;
+}
+
+vk::BufferUsageFlags vk_buffer::get_usage() const
+{
+    return usage;
+}
+
+bool vk_buffer::is_movable() const
+{
+    constexpr vk::BufferUsageFlags copy_usage = vk::BufferUsageFlagBits::eTransferSrc
+                                                | vk::BufferUsageFlagBits::eTransferDst;
+
+    return allocation != VK_NULL_HANDLE && !concurrent && !mapped
+           && (usage & copy_usage) == copy_usage
+           && category != MemoryCategory::FrameRing
+           && category != MemoryCategory::Staging
+           && category != MemoryCategory::RenderTarget;
+}
+
+void vk_buffer::replace_handle(vk::Buffer new_handle)
+{
+    device().handle().destroyBuffer(handle());
+    set_handle(new_handle);
+}
+
+void vk_buffer::refresh_allocation_info()
+{
+    VmaAllocationInfo allocation_info{};
+    vmaGetAllocationInfo(device().get_memory_allocator(), allocation, &allocation_info);
+
+    memory = static_cast<vk::DeviceMemory>(allocation_info.deviceMemory);
+    if (persistent) {
+        mapped_data = static_cast<uint8_t*>(allocation_info.pMappedData);
+    }
+}
+
 vk::DeviceSize vk_buffer::get_size() const
 {
     return size;
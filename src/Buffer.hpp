@@ -9,6 +9,7 @@
 
 #include "VkUnit.hpp"
 #include "VkCommon.hpp"
+#include "MemoryTelemetry.hpp"
 
 class vk_buffer : public vk_unit<vk::Buffer>
 {
@@ -18,7 +19,8 @@ public:
               vk::BufferUsageFlags buffer_usage,
               VmaMemoryUsage memory_usage,
               VmaAllocationCreateFlags flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
-              const std::vector<uint32_t>& queue_family_indices = {});
+              const std::vector<uint32_t>& queue_family_indices = {},
+              MemoryCategory category = MemoryCategory::Other);
 
     vk_buffer(vk_buffer&& other) noexcept;
 
@@ -31,6 +33,23 @@ public:
     VmaAllocation get_allocation() const;
     const uint8_t* get_data() const;
     vk::DeviceMemory get_memory() const;
+    MemoryCategory get_memory_category() const;
+    vk::BufferUsageFlags get_usage() const;
+
+    /**
+     * @brief 是否可以被碎片整理移动：独占访问、带有拷贝用途、未被临时映射，且不属于每帧复用的类别
+     */
+    bool is_movable() const;
+
+    /**
+     * @brief 碎片整理时替换句柄，旧句柄会被销毁；调用方需保证 GPU 已不再使用旧句柄
+     */
+    void replace_handle(vk::Buffer new_handle);
+
+    /**
+     * @brief 分配被移动后重新读取内存与持久映射地址
+     */
+    void refresh_allocation_info();
 
     /**
      * @return Return the buffer's device address (note: requires that the buffer has been created with the VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT usage fla)
@@ -99,4 +118,9 @@ private:
     uint8_t          * mapped_data = nullptr;
     bool             persistent    = false;        // Whether the buffer is persistently mapped or not
     bool             mapped        = false;        // Whether the buffer has been mapped with vmaMapMemory
+    MemoryCategory   category      = MemoryCategory::Other;
+    vk::DeviceSize   allocation_size = 0;              // VMA 实际分配的大小，用于类别统计
+    vk::BufferUsageFlags usage;
+    bool             concurrent    = false;
+    AllocationOwner  owner{AllocationOwner::Kind::Buffer, this};
 };
\ No newline at end of file
@@ -12,7 +12,7 @@
 
 vk_buffer_block::vk_buffer_block(vk_device& device, vk::DeviceSize size, vk::BufferUsageFlags usage,
                                  VmaMemoryUsage memory_usage) :
-    buffer{device, size, usage, memory_usage}
+    buffer{device, size, usage, memory_usage, VMA_ALLOCATION_CREATE_MAPPED_BIT, {}, MemoryCategory::FrameRing}
 {
     if (usage == vk::BufferUsageFlagBits::eUniformBuffer) {
         alignment = device.get_gpu().properties().limits.minUniformBufferOffsetAlignment;
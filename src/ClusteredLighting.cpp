@@ -0,0 +1,408 @@
+﻿/**
+ * @File ClusteredLighting.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "ClusteredLighting.hpp"
+#include "RenderFrame.hpp"
+#include "Profiler.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VK_CLUSTER_SSE 1
+#elif defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define VK_CLUSTER_NEON 1
+#endif
+
+namespace {
+constexpr uint32_t SIMD_WIDTH = 4;
+
+#if defined(VK_CLUSTER_SSE)
+using float4 = __m128;
+
+inline float4 load(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, float4 v) { _mm_storeu_ps(p, v); }
+inline float4 splat(float v) { return _mm_set1_ps(v); }
+inline float4 add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+inline float4 sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+inline float4 mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+inline float4 div(float4 a, float4 b) { return _mm_div_ps(a, b); }
+inline float4 min(float4 a, float4 b) { return _mm_min_ps(a, b); }
+inline float4 max(float4 a, float4 b) { return _mm_max_ps(a, b); }
+#elif defined(VK_CLUSTER_NEON)
+using float4 = float32x4_t;
+
+inline float4 load(const float* p) { return vld1q_f32(p); }
+inline void store(float* p, float4 v) { vst1q_f32(p, v); }
+inline float4 splat(float v) { return vdupq_n_f32(v); }
+inline float4 add(float4 a, float4 b) { return vaddq_f32(a, b); }
+inline float4 sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+inline float4 mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+inline float4 div(float4 a, float4 b) { return vdivq_f32(a, b); }
+inline float4 min(float4 a, float4 b) { return vminq_f32(a, b); }
+inline float4 max(float4 a, float4 b) { return vmaxq_f32(a, b); }
+#else
+struct float4
+{
+    float v[SIMD_WIDTH];
+};
+
+template<typename Op>
+inline float4 apply(float4 a, float4 b, Op op)
+{
+    float4 r;
+    for (uint32_t i = 0; i < SIMD_WIDTH; ++i) {
+        r.v[i] = op(a.v[i], b.v[i]);
+    }
+    return r;
+}
+
+inline float4 load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void store(float* p, float4 v) { std::copy(v.v, v.v + SIMD_WIDTH, p); }
+inline float4 splat(float v) { return {{v, v, v, v}}; }
+inline float4 add(float4 a, float4 b) { return apply(a, b, [](float x, float y) { return x + y; }); }
+inline float4 sub(float4 a, float4 b) { return apply(a, b, [](float x, float y) { return x - y; }); }
+inline float4 mul(float4 a, float4 b) { return apply(a, b, [](float x, float y) { return x * y; }); }
+inline float4 div(float4 a, float4 b) { return apply(a, b, [](float x, float y) { return x / y; }); }
+inline float4 min(float4 a, float4 b) { return apply(a, b, [](float x, float y) { return std::min(x, y); }); }
+inline float4 max(float4 a, float4 b) { return apply(a, b, [](float x, float y) { return std::max(x, y); }); }
+#endif
+
+inline float4 min(float4 a, float4 b, float4 c, float4 d) { return min(min(a, b), min(c, d)); }
+inline float4 max(float4 a, float4 b, float4 c, float4 d) { return max(max(a, b), max(c, d)); }
+
+/**
+ * @brief 浮点 tile 坐标 [lo, hi] 转为整数闭区间，与屏幕不相交时返回 false
+ */
+inline bool to_tile_range(float lo, float hi, uint32_t tiles, uint16_t& first, uint16_t& last)
+{
+    if (hi < 0.0f || lo >= static_cast<float>(tiles)) {
+        return false;
+    }
+
+    first = static_cast<uint16_t>(std::max(lo, 0.0f));
+    last  = static_cast<uint16_t>(std::min(hi, static_cast<float>(tiles - 1)));
+    return true;
+}
+}        // namespace
+
+vk_clustered_lighting::vk_clustered_lighting(const ClusterConfig& config) :
+    config{config}
+{
+    assert(config.tiles_x > 0 && config.tiles_y > 0 && config.slices > 0);
+    assert(config.tiles_x <= UINT16_MAX && config.tiles_y <= UINT16_MAX && config.slices <= UINT16_MAX);
+    assert(config.near_plane > 0.0f && config.far_plane > config.near_plane);
+}
+
+void vk_clustered_lighting::build(const std::vector<PointLight>& lights, const glm::mat4& view,
+                                  const glm::mat4& proj, uint32_t width, uint32_t height)
+{
+    PROFILE_SCOPE("vk_clustered_lighting::build");
+
+    const auto count  = static_cast<uint32_t>(lights.size());
+    const auto padded = (count + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+
+    // 补齐的光源位于相机后方且半径为 0，总是不可见
+    center_x.assign(padded, 0.0f);
+    center_y.assign(padded, 0.0f);
+    center_z.assign(padded, 1.0f);
+    radius.assign(padded, 0.0f);
+
+    gpu_lights.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const auto& light    = lights[i];
+        glm::vec4   position = view * glm::vec4(light.position, 1.0f);
+
+        center_x[i] = position.x;
+        center_y[i] = position.y;
+        center_z[i] = position.z;
+        radius[i]   = light.radius;
+
+        gpu_lights[i].position_radius = glm::vec4(glm::vec3(position), light.radius);
+        gpu_lights[i].color_intensity = glm::vec4(light.color, light.intensity);
+    }
+
+    // slice = log(depth) * scale - bias，与片段着色器一致
+    const float log_ratio = std::log(config.far_plane / config.near_plane);
+
+    params.grid    = glm::uvec4(config.tiles_x, config.tiles_y, config.slices, count);
+    params.screen  = glm::vec4(static_cast<float>(config.tiles_x) / static_cast<float>(width),
+                               static_cast<float>(config.tiles_y) / static_cast<float>(height), 0.0f, 0.0f);
+    params.depth   = glm::vec4(static_cast<float>(config.slices) / log_ratio,
+                               static_cast<float>(config.slices) * std::log(config.near_plane) / log_ratio,
+                               config.near_plane, config.far_plane);
+    params.ambient = glm::vec4(config.ambient, 0.0f);
+
+    compute_ranges(proj);
+
+    const uint32_t cluster_count = get_cluster_count();
+
+    stats        = {};
+    stats.lights = count;
+
+    counts.assign(cluster_count, 0);
+    for (const auto& range: ranges) {
+        if (range.x0 > range.x1) {
+            continue;
+        }
+        ++stats.visible_lights;
+
+        for (uint32_t z = range.z0; z <= range.z1; ++z) {
+            for (uint32_t y = range.y0; y <= range.y1; ++y) {
+                uint32_t row = (z * config.tiles_y + y) * config.tiles_x;
+                for (uint32_t x = range.x0; x <= range.x1; ++x) {
+                    ++counts[row + x];
+                }
+            }
+        }
+    }
+
+    // 前缀和得到每个簇在紧凑列表中的偏移，counts 改为截断后的容量
+    cells.resize(cluster_count);
+    uint32_t offset = 0;
+    for (uint32_t c = 0; c < cluster_count; ++c) {
+        uint32_t capacity = std::min(counts[c], config.max_lights_per_cluster);
+
+        stats.max_cluster_lights = std::max(stats.max_cluster_lights, counts[c]);
+        stats.dropped += counts[c] - capacity;
+
+        cells[c]  = glm::uvec2(offset, 0u);
+        counts[c] = capacity;
+        offset += capacity;
+    }
+
+    light_indices.resize(offset);
+    stats.light_indices = offset;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const auto& range = ranges[i];
+        if (range.x0 > range.x1) {
+            continue;
+        }
+
+        for (uint32_t z = range.z0; z <= range.z1; ++z) {
+            for (uint32_t y = range.y0; y <= range.y1; ++y) {
+                uint32_t row = (z * config.tiles_y + y) * config.tiles_x;
+                for (uint32_t x = range.x0; x <= range.x1; ++x) {
+                    auto& cell = cells[row + x];
+                    if (cell.y < counts[row + x]) {
+                        light_indices[cell.x + cell.y++] = i;
+                    }
+                }
+            }
+        }
+    }
+
+    FrameProfiler::get().record_counter("vk_clustered_lighting", "visible_lights", stats.visible_lights);
+    FrameProfiler::get().record_counter("vk_clustered_lighting", "light_indices", stats.light_indices);
+}
+
+bool vk_clustered_lighting::upload(vk_render_frame& frame, size_t thread_index)
+{
+    allocations.clear();
+    buffer_infos.clear();
+
+    auto allocate = [&](uint32_t binding, VkBufferUsageFlags usage, const void* data, VkDeviceSize size) {
+        // 没有光源时也需要绑定合法的缓冲区
+        VkDeviceSize allocation_size = std::max<VkDeviceSize>(size, 16);
+
+        auto allocation = frame.allocate_buffer(usage, allocation_size, thread_index);
+        if (allocation.empty()) {
+            LOGE("分配分簇光照缓冲区失败 ({} 字节)", allocation_size);
+            return false;
+        }
+
+        if (size > 0) {
+            allocation.get_buffer().update(reinterpret_cast<const uint8_t*>(data), size, allocation.get_offset());
+        }
+
+        buffer_infos[binding][0] = {allocation.get_buffer().handle(), allocation.get_offset(), allocation_size};
+        allocations.push_back(std::move(allocation));
+        return true;
+    };
+
+    return allocate(0, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, &params, sizeof(ClusterParams)) &&
+           allocate(1, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, gpu_lights.data(), gpu_lights.size() * sizeof(GpuLight)) &&
+           allocate(2, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, cells.data(), cells.size() * sizeof(glm::uvec2)) &&
+           allocate(3, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, light_indices.data(),
+                    light_indices.size() * sizeof(uint32_t));
+}
+
+const BindingMap<VkDescriptorBufferInfo>& vk_clustered_lighting::get_buffer_infos() const
+{
+    return buffer_infos;
+}
+
+const ClusterConfig& vk_clustered_lighting::get_config() const
+{
+    return config;
+}
+
+const ClusterParams& vk_clustered_lighting::get_params() const
+{
+    return params;
+}
+
+const std::vector<GpuLight>& vk_clustered_lighting::get_lights() const
+{
+    return gpu_lights;
+}
+
+const std::vector<glm::uvec2>& vk_clustered_lighting::get_cells() const
+{
+    return cells;
+}
+
+const std::vector<uint32_t>& vk_clustered_lighting::get_light_indices() const
+{
+    return light_indices;
+}
+
+const ClusterStats& vk_clustered_lighting::get_stats() const
+{
+    return stats;
+}
+
+uint32_t vk_clustered_lighting::get_cluster_count() const
+{
+    return config.tiles_x * config.tiles_y * config.slices;
+}
+
+const char* vk_clustered_lighting::get_simd_name()
+{
+#if defined(VK_CLUSTER_SSE)
+    return "SSE";
+#elif defined(VK_CLUSTER_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+void vk_clustered_lighting::compute_ranges(const glm::mat4& proj)
+{
+    const auto count = static_cast<uint32_t>(gpu_lights.size());
+    ranges.resize(count);
+
+    // tile = ndc * half_tiles + half_tiles，ndc = proj[0][0] * x / depth；y 翻转时 proj[1][1] 为负，极值仍取四个角
+    const float half_x = 0.5f * static_cast<float>(config.tiles_x);
+    const float half_y = 0.5f * static_cast<float>(config.tiles_y);
+
+    const float4 scale_x = splat(proj[0][0] * half_x);
+    const float4 scale_y = splat(proj[1][1] * half_y);
+    const float4 bias_x  = splat(half_x);
+    const float4 bias_y  = splat(half_y);
+    const float4 near_plane = splat(config.near_plane);
+    const float4 far_plane  = splat(config.far_plane);
+    const float4 zero       = splat(0.0f);
+    const float4 one        = splat(1.0f);
+
+    alignas(16) float tile_x0[SIMD_WIDTH], tile_x1[SIMD_WIDTH];
+    alignas(16) float tile_y0[SIMD_WIDTH], tile_y1[SIMD_WIDTH];
+    alignas(16) float depth_min[SIMD_WIDTH], depth_max[SIMD_WIDTH];
+
+    for (uint32_t base = 0; base < count; base += SIMD_WIDTH) {
+        float4 cx = load(&center_x[base]);
+        float4 cy = load(&center_y[base]);
+        float4 r  = load(&radius[base]);
+
+        // 相机朝 -z，深度为 -z；深度范围截到 [near, far]，为空时光源不可见
+        float4 depth  = sub(zero, load(&center_z[base]));
+        float4 d_min  = max(sub(depth, r), near_plane);
+        float4 d_max  = min(add(depth, r), far_plane);
+        float4 inv_lo = div(one, d_min);
+        float4 inv_hi = div(one, max(d_max, near_plane));
+
+        float4 x_lo = mul(scale_x, sub(cx, r));
+        float4 x_hi = mul(scale_x, add(cx, r));
+        float4 y_lo = mul(scale_y, sub(cy, r));
+        float4 y_hi = mul(scale_y, add(cy, r));
+
+        store(tile_x0, add(min(mul(x_lo, inv_lo), mul(x_lo, inv_hi), mul(x_hi, inv_lo), mul(x_hi, inv_hi)), bias_x));
+        store(tile_x1, add(max(mul(x_lo, inv_lo), mul(x_lo, inv_hi), mul(x_hi, inv_lo), mul(x_hi, inv_hi)), bias_x));
+        store(tile_y0, add(min(mul(y_lo, inv_lo), mul(y_lo, inv_hi), mul(y_hi, inv_lo), mul(y_hi, inv_hi)), bias_y));
+        store(tile_y1, add(max(mul(y_lo, inv_lo), mul(y_lo, inv_hi), mul(y_hi, inv_lo), mul(y_hi, inv_hi)), bias_y));
+        store(depth_min, d_min);
+        store(depth_max, d_max);
+
+        for (uint32_t lane = 0; lane < SIMD_WIDTH && base + lane < count; ++lane) {
+            auto& range = ranges[base + lane];
+            if (!(depth_min[lane] <= depth_max[lane]) ||
+                !to_tile_range(tile_x0[lane], tile_x1[lane], config.tiles_x, range.x0, range.x1) ||
+                !to_tile_range(tile_y0[lane], tile_y1[lane], config.tiles_y, range.y0, range.y1)) {
+                range = {1, 0, 1, 0, 1, 0};
+                continue;
+            }
+
+            range.z0 = static_cast<uint16_t>(depth_to_slice(depth_min[lane]));
+            range.z1 = static_cast<uint16_t>(depth_to_slice(depth_max[lane]));
+        }
+    }
+}
+
+uint32_t vk_clustered_lighting::depth_to_slice(float depth) const
+{
+    float slice = std::log(depth) * params.depth.x - params.depth.y;
+    return static_cast<uint32_t>(std::clamp(slice, 0.0f, static_cast<float>(config.slices - 1)));
+}
+
+void run_light_clustering_benchmark(uint32_t width, uint32_t height)
+{
+    using clock = std::chrono::high_resolution_clock;
+
+    ClusterConfig config;
+    config.near_plane = 0.1f;
+    config.far_plane  = 100.0f;
+
+    vk_clustered_lighting clustering{config};
+
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+                                 glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(60.0f), static_cast<float>(width) / static_cast<float>(height),
+                                      config.near_plane, config.far_plane);
+    proj[1][1] *= -1;
+
+    std::printf("Light clustering benchmark: %ux%ux%u clusters, %ux%u, %s\n", config.tiles_x, config.tiles_y,
+                config.slices, width, height, vk_clustered_lighting::get_simd_name());
+
+    constexpr int ITERATIONS = 20;
+
+    for (uint32_t light_count = 16; light_count <= 16384; light_count *= 2) {
+        // 光源填满相机前方的一个盒子，半径固定，数量增加时每个簇的光源数随之增加
+        std::mt19937                          rng{42};
+        std::uniform_real_distribution<float> xy{-40.0f, 40.0f};
+        std::uniform_real_distribution<float> z{-90.0f, -1.0f};
+        std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+
+        std::vector<PointLight> lights(light_count);
+        for (auto& light: lights) {
+            light.position = {xy(rng), xy(rng), z(rng)};
+            light.radius   = 4.0f;
+            light.color    = {unit(rng), unit(rng), unit(rng)};
+        }
+
+        clustering.build(lights, view, proj, width, height);        // 预热
+
+        auto start = clock::now();
+        for (int i = 0; i < ITERATIONS; ++i) {
+            clustering.build(lights, view, proj, width, height);
+        }
+        double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count() / ITERATIONS;
+
+        const auto& stats = clustering.get_stats();
+        std::printf("  %6u lights  %8.3f ms  %6u visible  %8u indices  max %4u per cluster  %u dropped\n",
+                    light_count, ms, stats.visible_lights, stats.light_indices, stats.max_cluster_lights,
+                    stats.dropped);
+    }
+}
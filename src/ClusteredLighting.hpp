@@ -0,0 +1,164 @@
+﻿/**
+ * @File ClusteredLighting.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 分簇前向光照：把点光源分配到视空间的簇（froxel）中，着色时只遍历所在簇的光源
+ */
+
+#pragma once
+
+#include "VkCommon.hpp"
+#include "BufferPool.hpp"
+
+#include <glm/glm.hpp>
+
+class vk_render_frame;
+
+struct PointLight
+{
+    glm::vec3 position{0.0f};        // 世界空间
+    float     radius{1.0f};          // 影响半径，之外衰减为 0
+    glm::vec3 color{1.0f};
+    float     intensity{1.0f};
+};
+
+/**
+ * @brief 上传给着色器的光源（std430），位置已变换到视空间
+ */
+struct GpuLight
+{
+    glm::vec4 position_radius{0.0f};
+    glm::vec4 color_intensity{0.0f};
+};
+
+/**
+ * @brief 与片段着色器中的 ClusterParams 块一致（std140）
+ */
+struct ClusterParams
+{
+    glm::uvec4 grid{0u};            // xyz: 各方向的簇数，w: 光源数
+    glm::vec4  screen{0.0f};        // xy: tile 像素大小的倒数
+    glm::vec4  depth{0.0f};         // x: slice_scale, y: slice_bias, z: near, w: far
+    glm::vec4  ambient{0.0f};
+};
+
+struct ClusterConfig
+{
+    uint32_t tiles_x{16};
+    uint32_t tiles_y{9};
+    uint32_t slices{24};        // 深度方向按指数划分，远处的簇更厚
+
+    float near_plane{0.1f};
+    float far_plane{10.0f};
+
+    // 超出时丢弃提交顺序靠后的光源，限制索引缓冲区的上限
+    uint32_t max_lights_per_cluster{256};
+
+    glm::vec3 ambient{0.1f};
+};
+
+struct ClusterStats
+{
+    uint32_t lights{0};
+    uint32_t visible_lights{0};           // 与至少一个簇相交
+    uint32_t light_indices{0};
+    uint32_t max_cluster_lights{0};       // 截断前单个簇的最大光源数
+    uint32_t dropped{0};                  // 因 max_lights_per_cluster 丢弃的索引数
+};
+
+/**
+ * @brief 在 CPU 上为光源分簇，结果上传到当前帧缓冲区池分配的缓冲区
+ *
+ * - 光源以 SoA 布局、按 SSE / NEON 宽度一次处理多个：变换到视空间，求包围盒在屏幕 tile 上的范围
+ *   （取视空间 AABB 四个角的投影极值，保守），深度范围取对数得到 slice 范围
+ * - 统计每个簇的光源数，前缀和得到紧凑索引列表中的偏移，再按光源顺序写入，不使用原子操作
+ * - 投影需为对称透视投影，允许 Vulkan 的 y 翻转
+ *
+ * 用法：build() -> upload() -> 以 get_buffer_infos() 请求描述符集，着色器中的绑定：
+ * 0 ClusterParams (uniform)，1 光源，2 每簇的 (offset, count)，3 光源索引
+ */
+class vk_clustered_lighting
+{
+public:
+    explicit vk_clustered_lighting(const ClusterConfig& config = {});
+
+    vk_clustered_lighting(const vk_clustered_lighting&) = delete;
+    vk_clustered_lighting(vk_clustered_lighting&&) = delete;
+
+    vk_clustered_lighting& operator=(const vk_clustered_lighting&) = delete;
+    vk_clustered_lighting& operator=(vk_clustered_lighting&&) = delete;
+
+    /**
+     * @param view 世界到视空间的变换，相机朝 -z
+     * @param width, height 帧缓冲区的像素大小
+     */
+    void build(const std::vector<PointLight>& lights, const glm::mat4& view, const glm::mat4& proj,
+               uint32_t width, uint32_t height);
+
+    /**
+     * @brief 把 build() 的结果写入当前帧的 uniform / storage 缓冲区，分配失败时返回 false
+     */
+    bool upload(vk_render_frame& frame, size_t thread_index = 0);
+
+    const BindingMap<VkDescriptorBufferInfo>& get_buffer_infos() const;
+
+    const ClusterConfig& get_config() const;
+
+    const ClusterParams& get_params() const;
+
+    const std::vector<GpuLight>& get_lights() const;
+
+    /**
+     * @brief 每簇的 (offset, count)，簇下标为 (slice * tiles_y + y) * tiles_x + x
+     */
+    const std::vector<glm::uvec2>& get_cells() const;
+
+    const std::vector<uint32_t>& get_light_indices() const;
+
+    const ClusterStats& get_stats() const;
+
+    uint32_t get_cluster_count() const;
+
+    static const char* get_simd_name();
+
+private:
+    /**
+     * @brief 一个光源覆盖的簇范围（闭区间），不可见时 x0 > x1
+     */
+    struct ClusterRange
+    {
+        uint16_t x0, x1;
+        uint16_t y0, y1;
+        uint16_t z0, z1;
+    };
+
+    void compute_ranges(const glm::mat4& proj);
+
+    uint32_t depth_to_slice(float depth) const;
+
+    ClusterConfig config;
+    ClusterParams params;
+
+    // 视空间的 SoA 光源，长度按 SIMD 宽度补齐
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> radius;
+
+    std::vector<ClusterRange> ranges;
+
+    std::vector<GpuLight>   gpu_lights;
+    std::vector<glm::uvec2> cells;
+    std::vector<uint32_t>   counts;
+    std::vector<uint32_t>   light_indices;
+
+    ClusterStats stats;
+
+    std::vector<vk_buffer_allocation>  allocations;
+    BindingMap<VkDescriptorBufferInfo> buffer_infos;
+};
+
+/**
+ * @brief 分簇基准：随机分布的光源，数量从 16 倍增到 16384，统计 CPU 分簇耗时与索引数量
+ */
+void run_light_clustering_benchmark(uint32_t width = 1920, uint32_t height = 1080);
@@ -8,7 +8,10 @@
 #include "CommandBuffer.hpp"
 #include "Debug.hpp"
 #include "Device.hpp"
+#include "PhysicalDevice.hpp"
 #include "CommandBufferPool.hpp"
+#include "Pipeline.hpp"
+#include "Commands.hpp"
 
 vk_command_buffer::vk_command_buffer(vk_command_pool& command_pool, vk::CommandBufferLevel level)
     : vk_unit{nullptr, &command_pool.device()},
@@ -75,16 +78,24 @@ vk::Result vk_command_buffer::begin(vk::CommandBufferUsageFlags flags, const vk_
 //    }
 
     handle().begin(begin_info);
+    recorder.reset(handle());
+
     return vk::Result::eSuccess;
 }
 
 vk::Result vk_command_buffer::end()
 {
     handle().end();
+    recorder.reset(nullptr);
 
     return vk::Result::eSuccess;
 }
 
+vk_command_recorder& vk_command_buffer::get_recorder()
+{
+    return recorder;
+}
+
 vk::Result vk_command_buffer::reset(vk_command_buffer::reset_mode reset_mode)
 {
     assert(reset_mode == command_pool.reset_mode() &&
@@ -104,14 +115,14 @@ void vk_command_buffer::copy_buffer(const vk_buffer& src_buffer, const vk_buffer
 }
 
 void vk_command_buffer::copy_image(const vk_image& src_img, const vk_image& dst_img,
-                                   const std::vector<vk::ImageCopy>& regions)
+                                   vk::ArrayProxy<const vk::ImageCopy> regions)
 {
     handle().copyImage(src_img.handle(), vk::ImageLayout::eTransferSrcOptimal, dst_img.handle(),
                        vk::ImageLayout::eTransferDstOptimal, regions);
 }
 
 void vk_command_buffer::copy_buffer_to_image(const vk_buffer& buffer, const vk_image& image,
-                                             const std::vector<vk::BufferImageCopy>& regions)
+                                             vk::ArrayProxy<const vk::BufferImageCopy> regions)
 {
 
     handle().copyBufferToImage(buffer.handle(), image.handle(), vk::ImageLayout::eTransferDstOptimal, regions);
@@ -119,7 +130,7 @@ void vk_command_buffer::copy_buffer_to_image(const vk_buffer& buffer, const vk_i
 
 
 void vk_command_buffer::copy_image_to_buffer(const vk_image& image, vk::ImageLayout image_layout,
-                                             const vk_buffer& buffer, const std::vector<vk::BufferImageCopy>& regions)
+                                             const vk_buffer& buffer, vk::ArrayProxy<const vk::BufferImageCopy> regions)
 {
     handle().copyImageToBuffer(image.handle(), image_layout, buffer.handle(), regions);
 }
@@ -151,42 +162,50 @@ vk_command_buffer::image_memory_barrier(const vk_image_view& image_view, const I
     handle().pipelineBarrier(src_stage_mask, dst_stage_mask, {}, {}, {}, image_memory_barrier);
 }
 
-void vk_command_buffer::set_viewport(uint32_t first_viewport, const std::vector<vk::Viewport>& viewports)
+void vk_command_buffer::begin_rendering(const vk_render_target& render_target,
+                                        const std::vector<LoadStoreInfo>& load_store_infos,
+                                        const std::vector<vk::ClearValue>& clear_values)
 {
-    handle().setViewport(first_viewport, viewports);
+    ::begin_rendering(handle(), render_target, load_store_infos, clear_values);
 }
 
-void vk_command_buffer::set_scissor(uint32_t first_scissor, const std::vector<vk::Rect2D>& scissors)
+void vk_command_buffer::end_rendering()
 {
+    ::end_rendering(handle());
+}
 
-    handle().setScissor(first_scissor, scissors);
+void vk_command_buffer::set_viewport(uint32_t first_viewport, vk::ArrayProxy<const vk::Viewport> viewports)
+{
+    recorder.set_viewport(first_viewport, viewports);
 }
 
-void vk_command_buffer::set_line_width(float line_width)
+void vk_command_buffer::set_scissor(uint32_t first_scissor, vk::ArrayProxy<const vk::Rect2D> scissors)
 {
+    recorder.set_scissor(first_scissor, scissors);
+}
 
-    handle().setLineWidth(line_width);
+void vk_command_buffer::set_line_width(float line_width)
+{
+    recorder.set_line_width(line_width);
 }
 
 void vk_command_buffer::set_depth_bias(float depth_bias_constant_factor, float depth_bias_clamp,
                                        float depth_bias_slope_factor)
 {
-
-    handle().setDepthBias(depth_bias_constant_factor, depth_bias_clamp, depth_bias_slope_factor);
+    recorder.set_depth_bias(depth_bias_constant_factor, depth_bias_clamp, depth_bias_slope_factor);
 }
 
 void vk_command_buffer::set_blend_constants(const std::array<float, 4>& blend_constants)
 {
-    handle().setBlendConstants(blend_constants.data());
-
+    recorder.set_blend_constants(blend_constants);
 }
 
 void vk_command_buffer::set_depth_bounds(float min_depth_bounds, float max_depth_bounds)
 {
-    handle().setDepthBounds(min_depth_bounds, max_depth_bounds);
+    recorder.set_depth_bounds(min_depth_bounds, max_depth_bounds);
 }
 
-void vk_command_buffer::update_buffer(const vk_buffer& buffer, vk::DeviceSize offset, const std::vector<uint8_t>& data)
+void vk_command_buffer::update_buffer(const vk_buffer& buffer, vk::DeviceSize offset, vk::ArrayProxy<const uint8_t> data)
 {
     handle().updateBuffer<uint8_t>(buffer.handle(), offset, data);
 }
@@ -194,8 +213,9 @@ void vk_command_buffer::update_buffer(const vk_buffer& buffer, vk::DeviceSize of
 void vk_command_buffer::buffer_memory_barrier(const vk_buffer& buffer, vk::DeviceSize offset, vk::DeviceSize size,
                                               const BufferMemoryBarrier& memory_barrier)
 {
-    vk::BufferMemoryBarrier buffer_memory_barrier(memory_barrier.src_access_mask, memory_barrier.dst_access_mask, {},
-                                                  {}, buffer.handle(), offset, size);
+    vk::BufferMemoryBarrier buffer_memory_barrier(memory_barrier.src_access_mask, memory_barrier.dst_access_mask,
+                                                  memory_barrier.old_queue_family, memory_barrier.new_queue_family,
+                                                  buffer.handle(), offset, size);
 
     vk::PipelineStageFlags src_stage_mask = memory_barrier.src_stage_mask;
     vk::PipelineStageFlags dst_stage_mask = memory_barrier.dst_stage_mask;
@@ -203,5 +223,120 @@ void vk_command_buffer::buffer_memory_barrier(const vk_buffer& buffer, vk::Devic
     handle().pipelineBarrier(src_stage_mask, dst_stage_mask, {}, {}, buffer_memory_barrier, {});
 }
 
+void vk_command_buffer::bind_pipeline(const vk_compute_pipeline& pipeline)
+{
+    recorder.bind_pipeline(vk::PipelineBindPoint::eCompute, pipeline.handle());
+}
+
+void vk_command_buffer::bind_pipeline(vk::PipelineBindPoint bind_point, vk::Pipeline pipeline)
+{
+    recorder.bind_pipeline(bind_point, pipeline);
+}
+
+void vk_command_buffer::bind_vertex_buffers(uint32_t first_binding, vk::ArrayProxy<const vk::Buffer> buffers,
+                                            vk::ArrayProxy<const vk::DeviceSize> offsets)
+{
+    recorder.bind_vertex_buffers(first_binding, buffers, offsets);
+}
+
+void vk_command_buffer::bind_index_buffer(const vk_buffer& buffer, vk::DeviceSize offset, vk::IndexType index_type)
+{
+    recorder.bind_index_buffer(buffer.handle(), offset, index_type);
+}
+
+void vk_command_buffer::bind_descriptor_sets(vk::PipelineBindPoint bind_point, vk::PipelineLayout layout,
+                                             uint32_t first_set, vk::ArrayProxy<const vk::DescriptorSet> descriptor_sets,
+                                             vk::ArrayProxy<const uint32_t> dynamic_offsets)
+{
+    recorder.bind_descriptor_sets(bind_point, layout, first_set, descriptor_sets, dynamic_offsets);
+}
+
+void vk_command_buffer::push_constants(vk::PipelineLayout layout, vk::ShaderStageFlags stages, uint32_t offset,
+                                       uint32_t size, const void* data)
+{
+    recorder.push_constants(layout, stages, offset, size, data);
+}
+
+void vk_command_buffer::push_constants(const vk_pipeline_layout& layout, uint32_t offset, uint32_t size,
+                                       const void* data)
+{
+    uint32_t max_size = device().get_gpu().properties().limits.maxPushConstantsSize;
+    if (offset + size > max_size) {
+        throw std::runtime_error(fmt::format("推送常量 [{}, {}) 超出设备上限 {} 字节", offset, offset + size, max_size));
+    }
+
+    auto stages = layout.get_push_constant_range_stage(size, offset);
+    if (!stages) {
+        throw std::runtime_error(fmt::format("管线布局中没有完整包含推送常量 [{}, {}) 的范围", offset, offset + size));
+    }
+
+    recorder.push_constants(layout.handle(), stages, offset, size, data);
+}
+
+void vk_command_buffer::draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex,
+                             uint32_t first_instance)
+{
+    recorder.draw(vertex_count, instance_count, first_vertex, first_instance);
+}
+
+void vk_command_buffer::draw_indexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index,
+                                     int32_t vertex_offset, uint32_t first_instance)
+{
+    recorder.draw_indexed(index_count, instance_count, first_index, vertex_offset, first_instance);
+}
+
+void vk_command_buffer::dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
+{
+    handle().dispatch(group_count_x, group_count_y, group_count_z);
+}
+
+void vk_command_buffer::dispatch_indirect(const vk_buffer& buffer, vk::DeviceSize offset)
+{
+    handle().dispatchIndirect(buffer.handle(), offset);
+}
+
+void vk_command_buffer::fill_buffer(const vk_buffer& buffer, vk::DeviceSize offset, vk::DeviceSize size,
+                                    uint32_t data)
+{
+    handle().fillBuffer(buffer.handle(), offset, size, data);
+}
+
+void vk_command_buffer::release_buffer_ownership(const vk_buffer& buffer, uint32_t src_queue_family,
+                                                 uint32_t dst_queue_family, vk::PipelineStageFlags src_stage_mask,
+                                                 vk::AccessFlags src_access_mask)
+{
+    // 同一队列族内无需转移，信号量已保证内存依赖
+    if (src_queue_family == dst_queue_family) {
+        return;
+    }
+
+    BufferMemoryBarrier barrier;
+    barrier.src_stage_mask   = src_stage_mask;
+    barrier.dst_stage_mask   = vk::PipelineStageFlagBits::eBottomOfPipe;
+    barrier.src_access_mask  = src_access_mask;
+    barrier.old_queue_family = src_queue_family;
+    barrier.new_queue_family = dst_queue_family;
+
+    buffer_memory_barrier(buffer, 0, VK_WHOLE_SIZE, barrier);
+}
+
+void vk_command_buffer::acquire_buffer_ownership(const vk_buffer& buffer, uint32_t src_queue_family,
+                                                 uint32_t dst_queue_family, vk::PipelineStageFlags dst_stage_mask,
+                                                 vk::AccessFlags dst_access_mask)
+{
+    if (src_queue_family == dst_queue_family) {
+        return;
+    }
+
+    BufferMemoryBarrier barrier;
+    barrier.src_stage_mask   = vk::PipelineStageFlagBits::eTopOfPipe;
+    barrier.dst_stage_mask   = dst_stage_mask;
+    barrier.dst_access_mask  = dst_access_mask;
+    barrier.old_queue_family = src_queue_family;
+    barrier.new_queue_family = dst_queue_family;
+
+    buffer_memory_barrier(buffer, 0, VK_WHOLE_SIZE, barrier);
+}
+
 
 
@@ -14,8 +14,12 @@
 #include "ImageView.hpp"
 #include "Renderpass.hpp"
 #include "Framebuffer.hpp"
+#include "CommandRecorder.hpp"
 
 class vk_command_pool;
+class vk_compute_pipeline;
+class vk_pipeline_layout;
+class vk_render_target;
 
 class vk_command_buffer : public vk_unit<vk::CommandBuffer>
 {
@@ -47,28 +51,98 @@ public:
 
     vk::Result end();
 
+    /**
+     * @brief 绑定与动态状态经由录制器发出，冗余的设置会被跳过；
+     *        直接对 handle() 录制了绑定或状态命令后需调用 get_recorder().invalidate()
+     */
+    vk_command_recorder& get_recorder();
+
+    /**
+     * @brief 动态渲染，见 Commands.hpp 中的 begin_rendering
+     */
+    void begin_rendering(const vk_render_target& render_target,
+                         const std::vector<LoadStoreInfo>& load_store_infos = {},
+                         const std::vector<vk::ClearValue>& clear_values = {});
+
+    void end_rendering();
+
     // @formatter:off
-    void set_viewport(uint32_t first_viewport, const std::vector<vk::Viewport> &viewports);
-    void set_scissor(uint32_t first_scissor, const std::vector<vk::Rect2D> &scissors);
+    void set_viewport(uint32_t first_viewport, vk::ArrayProxy<const vk::Viewport> viewports);
+    void set_scissor(uint32_t first_scissor, vk::ArrayProxy<const vk::Rect2D> scissors);
     void set_line_width(float line_width);
     void set_depth_bias(float depth_bias_constant_factor, float depth_bias_clamp, float depth_bias_slope_factor);
     void set_blend_constants(const std::array<float, 4> &blend_constants);
     void set_depth_bounds(float min_depth_bounds, float max_depth_bounds);
-    void update_buffer(const vk_buffer& buffer, vk::DeviceSize offset, const std::vector<uint8_t>& data);
+    void update_buffer(const vk_buffer& buffer, vk::DeviceSize offset, vk::ArrayProxy<const uint8_t> data);
     // @formatter:on
     
     void copy_buffer(const vk_buffer& src_buffer, const vk_buffer& dst_buffer, vk::DeviceSize size);
-    void copy_image(const vk_image& src_img, const vk_image& dst_img, const std::vector<vk::ImageCopy>& regions);
+    void copy_image(const vk_image& src_img, const vk_image& dst_img, vk::ArrayProxy<const vk::ImageCopy> regions);
     
     // @formatter:off
-    void copy_buffer_to_image(const vk_buffer& buffer, const vk_image& image, const std::vector<vk::BufferImageCopy>& regions);
-    void copy_image_to_buffer(const vk_image& image, vk::ImageLayout image_layout, const vk_buffer& buffer, const std::vector<vk::BufferImageCopy>& regions);
+    void copy_buffer_to_image(const vk_buffer& buffer, const vk_image& image, vk::ArrayProxy<const vk::BufferImageCopy> regions);
+    void copy_image_to_buffer(const vk_image& image, vk::ImageLayout image_layout, const vk_buffer& buffer, vk::ArrayProxy<const vk::BufferImageCopy> regions);
     
     void image_memory_barrier(const vk_image_view& image_view, const ImageMemoryBarrier& memory_barrier) const;
     void buffer_memory_barrier(const vk_buffer& buffer, vk::DeviceSize offset, vk::DeviceSize size, const BufferMemoryBarrier& memory_barrier);
     // @formatter:on
 
+    void bind_pipeline(const vk_compute_pipeline& pipeline);
+
+    void bind_pipeline(vk::PipelineBindPoint bind_point, vk::Pipeline pipeline);
+
+    void bind_vertex_buffers(uint32_t first_binding, vk::ArrayProxy<const vk::Buffer> buffers,
+                             vk::ArrayProxy<const vk::DeviceSize> offsets);
+
+    void bind_index_buffer(const vk_buffer& buffer, vk::DeviceSize offset, vk::IndexType index_type);
+
+    // @formatter:off
+    void bind_descriptor_sets(vk::PipelineBindPoint bind_point, vk::PipelineLayout layout, uint32_t first_set,
+                              vk::ArrayProxy<const vk::DescriptorSet> descriptor_sets, vk::ArrayProxy<const uint32_t> dynamic_offsets = nullptr);
+    // @formatter:on
+
+    void push_constants(vk::PipelineLayout layout, vk::ShaderStageFlags stages, uint32_t offset, uint32_t size,
+                        const void* data);
+
+    /**
+     * @brief 按反射得到的推送常量范围推送数据，阶段由布局推导；
+     *        超出设备上限或不被某个范围完整包含时抛出异常
+     */
+    void push_constants(const vk_pipeline_layout& layout, uint32_t offset, uint32_t size, const void* data);
+
+    template<typename T>
+    void push_constants(const vk_pipeline_layout& layout, const T& value, uint32_t offset = 0)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "推送常量必须是可平凡复制的类型");
+        static_assert(sizeof(T) % 4 == 0, "推送常量的大小必须是 4 的倍数");
+
+        push_constants(layout, offset, static_cast<uint32_t>(sizeof(T)), &value);
+    }
+
+    void draw(uint32_t vertex_count, uint32_t instance_count = 1, uint32_t first_vertex = 0,
+              uint32_t first_instance = 0);
+
+    void draw_indexed(uint32_t index_count, uint32_t instance_count = 1, uint32_t first_index = 0,
+                      int32_t vertex_offset = 0, uint32_t first_instance = 0);
+
+    void dispatch(uint32_t group_count_x, uint32_t group_count_y = 1, uint32_t group_count_z = 1);
+
+    void dispatch_indirect(const vk_buffer& buffer, vk::DeviceSize offset = 0);
+
+    void fill_buffer(const vk_buffer& buffer, vk::DeviceSize offset, vk::DeviceSize size, uint32_t data);
+
+    /**
+     * @brief 队列族所有权转移：在源队列上释放，之后需在目标队列上以相同的族索引记录 acquire_buffer_ownership
+     */
+    void release_buffer_ownership(const vk_buffer& buffer, uint32_t src_queue_family, uint32_t dst_queue_family,
+                                  vk::PipelineStageFlags src_stage_mask, vk::AccessFlags src_access_mask);
+
+    void acquire_buffer_ownership(const vk_buffer& buffer, uint32_t src_queue_family, uint32_t dst_queue_family,
+                                  vk::PipelineStageFlags dst_stage_mask, vk::AccessFlags dst_access_mask);
+
 private:
     const vk::CommandBufferLevel level = {};
     vk_command_pool& command_pool;
+
+    vk_command_recorder recorder;
 };
\ No newline at end of file
@@ -11,7 +11,7 @@
 vk_command_pool::vk_command_pool(vk_device& d,
                                  uint32_t queue_family_index,
                                  vk_command_buffer::reset_mode reset_mode) :
-    device_{d}, reset_mode_{reset_mode}
+    device_{d}, queue_family_index_{queue_family_index}, reset_mode_{reset_mode}
 {
     vk::CommandPoolCreateFlags flags;
     switch (reset_mode) {
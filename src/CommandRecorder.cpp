@@ -0,0 +1,329 @@
+﻿/**
+ * @File CommandRecorder.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "CommandRecorder.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+
+std::atomic<uint32_t> vk_command_recorder::frame_issued{0};
+std::atomic<uint32_t> vk_command_recorder::frame_elided{0};
+
+vk_command_recorder::vk_command_recorder(vk::CommandBuffer command_buffer) :
+    command_buffer{command_buffer}
+{
+}
+
+vk_command_recorder::~vk_command_recorder()
+{
+    flush_statistics();
+}
+
+void vk_command_recorder::reset(vk::CommandBuffer new_command_buffer)
+{
+    flush_statistics();
+    invalidate();
+
+    command_buffer = new_command_buffer;
+}
+
+void vk_command_recorder::invalidate()
+{
+    graphics = {};
+    compute  = {};
+
+    vertex_bindings.fill({});
+    index_buffer = nullptr;
+
+    viewport_valid.fill(false);
+    scissor_valid.fill(false);
+
+    line_width_valid      = false;
+    depth_bias_valid      = false;
+    blend_constants_valid = false;
+    depth_bounds_valid    = false;
+}
+
+vk::CommandBuffer vk_command_recorder::handle() const
+{
+    return command_buffer;
+}
+
+void vk_command_recorder::bind_pipeline(vk::PipelineBindPoint bind_point, vk::Pipeline pipeline)
+{
+    auto& state = get_bind_point_state(bind_point);
+    if (state.pipeline == pipeline) {
+        ++statistics.elided;
+        return;
+    }
+
+    command_buffer.bindPipeline(bind_point, pipeline);
+    state.pipeline = pipeline;
+    ++statistics.issued;
+}
+
+void vk_command_recorder::bind_descriptor_sets(vk::PipelineBindPoint bind_point, vk::PipelineLayout layout,
+                                               uint32_t first_set,
+                                               vk::ArrayProxy<const vk::DescriptorSet> descriptor_sets,
+                                               vk::ArrayProxy<const uint32_t> dynamic_offsets)
+{
+    auto& state = get_bind_point_state(bind_point);
+
+    const uint32_t set_count = descriptor_sets.size();
+    const bool     trackable = first_set + set_count <= MAX_BOUND_DESCRIPTOR_SETS &&
+                               dynamic_offsets.size() <= MAX_DYNAMIC_OFFSETS &&
+                               (dynamic_offsets.empty() || set_count == 1);
+
+    // 布局不同时 set 的兼容性未知，按全部失效处理
+    if (state.layout != layout) {
+        state.sets.fill({});
+        state.layout = layout;
+    }
+
+    if (!trackable) {
+        command_buffer.bindDescriptorSets(bind_point, layout, first_set, descriptor_sets, dynamic_offsets);
+        for (uint32_t i = first_set; i < std::min(first_set + set_count, MAX_BOUND_DESCRIPTOR_SETS); ++i) {
+            state.sets[i] = {};
+        }
+        ++statistics.issued;
+        return;
+    }
+
+    auto matches = [&](uint32_t i) {
+        const auto& bound = state.sets[first_set + i];
+        if (bound.set != descriptor_sets.data()[i] || bound.dynamic_offset_count != dynamic_offsets.size()) {
+            return false;
+        }
+        return std::equal(dynamic_offsets.begin(), dynamic_offsets.end(), bound.dynamic_offsets.begin());
+    };
+
+    // 只重新绑定首尾之间发生变化的部分
+    uint32_t begin = 0;
+    while (begin < set_count && matches(begin)) {
+        ++begin;
+    }
+    if (begin == set_count) {
+        ++statistics.elided;
+        return;
+    }
+
+    uint32_t end = set_count;
+    while (end > begin && matches(end - 1)) {
+        --end;
+    }
+
+    command_buffer.bindDescriptorSets(bind_point, layout, first_set + begin, end - begin,
+                                      descriptor_sets.data() + begin, dynamic_offsets.size(), dynamic_offsets.data());
+    ++statistics.issued;
+
+    for (uint32_t i = begin; i < end; ++i) {
+        auto& bound = state.sets[first_set + i];
+        bound.set                  = descriptor_sets.data()[i];
+        bound.dynamic_offset_count = dynamic_offsets.size();
+        std::copy(dynamic_offsets.begin(), dynamic_offsets.end(), bound.dynamic_offsets.begin());
+    }
+}
+
+void vk_command_recorder::bind_vertex_buffers(uint32_t first_binding, vk::ArrayProxy<const vk::Buffer> buffers,
+                                              vk::ArrayProxy<const vk::DeviceSize> offsets)
+{
+    assert(buffers.size() == offsets.size());
+
+    const uint32_t count = buffers.size();
+
+    bool redundant = first_binding + count <= MAX_VERTEX_BINDINGS;
+    for (uint32_t i = 0; redundant && i < count; ++i) {
+        const auto& bound = vertex_bindings[first_binding + i];
+        redundant = bound.buffer == buffers.data()[i] && bound.offset == offsets.data()[i];
+    }
+
+    if (redundant) {
+        ++statistics.elided;
+        return;
+    }
+
+    command_buffer.bindVertexBuffers(first_binding, buffers, offsets);
+    ++statistics.issued;
+
+    for (uint32_t i = 0; i < count && first_binding + i < MAX_VERTEX_BINDINGS; ++i) {
+        vertex_bindings[first_binding + i] = {buffers.data()[i], offsets.data()[i]};
+    }
+}
+
+void vk_command_recorder::bind_index_buffer(vk::Buffer buffer, vk::DeviceSize offset, vk::IndexType type)
+{
+    if (index_buffer == buffer && index_offset == offset && index_type == type) {
+        ++statistics.elided;
+        return;
+    }
+
+    command_buffer.bindIndexBuffer(buffer, offset, type);
+    index_buffer = buffer;
+    index_offset = offset;
+    index_type   = type;
+    ++statistics.issued;
+}
+
+void vk_command_recorder::set_viewport(uint32_t first_viewport, vk::ArrayProxy<const vk::Viewport> new_viewports)
+{
+    const uint32_t count = new_viewports.size();
+
+    bool redundant = first_viewport + count <= MAX_VIEWPORTS;
+    for (uint32_t i = 0; redundant && i < count; ++i) {
+        redundant = viewport_valid[first_viewport + i] && viewports[first_viewport + i] == new_viewports.data()[i];
+    }
+
+    if (redundant) {
+        ++statistics.elided;
+        return;
+    }
+
+    command_buffer.setViewport(first_viewport, new_viewports);
+    ++statistics.issued;
+
+    for (uint32_t i = 0; i < count && first_viewport + i < MAX_VIEWPORTS; ++i) {
+        viewports[first_viewport + i]      = new_viewports.data()[i];
+        viewport_valid[first_viewport + i] = true;
+    }
+}
+
+void vk_command_recorder::set_scissor(uint32_t first_scissor, vk::ArrayProxy<const vk::Rect2D> new_scissors)
+{
+    const uint32_t count = new_scissors.size();
+
+    bool redundant = first_scissor + count <= MAX_VIEWPORTS;
+    for (uint32_t i = 0; redundant && i < count; ++i) {
+        redundant = scissor_valid[first_scissor + i] && scissors[first_scissor + i] == new_scissors.data()[i];
+    }
+
+    if (redundant) {
+        ++statistics.elided;
+        return;
+    }
+
+    command_buffer.setScissor(first_scissor, new_scissors);
+    ++statistics.issued;
+
+    for (uint32_t i = 0; i < count && first_scissor + i < MAX_VIEWPORTS; ++i) {
+        scissors[first_scissor + i]      = new_scissors.data()[i];
+        scissor_valid[first_scissor + i] = true;
+    }
+}
+
+void vk_command_recorder::set_line_width(float new_line_width)
+{
+    if (line_width_valid && line_width == new_line_width) {
+        ++statistics.elided;
+        return;
+    }
+
+    command_buffer.setLineWidth(new_line_width);
+    line_width       = new_line_width;
+    line_width_valid = true;
+    ++statistics.issued;
+}
+
+void vk_command_recorder::set_depth_bias(float depth_bias_constant_factor, float depth_bias_clamp,
+                                         float depth_bias_slope_factor)
+{
+    std::array<float, 3> new_depth_bias{depth_bias_constant_factor, depth_bias_clamp, depth_bias_slope_factor};
+    if (depth_bias_valid && depth_bias == new_depth_bias) {
+        ++statistics.elided;
+        return;
+    }
+
+    command_buffer.setDepthBias(depth_bias_constant_factor, depth_bias_clamp, depth_bias_slope_factor);
+    depth_bias       = new_depth_bias;
+    depth_bias_valid = true;
+    ++statistics.issued;
+}
+
+void vk_command_recorder::set_blend_constants(const std::array<float, 4>& new_blend_constants)
+{
+    if (blend_constants_valid && blend_constants == new_blend_constants) {
+        ++statistics.elided;
+        return;
+    }
+
+    command_buffer.setBlendConstants(new_blend_constants.data());
+    blend_constants       = new_blend_constants;
+    blend_constants_valid = true;
+    ++statistics.issued;
+}
+
+void vk_command_recorder::set_depth_bounds(float min_depth_bounds, float max_depth_bounds)
+{
+    std::array<float, 2> new_depth_bounds{min_depth_bounds, max_depth_bounds};
+    if (depth_bounds_valid && depth_bounds == new_depth_bounds) {
+        ++statistics.elided;
+        return;
+    }
+
+    command_buffer.setDepthBounds(min_depth_bounds, max_depth_bounds);
+    depth_bounds       = new_depth_bounds;
+    depth_bounds_valid = true;
+    ++statistics.issued;
+}
+
+void vk_command_recorder::push_constants(vk::PipelineLayout layout, vk::ShaderStageFlags stages, uint32_t offset,
+                                         uint32_t size, const void* data)
+{
+    command_buffer.pushConstants(layout, stages, offset, size, data);
+    ++statistics.issued;
+}
+
+void vk_command_recorder::draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex,
+                               uint32_t first_instance)
+{
+    command_buffer.draw(vertex_count, instance_count, first_vertex, first_instance);
+    ++statistics.issued;
+}
+
+void vk_command_recorder::draw_indexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index,
+                                       int32_t vertex_offset, uint32_t first_instance)
+{
+    command_buffer.drawIndexed(index_count, instance_count, first_index, vertex_offset, first_instance);
+    ++statistics.issued;
+}
+
+void vk_command_recorder::draw_indexed_indirect(vk::Buffer buffer, vk::DeviceSize offset, uint32_t draw_count,
+                                                uint32_t stride)
+{
+    command_buffer.drawIndexedIndirect(buffer, offset, draw_count, stride);
+    ++statistics.issued;
+}
+
+const RecordingStatistics& vk_command_recorder::get_statistics() const
+{
+    return statistics;
+}
+
+RecordingStatistics vk_command_recorder::end_frame()
+{
+    RecordingStatistics frame_statistics;
+    frame_statistics.issued = frame_issued.exchange(0, std::memory_order_relaxed);
+    frame_statistics.elided = frame_elided.exchange(0, std::memory_order_relaxed);
+
+    auto& profiler = FrameProfiler::get();
+    profiler.record_counter("vk_command_recorder", "issued", frame_statistics.issued);
+    profiler.record_counter("vk_command_recorder", "elided", frame_statistics.elided);
+
+    return frame_statistics;
+}
+
+vk_command_recorder::BindPointState& vk_command_recorder::get_bind_point_state(vk::PipelineBindPoint bind_point)
+{
+    return bind_point == vk::PipelineBindPoint::eCompute ? compute : graphics;
+}
+
+void vk_command_recorder::flush_statistics()
+{
+    frame_issued.fetch_add(statistics.issued, std::memory_order_relaxed);
+    frame_elided.fetch_add(statistics.elided, std::memory_order_relaxed);
+
+    statistics = {};
+}
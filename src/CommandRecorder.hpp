@@ -0,0 +1,157 @@
+﻿/**
+ * @File CommandRecorder.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 状态跟踪的命令录制：过滤冗余的绑定与动态状态设置，参数以 ArrayProxy 传入，录制期间不分配内存
+ */
+
+#pragma once
+
+#include "VkCommon.hpp"
+
+#include <array>
+#include <atomic>
+
+/**
+ * @brief 录制统计，elided 为因状态未变化而跳过的命令数
+ */
+struct RecordingStatistics
+{
+    uint32_t issued{0};
+    uint32_t elided{0};
+};
+
+/**
+ * @brief 不持有命令缓冲区，只记录经由它发出的绑定与动态状态。
+ *        直接对句柄录制的命令（如其他模块的 record_*）可能改变这些状态，之后需调用 invalidate()。
+ *        假设所有管线都把视口、裁剪等状态声明为动态状态，因此绑定管线不会使已跟踪的动态状态失效
+ */
+class vk_command_recorder
+{
+public:
+    static constexpr uint32_t MAX_BOUND_DESCRIPTOR_SETS = 8;
+    static constexpr uint32_t MAX_DYNAMIC_OFFSETS       = 8;
+    static constexpr uint32_t MAX_VERTEX_BINDINGS       = 16;
+    static constexpr uint32_t MAX_VIEWPORTS             = 16;
+
+    explicit vk_command_recorder(vk::CommandBuffer command_buffer = nullptr);
+
+    /**
+     * @brief 析构时将本次录制的统计计入帧统计
+     */
+    ~vk_command_recorder();
+
+    vk_command_recorder(const vk_command_recorder&) = delete;
+    vk_command_recorder(vk_command_recorder&&) = delete;
+
+    vk_command_recorder& operator=(const vk_command_recorder&) = delete;
+    vk_command_recorder& operator=(vk_command_recorder&&) = delete;
+
+    /**
+     * @brief 开始新的录制：计入上次录制的统计并清空所有跟踪的状态
+     */
+    void reset(vk::CommandBuffer command_buffer);
+
+    /**
+     * @brief 忘记所有跟踪的状态，下一次绑定与设置一定会发出
+     */
+    void invalidate();
+
+    vk::CommandBuffer handle() const;
+
+    // @formatter:off
+    void bind_pipeline(vk::PipelineBindPoint bind_point, vk::Pipeline pipeline);
+    void bind_descriptor_sets(vk::PipelineBindPoint bind_point, vk::PipelineLayout layout, uint32_t first_set,
+                              vk::ArrayProxy<const vk::DescriptorSet> descriptor_sets,
+                              vk::ArrayProxy<const uint32_t> dynamic_offsets = nullptr);
+    void bind_vertex_buffers(uint32_t first_binding, vk::ArrayProxy<const vk::Buffer> buffers,
+                             vk::ArrayProxy<const vk::DeviceSize> offsets);
+    void bind_index_buffer(vk::Buffer buffer, vk::DeviceSize offset, vk::IndexType index_type);
+
+    void set_viewport(uint32_t first_viewport, vk::ArrayProxy<const vk::Viewport> viewports);
+    void set_scissor(uint32_t first_scissor, vk::ArrayProxy<const vk::Rect2D> scissors);
+    void set_line_width(float line_width);
+    void set_depth_bias(float depth_bias_constant_factor, float depth_bias_clamp, float depth_bias_slope_factor);
+    void set_blend_constants(const std::array<float, 4>& blend_constants);
+    void set_depth_bounds(float min_depth_bounds, float max_depth_bounds);
+    // @formatter:on
+
+    /**
+     * @brief 推送常量与绘制命令总是发出，只计入 issued
+     */
+    void push_constants(vk::PipelineLayout layout, vk::ShaderStageFlags stages, uint32_t offset, uint32_t size,
+                        const void* data);
+
+    void draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance);
+
+    void draw_indexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset,
+                      uint32_t first_instance);
+
+    void draw_indexed_indirect(vk::Buffer buffer, vk::DeviceSize offset, uint32_t draw_count, uint32_t stride);
+
+    const RecordingStatistics& get_statistics() const;
+
+    /**
+     * @brief 返回并清零自上次调用以来所有录制器计入的统计，同时记录到 FrameProfiler 的 "vk_command_recorder" 计数器
+     */
+    static RecordingStatistics end_frame();
+
+private:
+    struct BoundDescriptorSet
+    {
+        vk::DescriptorSet                          set;
+        uint32_t                                   dynamic_offset_count{0};
+        std::array<uint32_t, MAX_DYNAMIC_OFFSETS>  dynamic_offsets{};
+    };
+
+    struct BindPointState
+    {
+        vk::Pipeline                                            pipeline;
+        vk::PipelineLayout                                      layout;
+        std::array<BoundDescriptorSet, MAX_BOUND_DESCRIPTOR_SETS> sets{};
+    };
+
+    struct VertexBinding
+    {
+        vk::Buffer     buffer;
+        vk::DeviceSize offset{0};
+    };
+
+    BindPointState& get_bind_point_state(vk::PipelineBindPoint bind_point);
+
+    void flush_statistics();
+
+    vk::CommandBuffer command_buffer;
+
+    RecordingStatistics statistics;
+
+    BindPointState graphics;
+    BindPointState compute;
+
+    std::array<VertexBinding, MAX_VERTEX_BINDINGS> vertex_bindings{};
+
+    vk::Buffer     index_buffer;
+    vk::DeviceSize index_offset{0};
+    vk::IndexType  index_type{vk::IndexType::eUint32};
+
+    // 动态状态，对应的 valid 标志为 false 时表示未知
+    std::array<vk::Viewport, MAX_VIEWPORTS> viewports{};
+    std::array<vk::Rect2D, MAX_VIEWPORTS>   scissors{};
+    std::array<bool, MAX_VIEWPORTS>         viewport_valid{};
+    std::array<bool, MAX_VIEWPORTS>         scissor_valid{};
+
+    float line_width{0.0f};
+    bool  line_width_valid{false};
+
+    std::array<float, 3> depth_bias{};
+    bool                 depth_bias_valid{false};
+
+    std::array<float, 4> blend_constants{};
+    bool                 blend_constants_valid{false};
+
+    std::array<float, 2> depth_bounds{};
+    bool                 depth_bounds_valid{false};
+
+    static std::atomic<uint32_t> frame_issued;
+    static std::atomic<uint32_t> frame_elided;
+};
@@ -9,6 +9,7 @@
 #include "Buffer.hpp"
 #include "Image.hpp"
 #include "ImageView.hpp"
+#include "RenderTarget.hpp"
 
 void
 CommandPool::init(vk::Device device, uint32_t familyIndex, vk::CommandPoolCreateFlags flags, vk::Queue defaultQueue)
@@ -108,21 +109,21 @@ copy_buffer(vk::CommandBuffer cmd_buf, const vk_buffer& src_buffer, const vk_buf
 }
 
 void copy_image(vk::CommandBuffer cmd_buf, const vk_image& src_img, const vk_image& dst_img,
-                const std::vector<vk::ImageCopy>& regions)
+                vk::ArrayProxy<const vk::ImageCopy> regions)
 {
     cmd_buf.copyImage(src_img.handle(), vk::ImageLayout::eTransferSrcOptimal, dst_img.handle(),
                       vk::ImageLayout::eTransferDstOptimal, regions);
 }
 
 void copy_buffer_to_image(vk::CommandBuffer cmd_buf, const vk_buffer& buffer, const vk_image& image,
-                          const std::vector<vk::BufferImageCopy>& regions)
+                          vk::ArrayProxy<const vk::BufferImageCopy> regions)
 {
 
     cmd_buf.copyBufferToImage(buffer.handle(), image.handle(), vk::ImageLayout::eTransferDstOptimal, regions);
 }
 
 void copy_image_to_buffer(vk::CommandBuffer cmd_buf, const vk_image& image, vk::ImageLayout image_layout,
-                          const vk_buffer& buffer, const std::vector<vk::BufferImageCopy>& regions)
+                          const vk_buffer& buffer, vk::ArrayProxy<const vk::BufferImageCopy> regions)
 {
     cmd_buf.copyImageToBuffer(image.handle(), image_layout, buffer.handle(), regions);
 }
@@ -155,12 +156,12 @@ image_memory_barrier(vk::CommandBuffer cmd_buf, const vk_image_view& image_view,
     cmd_buf.pipelineBarrier(src_stage_mask, dst_stage_mask, {}, {}, {}, image_memory_barrier);
 }
 
-void set_viewport(vk::CommandBuffer cmd_buf, uint32_t first_viewport, const std::vector<vk::Viewport>& viewports)
+void set_viewport(vk::CommandBuffer cmd_buf, uint32_t first_viewport, vk::ArrayProxy<const vk::Viewport> viewports)
 {
     cmd_buf.setViewport(first_viewport, viewports);
 }
 
-void set_scissor(vk::CommandBuffer cmd_buf, uint32_t first_scissor, const std::vector<vk::Rect2D>& scissors)
+void set_scissor(vk::CommandBuffer cmd_buf, uint32_t first_scissor, vk::ArrayProxy<const vk::Rect2D> scissors)
 {
 
     cmd_buf.setScissor(first_scissor, scissors);
@@ -191,7 +192,7 @@ void set_depth_bounds(vk::CommandBuffer cmd_buf, float min_depth_bounds, float m
 }
 
 void update_buffer(vk::CommandBuffer cmd_buf, const vk_buffer& buffer, vk::DeviceSize offset,
-                   const std::vector<uint8_t>& data)
+                   vk::ArrayProxy<const uint8_t> data)
 {
     cmd_buf.updateBuffer<uint8_t>(buffer.handle(), offset, data);
 }
@@ -208,3 +209,52 @@ buffer_memory_barrier(vk::CommandBuffer cmd_buf, const vk_buffer& buffer, vk::De
 
     cmd_buf.pipelineBarrier(src_stage_mask, dst_stage_mask, {}, {}, buffer_memory_barrier, {});
 }
+
+void begin_rendering(vk::CommandBuffer cmd_buf, const vk_render_target& render_target,
+                     const std::vector<LoadStoreInfo>& load_store_infos,
+                     const std::vector<vk::ClearValue>& clear_values)
+{
+    const auto& views = render_target.get_views();
+
+    auto make_attachment = [&](uint32_t attachment, vk::ImageLayout layout) {
+        LoadStoreInfo load_store = attachment < load_store_infos.size() ? load_store_infos[attachment] : LoadStoreInfo{};
+        vk::ClearValue clear_value = attachment < clear_values.size() ? clear_values[attachment] : vk::ClearValue{};
+
+        vk::RenderingAttachmentInfo attachment_info{};
+        attachment_info.imageView   = views[attachment].handle();
+        attachment_info.imageLayout = layout;
+        attachment_info.loadOp      = load_store.load_op;
+        attachment_info.storeOp     = load_store.store_op;
+        attachment_info.clearValue  = clear_value;
+        return attachment_info;
+    };
+
+    std::vector<vk::RenderingAttachmentInfo> color_attachments;
+    for (auto attachment: render_target.get_output_attachments()) {
+        color_attachments.push_back(make_attachment(attachment, vk::ImageLayout::eColorAttachmentOptimal));
+    }
+
+    vk::RenderingInfo rendering_info{};
+    rendering_info.renderArea = vk::Rect2D{{0, 0}, render_target.get_extent()};
+    rendering_info.layerCount = 1;
+    rendering_info.setColorAttachments(color_attachments);
+
+    vk::RenderingAttachmentInfo depth_attachment{};
+    auto                        depth_index = render_target.get_depth_attachment();
+    if (depth_index >= 0) {
+        depth_attachment = make_attachment(static_cast<uint32_t>(depth_index),
+                                           vk::ImageLayout::eDepthStencilAttachmentOptimal);
+
+        rendering_info.pDepthAttachment = &depth_attachment;
+        if (is_depth_stencil_format(views[depth_index].get_format())) {
+            rendering_info.pStencilAttachment = &depth_attachment;
+        }
+    }
+
+    cmd_buf.beginRenderingKHR(rendering_info);
+}
+
+void end_rendering(vk::CommandBuffer cmd_buf)
+{
+    cmd_buf.endRenderingKHR();
+}
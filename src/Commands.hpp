@@ -95,24 +95,36 @@ private:
 class vk_buffer;
 class vk_image;
 class vk_image_view;
+class vk_render_target;
 
 // @formatter:off
-void set_viewport(vk::CommandBuffer cmd_buf, uint32_t first_viewport, const std::vector<vk::Viewport> &viewports);
-void set_scissor(vk::CommandBuffer cmd_buf, uint32_t first_scissor, const std::vector<vk::Rect2D> &scissors);
+void set_viewport(vk::CommandBuffer cmd_buf, uint32_t first_viewport, vk::ArrayProxy<const vk::Viewport> viewports);
+void set_scissor(vk::CommandBuffer cmd_buf, uint32_t first_scissor, vk::ArrayProxy<const vk::Rect2D> scissors);
 void set_line_width(vk::CommandBuffer cmd_buf, float line_width);
 void set_depth_bias(vk::CommandBuffer cmd_buf, float depth_bias_constant_factor, float depth_bias_clamp, float depth_bias_slope_factor);
 void set_blend_constants(vk::CommandBuffer cmd_buf, const std::array<float, 4> &blend_constants);
 void set_depth_bounds(vk::CommandBuffer cmd_buf, float min_depth_bounds, float max_depth_bounds);
-void update_buffer(vk::CommandBuffer cmd_buf, const vk_buffer& buffer, vk::DeviceSize offset, const std::vector<uint8_t>& data);
+void update_buffer(vk::CommandBuffer cmd_buf, const vk_buffer& buffer, vk::DeviceSize offset, vk::ArrayProxy<const uint8_t> data);
 // @formatter:on
 
 void copy_buffer(vk::CommandBuffer cmd_buf, const vk_buffer& src_buffer, const vk_buffer& dst_buffer, vk::DeviceSize size = 0);
-void copy_image(vk::CommandBuffer cmd_buf, const vk_image& src_img, const vk_image& dst_img, const std::vector<vk::ImageCopy>& regions);
+void copy_image(vk::CommandBuffer cmd_buf, const vk_image& src_img, const vk_image& dst_img, vk::ArrayProxy<const vk::ImageCopy> regions);
 
 // @formatter:off
-void copy_buffer_to_image(vk::CommandBuffer cmd_buf, const vk_buffer& buffer, const vk_image& image, const std::vector<vk::BufferImageCopy>& regions);
-void copy_image_to_buffer(vk::CommandBuffer cmd_buf, const vk_image& image, vk::ImageLayout image_layout, const vk_buffer& buffer, const std::vector<vk::BufferImageCopy>& regions);
+void copy_buffer_to_image(vk::CommandBuffer cmd_buf, const vk_buffer& buffer, const vk_image& image, vk::ArrayProxy<const vk::BufferImageCopy> regions);
+void copy_image_to_buffer(vk::CommandBuffer cmd_buf, const vk_image& image, vk::ImageLayout image_layout, const vk_buffer& buffer, vk::ArrayProxy<const vk::BufferImageCopy> regions);
 
 void image_memory_barrier(vk::CommandBuffer cmd_buf, const vk_image_view& image_view, const ImageMemoryBarrier& memory_barrier);
 void buffer_memory_barrier(vk::CommandBuffer cmd_buf, const vk_buffer& buffer, vk::DeviceSize offset, vk::DeviceSize size, const BufferMemoryBarrier& memory_barrier);
-// @formatter:on
\ No newline at end of file
+// @formatter:on
+
+/**
+ * @brief 以 VK_KHR_dynamic_rendering 开始渲染，不需要 vk_renderpass 与 vk_framebuffer。
+ *        输出附件作为颜色附件，深度图像作为深度（模板）附件；load_store_infos 与 clear_values 按附件下标索引，
+ *        缺省时清除并保存。附件需事先转换到 eColorAttachmentOptimal / eDepthStencilAttachmentOptimal
+ */
+void begin_rendering(vk::CommandBuffer cmd_buf, const vk_render_target& render_target,
+                     const std::vector<LoadStoreInfo>& load_store_infos = {},
+                     const std::vector<vk::ClearValue>& clear_values = {});
+
+void end_rendering(vk::CommandBuffer cmd_buf);
\ No newline at end of file
@@ -0,0 +1,317 @@
+﻿/**
+ * @File Defragmenter.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "Defragmenter.hpp"
+#include "Buffer.hpp"
+#include "Device.hpp"
+#include "Image.hpp"
+#include "ImageView.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+
+namespace {
+VkImageAspectFlags get_copy_aspect(vk::Format format)
+{
+    if (is_depth_format(format)) {
+        return static_cast<VkImageAspectFlags>(get_image_aspect_flags(
+            vk::ImageUsageFlagBits::eDepthStencilAttachment, format));
+    }
+    return VK_IMAGE_ASPECT_COLOR_BIT;
+}
+
+VkImageMemoryBarrier make_image_barrier(VkImage image, VkImageAspectFlags aspect,
+                                        VkImageLayout old_layout, VkImageLayout new_layout,
+                                        VkAccessFlags src_access, VkAccessFlags dst_access)
+{
+    VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.srcAccessMask       = src_access;
+    barrier.dstAccessMask       = dst_access;
+    barrier.oldLayout           = old_layout;
+    barrier.newLayout           = new_layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image               = image;
+    barrier.subresourceRange    = {aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+    return barrier;
+}
+}        // namespace
+
+vk_defragmenter::vk_defragmenter(vk_device& device, vk::DeviceSize max_bytes_per_pass,
+                                 uint32_t max_allocations_per_pass) :
+    device{device},
+    max_bytes_per_pass{max_bytes_per_pass},
+    max_allocations_per_pass{max_allocations_per_pass}
+{
+}
+
+vk_defragmenter::~vk_defragmenter()
+{
+    if (context != VK_NULL_HANDLE) {
+        vmaEndDefragmentation(device.get_memory_allocator(), context, nullptr);
+    }
+}
+
+void vk_defragmenter::begin()
+{
+    if (context != VK_NULL_HANDLE) {
+        return;
+    }
+
+    VmaDefragmentationInfo info{};
+    info.flags                 = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+    info.maxBytesPerPass       = max_bytes_per_pass;
+    info.maxAllocationsPerPass = max_allocations_per_pass;
+
+    auto result = vmaBeginDefragmentation(device.get_memory_allocator(), &info, &context);
+    if (result != VK_SUCCESS) {
+        throw VulkanException{vk::Result(result), "开始碎片整理失败"};
+    }
+
+    stats = {};
+    LOGI("开始显存碎片整理 (每个 pass 最多 {} 字节 / {} 个分配)", max_bytes_per_pass, max_allocations_per_pass);
+}
+
+bool vk_defragmenter::is_active() const
+{
+    return context != VK_NULL_HANDLE;
+}
+
+bool vk_defragmenter::update()
+{
+    if (context == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    PROFILE_SCOPE("vk_defragmenter::update");
+
+    auto allocator = device.get_memory_allocator();
+
+    VmaDefragmentationPassMoveInfo pass{};
+    auto result = vmaBeginDefragmentationPass(allocator, context, &pass);
+    if (result == VK_SUCCESS) {
+        finish();
+        return false;
+    }
+    if (result != VK_INCOMPLETE) {
+        throw VulkanException{vk::Result(result), "开始碎片整理 pass 失败"};
+    }
+
+    std::vector<PendingMove> pending_moves;
+    pending_moves.reserve(pass.moveCount);
+
+    for (uint32_t i = 0; i < pass.moveCount; ++i) {
+        PendingMove pending;
+        if (prepare_move(pass.pMoves[i], pending)) {
+            pending_moves.push_back(pending);
+        } else {
+            pass.pMoves[i].operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+        }
+    }
+
+    DefragmentationRemap remap;
+    if (!pending_moves.empty()) {
+        auto cmd = device.beginSingleTimeCommands();
+        for (auto& pending: pending_moves) {
+            record_copy(static_cast<VkCommandBuffer>(cmd), pending);
+        }
+        device.endSingleTimeCommands(cmd);
+
+        // 旧句柄可能仍被尚未完成的帧引用，销毁前等待整个设备空闲
+        device.wait_idle();
+
+        remap = apply_moves(pending_moves);
+    }
+
+    result = vmaEndDefragmentationPass(allocator, context, &pass);
+
+    // 分配已指向新的内存块，刷新缓存的内存信息
+    for (auto& pending: pending_moves) {
+        if (pending.owner->kind == AllocationOwner::Kind::Buffer) {
+            static_cast<vk_buffer*>(pending.owner->object)->refresh_allocation_info();
+        }
+    }
+
+    ++stats.passes;
+
+    if (!remap.empty()) {
+        for (auto& listener: listeners) {
+            listener(remap);
+        }
+    }
+
+    if (result == VK_SUCCESS) {
+        finish();
+        return false;
+    }
+    if (result != VK_INCOMPLETE) {
+        throw VulkanException{vk::Result(result), "结束碎片整理 pass 失败"};
+    }
+
+    return true;
+}
+
+void vk_defragmenter::add_listener(RemapListener listener)
+{
+    listeners.push_back(std::move(listener));
+}
+
+const DefragmentationStats& vk_defragmenter::get_stats() const
+{
+    return stats;
+}
+
+bool vk_defragmenter::prepare_move(VmaDefragmentationMove& move, PendingMove& pending)
+{
+    auto allocator = device.get_memory_allocator();
+
+    VmaAllocationInfo allocation_info{};
+    vmaGetAllocationInfo(allocator, move.srcAllocation, &allocation_info);
+
+    // 不是由 vk_buffer / vk_image 创建的分配无法安全替换句柄
+    auto* owner = static_cast<AllocationOwner*>(allocation_info.pUserData);
+    if (owner == nullptr) {
+        return false;
+    }
+
+    VkDevice vk_dev = static_cast<VkDevice>(device.handle());
+
+    if (owner->kind == AllocationOwner::Kind::Buffer) {
+        auto* buffer = static_cast<vk_buffer*>(owner->object);
+        if (!buffer->is_movable()) {
+            return false;
+        }
+
+        VkBufferCreateInfo create_info{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+        create_info.size  = buffer->get_size();
+        create_info.usage = static_cast<VkBufferUsageFlags>(buffer->get_usage());
+
+        if (vkCreateBuffer(vk_dev, &create_info, nullptr, &pending.new_buffer) != VK_SUCCESS) {
+            return false;
+        }
+        if (vmaBindBufferMemory(allocator, move.dstTmpAllocation, pending.new_buffer) != VK_SUCCESS) {
+            vkDestroyBuffer(vk_dev, pending.new_buffer, nullptr);
+            return false;
+        }
+    } else {
+        auto* image = static_cast<vk_image*>(owner->object);
+        if (!image->is_movable()) {
+            return false;
+        }
+
+        auto create_info = static_cast<VkImageCreateInfo>(image->get_create_info());
+        if (vkCreateImage(vk_dev, &create_info, nullptr, &pending.new_image) != VK_SUCCESS) {
+            return false;
+        }
+        if (vmaBindImageMemory(allocator, move.dstTmpAllocation, pending.new_image) != VK_SUCCESS) {
+            vkDestroyImage(vk_dev, pending.new_image, nullptr);
+            return false;
+        }
+    }
+
+    pending.owner = owner;
+    return true;
+}
+
+void vk_defragmenter::record_copy(VkCommandBuffer cmd, const PendingMove& pending)
+{
+    if (pending.owner->kind == AllocationOwner::Kind::Buffer) {
+        auto* buffer = static_cast<vk_buffer*>(pending.owner->object);
+
+        VkBufferCopy region{0, 0, buffer->get_size()};
+        vkCmdCopyBuffer(cmd, static_cast<VkBuffer>(buffer->handle()), pending.new_buffer, 1, &region);
+
+        // 之后的读取（顶点/索引/着色器）都在下一次提交中，单次命令结束时的队列等待已足够，
+        // 这里只需保证拷贝写入对后续访问可见
+        VkBufferMemoryBarrier barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+        barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask       = VK_ACCESS_MEMORY_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer              = pending.new_buffer;
+        barrier.size                = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                             0, nullptr, 1, &barrier, 0, nullptr);
+        return;
+    }
+
+    auto* image        = static_cast<vk_image*>(pending.owner->object);
+    auto  old_image    = static_cast<VkImage>(image->handle());
+    auto  steady       = static_cast<VkImageLayout>(image->get_steady_layout());
+    auto  aspect       = get_copy_aspect(image->get_format());
+    auto  subresource  = image->get_subresource();
+
+    VkImageMemoryBarrier to_transfer[2] = {
+        make_image_barrier(old_image, aspect, steady, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT),
+        make_image_barrier(pending.new_image, aspect, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           0, VK_ACCESS_TRANSFER_WRITE_BIT),
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr, 0, nullptr, 2, to_transfer);
+
+    std::vector<VkImageCopy> regions(subresource.mipLevel);
+    auto extent = image->get_extent();
+    for (uint32_t mip = 0; mip < subresource.mipLevel; ++mip) {
+        auto& region = regions[mip];
+        region.srcSubresource = {aspect, mip, 0, subresource.arrayLayer};
+        region.dstSubresource = region.srcSubresource;
+        region.extent         = {std::max(1u, extent.width >> mip),
+                                 std::max(1u, extent.height >> mip),
+                                 std::max(1u, extent.depth >> mip)};
+    }
+    vkCmdCopyImage(cmd, old_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   pending.new_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   static_cast<uint32_t>(regions.size()), regions.data());
+
+    // 旧图像随后会被销毁，只需把新图像恢复到帧间布局
+    auto to_steady = make_image_barrier(pending.new_image, aspect,
+                                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, steady,
+                                        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT);
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &to_steady);
+}
+
+DefragmentationRemap vk_defragmenter::apply_moves(const std::vector<PendingMove>& pending_moves)
+{
+    DefragmentationRemap remap;
+
+    for (auto& pending: pending_moves) {
+        if (pending.owner->kind == AllocationOwner::Kind::Buffer) {
+            auto* buffer = static_cast<vk_buffer*>(pending.owner->object);
+            remap.buffers.emplace(static_cast<VkBuffer>(buffer->handle()), pending.new_buffer);
+            buffer->replace_handle(pending.new_buffer);
+        } else {
+            auto* image = static_cast<vk_image*>(pending.owner->object);
+            remap.images.emplace(static_cast<VkImage>(image->handle()), pending.new_image);
+            image->replace_handle(pending.new_image);
+
+            for (auto* view: image->get_views()) {
+                auto old_view = view->recreate();
+                remap.image_views.emplace(static_cast<VkImageView>(old_view),
+                                          static_cast<VkImageView>(view->handle()));
+            }
+        }
+    }
+
+    return remap;
+}
+
+void vk_defragmenter::finish()
+{
+    VmaDefragmentationStats vma_stats{};
+    vmaEndDefragmentation(device.get_memory_allocator(), context, &vma_stats);
+    context = VK_NULL_HANDLE;
+
+    stats.bytes_moved       = vma_stats.bytesMoved;
+    stats.bytes_freed       = vma_stats.bytesFreed;
+    stats.allocations_moved = vma_stats.allocationsMoved;
+    stats.blocks_freed      = vma_stats.deviceMemoryBlocksFreed;
+
+    LOGI("显存碎片整理完成: {} 个 pass, 移动 {} 个分配 ({} 字节), 释放 {} 个内存块 ({} 字节)",
+         stats.passes, stats.allocations_moved, stats.bytes_moved, stats.blocks_freed, stats.bytes_freed);
+}
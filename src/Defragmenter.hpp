@@ -0,0 +1,115 @@
+﻿/**
+ * @File Defragmenter.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 基于 VMA 的增量显存碎片整理
+ */
+
+#pragma once
+
+#include "VkCommon.hpp"
+#include "MemoryTelemetry.hpp"
+
+#include <functional>
+#include <unordered_map>
+
+class vk_device;
+
+struct DefragmentationStats
+{
+    vk::DeviceSize bytes_moved{0};
+    vk::DeviceSize bytes_freed{0};
+    uint32_t       allocations_moved{0};
+    uint32_t       blocks_freed{0};
+    uint32_t       passes{0};
+};
+
+/**
+ * @brief 一次整理 pass 中被替换的句柄，旧句柄在回调返回后已失效
+ */
+struct DefragmentationRemap
+{
+    std::unordered_map<VkBuffer, VkBuffer>       buffers;
+    std::unordered_map<VkImage, VkImage>         images;
+    std::unordered_map<VkImageView, VkImageView> image_views;
+
+    bool empty() const
+    {
+        return buffers.empty() && images.empty() && image_views.empty();
+    }
+};
+
+/**
+ * @brief 增量碎片整理：begin() 之后每帧调用 update() 执行一个 pass，
+ *        每个 pass 移动的字节数与分配数有上限，避免单帧卡顿
+ *
+ * 只有带有拷贝用途、独占访问且不属于每帧复用类别的缓冲区/图像会被移动，
+ * 图像还需要通过 vk_image::set_steady_layout 声明帧间布局。
+ */
+class vk_defragmenter
+{
+public:
+    using RemapListener = std::function<void(const DefragmentationRemap&)>;
+
+    explicit vk_defragmenter(vk_device& device,
+                             vk::DeviceSize max_bytes_per_pass = 16 * 1024 * 1024,
+                             uint32_t max_allocations_per_pass = 64);
+
+    ~vk_defragmenter();
+
+    vk_defragmenter(const vk_defragmenter&) = delete;
+    vk_defragmenter(vk_defragmenter&&) = delete;
+
+    vk_defragmenter& operator=(const vk_defragmenter&) = delete;
+    vk_defragmenter& operator=(vk_defragmenter&&) = delete;
+
+    /**
+     * @brief 开始一轮整理，已在进行中时忽略
+     */
+    void begin();
+
+    bool is_active() const;
+
+    /**
+     * @brief 执行一个整理 pass，应在帧之间调用；会等待设备空闲后再销毁旧句柄
+     * @return 本轮整理是否仍未结束
+     */
+    bool update();
+
+    /**
+     * @brief 句柄被替换后调用，用于修正描述符等持有旧句柄的地方
+     */
+    void add_listener(RemapListener listener);
+
+    /**
+     * @brief 最近一轮（或正在进行的一轮）整理的统计
+     */
+    const DefragmentationStats& get_stats() const;
+
+private:
+    struct PendingMove
+    {
+        AllocationOwner* owner{nullptr};
+        VkBuffer         new_buffer{VK_NULL_HANDLE};
+        VkImage          new_image{VK_NULL_HANDLE};
+    };
+
+    bool prepare_move(VmaDefragmentationMove& move, PendingMove& pending);
+
+    void record_copy(VkCommandBuffer cmd, const PendingMove& pending);
+
+    DefragmentationRemap apply_moves(const std::vector<PendingMove>& pending_moves);
+
+    void finish();
+
+    vk_device& device;
+
+    vk::DeviceSize max_bytes_per_pass;
+    uint32_t       max_allocations_per_pass;
+
+    VmaDefragmentationContext context{VK_NULL_HANDLE};
+
+    DefragmentationStats stats;
+
+    std::vector<RemapListener> listeners;
+};
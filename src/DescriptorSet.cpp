@@ -218,6 +218,11 @@ const vk_descriptor_set_layout& vk_descriptor_set::get_layout() const
     return descriptor_set_layout;
 }
 
+vk_descriptor_pool& vk_descriptor_set::get_pool() const
+{
+    return descriptor_pool;
+}
+
 BindingMap<VkDescriptorBufferInfo>& vk_descriptor_set::get_buffer_infos()
 {
     return buffer_infos;
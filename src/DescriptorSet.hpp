@@ -57,6 +57,8 @@ public:
 
     const vk_descriptor_set_layout& get_layout() const;
 
+    vk_descriptor_pool& get_pool() const;
+
     VkDescriptorSet get_handle() const;
 
     BindingMap<VkDescriptorBufferInfo>& get_buffer_infos();
@@ -49,6 +49,38 @@ inline VkDescriptorType find_descriptor_type(ShaderResourceType resource_type, b
     }
 }
 
+/**
+ * @brief 把带绑定点的资源转换为布局绑定与绑定标志，没有绑定点的资源返回 false
+ */
+inline bool to_layout_binding(const ShaderResource& resource, VkDescriptorSetLayoutBinding& layout_binding,
+                              VkDescriptorBindingFlagsEXT& binding_flag)
+{
+    // Skip shader resources whitout a binding point
+    if (resource.type == ShaderResourceType::Input ||
+        resource.type == ShaderResourceType::Output ||
+        resource.type == ShaderResourceType::PushConstant ||
+        resource.type == ShaderResourceType::SpecializationConstant) {
+        return false;
+    }
+
+    // When creating a descriptor set layout, if we give a structure to create_info.pNext, each binding needs to have a binding flag
+    // (pBindings[i] uses the flags in pBindingFlags[i])
+    // Adding 0 ensures the bindings that dont use any flags are mapped correctly.
+    binding_flag = resource.mode == ShaderResourceMode::UpdateAfterBind
+                   ? VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT
+                   : 0;
+
+    // Convert ShaderResource to VkDescriptorSetLayoutBinding
+    layout_binding                 = {};
+    layout_binding.binding         = resource.binding;
+    layout_binding.descriptorCount = resource.array_size;
+    layout_binding.descriptorType  = find_descriptor_type(resource.type, resource.mode == ShaderResourceMode::Dynamic);
+    layout_binding.stageFlags      = canonicalize_stage_flags(static_cast<VkShaderStageFlags>(resource.stages),
+                                                              layout_binding.descriptorType);
+
+    return true;
+}
+
 inline bool
 validate_binding(const VkDescriptorSetLayoutBinding& binding, const std::vector<VkDescriptorType>& blacklist)
 {
@@ -75,6 +107,34 @@ inline bool validate_flags(const vk_physical_device& gpu, const std::vector<VkDe
 }
 }        // namespace
 
+std::size_t vk_descriptor_set_layout::compute_key(uint32_t set_index, const std::vector<ShaderResource>& resource_set)
+{
+    std::vector<std::pair<VkDescriptorSetLayoutBinding, VkDescriptorBindingFlagsEXT>> entries;
+    for (const auto& resource: resource_set) {
+        VkDescriptorSetLayoutBinding layout_binding;
+        VkDescriptorBindingFlagsEXT  binding_flag;
+        if (to_layout_binding(resource, layout_binding, binding_flag)) {
+            entries.emplace_back(layout_binding, binding_flag);
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first.binding < rhs.first.binding;
+    });
+
+    std::size_t key = 0;
+    hash_combine(key, set_index);
+    for (const auto& [layout_binding, binding_flag]: entries) {
+        hash_combine(key, layout_binding.binding);
+        hash_combine(key, static_cast<uint32_t>(layout_binding.descriptorType));
+        hash_combine(key, layout_binding.descriptorCount);
+        hash_combine(key, layout_binding.stageFlags);
+        hash_combine(key, binding_flag);
+    }
+
+    return key;
+}
+
 vk_descriptor_set_layout::vk_descriptor_set_layout(vk_device& device,
                                                    const uint32_t set_index,
                                                    const std::vector<ShaderModule*>& shader_modules,
@@ -84,40 +144,19 @@ vk_descriptor_set_layout::vk_descriptor_set_layout(vk_device& device,
     shader_modules{shader_modules}
 {
     for (auto& resource: resource_set) {
-        // Skip shader resources whitout a binding point
-        if (resource.type == ShaderResourceType::Input ||
-            resource.type == ShaderResourceType::Output ||
-            resource.type == ShaderResourceType::PushConstant ||
-            resource.type == ShaderResourceType::SpecializationConstant) {
+        VkDescriptorSetLayoutBinding layout_binding;
+        VkDescriptorBindingFlagsEXT  binding_flag;
+        if (!to_layout_binding(resource, layout_binding, binding_flag)) {
             continue;
         }
 
-        // Convert from ShaderResourceType to VkDescriptorType.
-        auto descriptor_type = find_descriptor_type(resource.type, resource.mode == ShaderResourceMode::Dynamic);
-
-        if (resource.mode == ShaderResourceMode::UpdateAfterBind) {
-            binding_flags.push_back(VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT);
-        } else {
-            // When creating a descriptor set layout, if we give a structure to create_info.pNext, each binding needs to have a binding flag
-            // (pBindings[i] uses the flags in pBindingFlags[i])
-            // Adding 0 ensures the bindings that dont use any flags are mapped correctly.
-            binding_flags.push_back(0);
-        }
-
-        // Convert ShaderResource to VkDescriptorSetLayoutBinding
-        VkDescriptorSetLayoutBinding layout_binding{};
-
-        layout_binding.binding         = resource.binding;
-        layout_binding.descriptorCount = resource.array_size;
-        layout_binding.descriptorType  = descriptor_type;
-        layout_binding.stageFlags      = static_cast<VkShaderStageFlags>(resource.stages);
-
         bindings.push_back(layout_binding);
+        binding_flags.push_back(binding_flag);
 
         // Store mapping between binding and the binding point
         bindings_lookup.emplace(resource.binding, layout_binding);
 
-        binding_flags_lookup.emplace(resource.binding, binding_flags.back());
+        binding_flags_lookup.emplace(resource.binding, binding_flag);
 
         resources_lookup.emplace(resource.name, resource.binding);
     }
@@ -16,9 +16,33 @@ class ShaderModule;
 
 struct ShaderResource;
 
+/**
+ * @brief 规范化的阶段标志：用到顶点或片段阶段的绑定统一包含 VERTEX|FRAGMENT，其他阶段保持不变。
+ *        只在其中一个阶段使用同一绑定的管线因此得到相同的布局，低编号的 set 在切换管线时无需重新绑定；
+ *        不扩展到全部图形阶段，避免绑定计入几何/细分阶段的 maxPerStageDescriptor* 限制。
+ *        输入附件只能用于片段阶段，保持原样
+ */
+inline VkShaderStageFlags canonicalize_stage_flags(VkShaderStageFlags stages,
+                                                   VkDescriptorType descriptor_type = VK_DESCRIPTOR_TYPE_MAX_ENUM)
+{
+    constexpr VkShaderStageFlags CANONICAL_STAGES = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    if (descriptor_type != VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT && (stages & CANONICAL_STAGES)) {
+        stages |= CANONICAL_STAGES;
+    }
+
+    return stages;
+}
+
 class vk_descriptor_set_layout
 {
 public:
+    /**
+     * @brief 由 (set, binding, 描述符类型, 数量, 规范化阶段, 绑定标志) 计算的布局键，与资源名称、
+     *        反射顺序以及来自哪些着色器模块无关
+     */
+    static std::size_t compute_key(uint32_t set_index, const std::vector<ShaderResource>& resource_set);
+
     vk_descriptor_set_layout(vk_device& device,
                              const uint32_t set_index,
                              const std::vector<ShaderModule*>& shader_modules,
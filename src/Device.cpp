@@ -16,7 +16,9 @@
 #include <vulkan/vulkan.hpp>
 #include "volk.h"
 #include "VkUtils.hpp"
+#include "Profiler.hpp"
 #include "Commands.hpp"
+#include "ResourceCaching.hpp"
 
 #define VMA_IMPLEMENTATION
 #include <vk_mem_alloc.h>
@@ -65,6 +67,54 @@ vk_device::vk_device(vk_physical_device& gpu, vk::SurfaceKHR surface,
         LOGI("开启专属分配");
     }
 
+    // 显存预算
+    bool has_memory_budget = is_extension_supported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (has_memory_budget) {
+        enabled_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+        LOGI("开启显存预算查询");
+    }
+
+    // GPU 驱动的间接绘制
+    if (is_extension_supported(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME)) {
+        enabled_extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+
+        LOGI("开启间接绘制计数");
+    }
+
+    // 异步计算与图形队列之间的时间线信号量同步
+    if (is_extension_supported(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+        auto timeline_features = gpu.request_extension_features<vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR>();
+
+        if (timeline_features.timelineSemaphore) {
+            enabled_extensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+
+            LOGI("开启时间线信号量");
+        }
+    }
+
+    // 合并提交使用 vkQueueSubmit2
+    if (is_extension_supported(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)) {
+        auto synchronization2_features = gpu.request_extension_features<vk::PhysicalDeviceSynchronization2FeaturesKHR>();
+
+        if (synchronization2_features.synchronization2) {
+            enabled_extensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+
+            LOGI("开启 synchronization2");
+        }
+    }
+
+    // 不经过 VkRenderPass / VkFramebuffer 的动态渲染
+    if (is_extension_supported(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)) {
+        auto dynamic_rendering_features = gpu.request_extension_features<vk::PhysicalDeviceDynamicRenderingFeaturesKHR>();
+
+        if (dynamic_rendering_features.dynamicRendering) {
+            enabled_extensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+
+            LOGI("开启动态渲染");
+        }
+    }
+
     // query 功能
     if (is_extension_supported(VK_KHR_PERFORMANCE_QUERY_EXTENSION_NAME)
         && is_extension_supported(VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME)) {
@@ -177,9 +227,15 @@ vk_device::vk_device(vk_physical_device& gpu, vk::SurfaceKHR surface,
         allocator_info.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
     }
 
+    if (has_memory_budget) {
+        allocator_info.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
+
     allocator_info.pVulkanFunctions = &vma_vulkan_func;
     VK_CHECK(vmaCreateAllocator(&allocator_info, &memory_allocator));
 
+    memory_telemetry = std::make_unique<vk_memory_telemetry>(*this, has_memory_budget);
+
     queue_ = &get_suitable_graphics_queue();
 
     vk::CommandPoolCreateInfo cpInfo;
@@ -192,6 +248,12 @@ vk_device::vk_device(vk_physical_device& gpu, vk::SurfaceKHR surface,
 
 vk_device::~vk_device()
 {
+    submit_batchers.clear();
+    compute_pipelines.clear();
+    pipeline_layouts.clear();
+    descriptor_set_layouts.clear();
+    samplers.clear();
+
     if (commandPool) {
         handle().destroyCommandPool(commandPool);
         commandPool = VK_NULL_HANDLE;
@@ -200,11 +262,16 @@ vk_device::~vk_device()
     fence_pool.reset();
 
     if (memory_allocator != VK_NULL_HANDLE) {
-//        vm stats;
-//        vmaCalculateStats(memory_allocator, &stats);
-//
-//        LOGI("Total device memory leaked: {} bytes.", stats.total.usedBytes);
+        VmaTotalStatistics stats{};
+        vmaCalculateStatistics(memory_allocator, &stats);
 
+        if (stats.total.statistics.allocationCount > 0) {
+            LOGW("Total device memory leaked: {} bytes in {} allocations.",
+                 stats.total.statistics.allocationBytes, stats.total.statistics.allocationCount);
+            memory_telemetry->log_summary();
+        }
+
+        memory_telemetry.reset();
         vmaDestroyAllocator(memory_allocator);
     }
 
@@ -330,6 +397,23 @@ const vk_queue& vk_device::get_suitable_graphics_queue() const
     return get_queue_by_flags(vk::QueueFlagBits::eGraphics, 0);
 }
 
+const vk_queue& vk_device::get_suitable_compute_queue() const
+{
+    const auto& graphics_queue = get_suitable_graphics_queue();
+
+    uint32_t compute_family = get_queue_family_index(vk::QueueFlagBits::eCompute);
+    if (compute_family != graphics_queue.get_family_index()) {
+        return get_queue(compute_family, 0);
+    }
+
+    // 没有专用计算族时，图形族中的第二个队列仍可与图形工作并行
+    if (graphics_queue.get_properties().queueCount > 1) {
+        return get_queue(graphics_queue.get_family_index(), 1);
+    }
+
+    return graphics_queue;
+}
+
 void vk_device::wait_idle() const
 {
     handle().waitIdle();
@@ -395,20 +479,42 @@ vk_fence_pool& vk_device::get_fence_pool()
     return *fence_pool;
 }
 
+vk_memory_telemetry& vk_device::get_memory_telemetry() const
+{
+    return *memory_telemetry;
+}
+
 std::unique_ptr<vk_buffer> vk_device::createBuffer(const vk::DeviceSize& size,
                                                    const void* data,
                                                    vk::BufferUsageFlags usage,
-                                                   vk::MemoryPropertyFlags memProps)
+                                                   vk::MemoryPropertyFlags memProps,
+                                                   MemoryCategory category,
+                                                   const std::vector<uint32_t>& queue_family_indices)
 {
+    PROFILE_SCOPE("vk_device::createBuffer");
+
     if (data != nullptr) {
         usage |= vk::BufferUsageFlagBits::eTransferDst;
     }
 
-    auto buffer = std::make_unique<vk_buffer>(*this, size, usage, vkToVmaMemoryUsage(memProps), 0);
+    // 设备本地缓冲区带上拷贝用途，使其可以被碎片整理移动
+    if (memProps & vk::MemoryPropertyFlagBits::eDeviceLocal) {
+        usage |= vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst;
+    }
+
+    std::unique_ptr<vk_buffer> buffer;
+    try {
+        buffer = std::make_unique<vk_buffer>(*this, size, usage, vkToVmaMemoryUsage(memProps), 0,
+                                             queue_family_indices, category);
+    } catch (const MemoryBudgetExceeded& e) {
+        LOGW("{}", e.what());
+        return nullptr;
+    }
 
     if (data != nullptr) {
+        PROFILE_SCOPE("vk_device::upload");
         auto staging = vk_buffer(*this, size, usage | vk::BufferUsageFlagBits::eTransferSrc,
-                                 VMA_MEMORY_USAGE_CPU_ONLY, 0);
+                                 VMA_MEMORY_USAGE_CPU_ONLY, 0, {}, MemoryCategory::Staging);
         staging.update(const_cast<void*>(data), size);
 
         auto cb = beginSingleTimeCommands();
@@ -440,14 +546,179 @@ void vk_device::endSingleTimeCommands(vk::CommandBuffer commandBuffer)
 {
     commandBuffer.end();
 
-    vk::SubmitInfo submitInfo{};
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers    = &commandBuffer;
+    PROFILE_SCOPE("vk_device::endSingleTimeCommands");
 
-    queue_->submit(commandBuffer, get_fence_pool().request_fence());
+    // 与同一队列上已入队的工作一起提交
+    auto& batcher = get_submit_batcher(*queue_);
+    batcher.enqueue({commandBuffer});
+    batcher.flush(get_fence_pool().request_fence());
 
     get_fence_pool().wait();
     get_fence_pool().reset();
 
     handle().freeCommandBuffers(commandPool, 1, &commandBuffer);
 }
+
+vk_compute_pipeline& vk_device::request_compute_pipeline(const ShaderModule& shader_module,
+                                                         const vk_pipeline_layout& pipeline_layout,
+                                                         const SpecializationConstantState& specialization_constant_state)
+{
+    std::lock_guard<std::mutex> guard(compute_pipeline_mutex);
+
+    return request_resource(*this, compute_pipelines, shader_module, pipeline_layout, specialization_constant_state);
+}
+
+vk_submit_batcher& vk_device::get_submit_batcher(const vk_queue& queue)
+{
+    std::lock_guard<std::mutex> guard(submit_batcher_mutex);
+
+    auto& batcher = submit_batchers[&queue];
+    if (!batcher) {
+        batcher = std::make_unique<vk_submit_batcher>(*this, queue);
+    }
+
+    return *batcher;
+}
+
+SubmitStatistics vk_device::end_submit_frame()
+{
+    SubmitStatistics frame_statistics;
+    {
+        std::lock_guard<std::mutex> guard(submit_batcher_mutex);
+        for (auto& [queue, batcher]: submit_batchers) {
+            auto statistics = batcher->end_frame();
+            frame_statistics.enqueued += statistics.enqueued;
+            frame_statistics.submit_infos += statistics.submit_infos;
+            frame_statistics.queue_submits += statistics.queue_submits;
+        }
+    }
+
+    auto& profiler = FrameProfiler::get();
+    profiler.record_counter("vk_submit_batcher", "enqueued", frame_statistics.enqueued);
+    profiler.record_counter("vk_submit_batcher", "queue_submits", frame_statistics.queue_submits);
+    profiler.record_counter("vk_submit_batcher", "saved_submits", frame_statistics.saved());
+
+    return frame_statistics;
+}
+
+vk_sampler& vk_device::request_sampler(const vk::SamplerCreateInfo& info)
+{
+    auto key = vk_sampler::compute_key(info);
+
+    std::lock_guard<std::mutex> guard(sampler_mutex);
+
+    auto it = samplers.find(key);
+    if (it != samplers.end()) {
+        return it->second;
+    }
+
+    LOGD("Building #{} cache object (vk_sampler)", samplers.size());
+
+    return samplers.emplace(key, vk_sampler{*this, info}).first->second;
+}
+
+bool vk_device::acquire_profiling_lock(uint64_t timeout_ns)
+{
+    std::lock_guard<std::mutex> guard{profiling_lock_mutex};
+
+    if (profiling_lock_count == 0) {
+        VkAcquireProfilingLockInfoKHR lock_info{VK_STRUCTURE_TYPE_ACQUIRE_PROFILING_LOCK_INFO_KHR};
+        lock_info.timeout = timeout_ns;
+
+        VkResult result = vkAcquireProfilingLockKHR(handle(), &lock_info);
+        if (result != VK_SUCCESS) {
+            LOGW("获取 profiling lock 失败: {}", vk::to_string(static_cast<vk::Result>(result)));
+            return false;
+        }
+    }
+
+    ++profiling_lock_count;
+    return true;
+}
+
+void vk_device::release_profiling_lock()
+{
+    std::lock_guard<std::mutex> guard{profiling_lock_mutex};
+
+    assert(profiling_lock_count > 0 && "Releasing a profiling lock that isn't held");
+    if (profiling_lock_count > 0 && --profiling_lock_count == 0) {
+        vkReleaseProfilingLockKHR(handle());
+    }
+}
+
+bool vk_device::is_profiling_lock_held() const
+{
+    std::lock_guard<std::mutex> guard{profiling_lock_mutex};
+    return profiling_lock_count > 0;
+}
+
+vk_descriptor_set_layout& vk_device::request_descriptor_set_layout(uint32_t set_index,
+                                                                   const std::vector<ShaderModule*>& shader_modules,
+                                                                   const std::vector<ShaderResource>& resources)
+{
+    std::lock_guard<std::mutex> guard(descriptor_set_layout_mutex);
+
+    auto key = vk_descriptor_set_layout::compute_key(set_index, resources);
+
+    auto it = descriptor_set_layouts.find(key);
+    if (it != descriptor_set_layouts.end()) {
+        return it->second;
+    }
+
+    LOGD("Building #{} cache object (vk_descriptor_set_layout)", descriptor_set_layouts.size());
+
+    return descriptor_set_layouts.emplace(key, vk_descriptor_set_layout{*this, set_index, shader_modules, resources})
+        .first->second;
+}
+
+vk_pipeline_layout& vk_device::request_pipeline_layout(const std::vector<ShaderModule*>& shader_modules)
+{
+    std::vector<ShaderResource>        resources;
+    std::vector<vk::PushConstantRange> push_constant_ranges;
+    vk_pipeline_layout::merge_shader_resources(shader_modules, resources, push_constant_ranges);
+
+    std::vector<std::vector<ShaderResource>> set_resources;
+    for (const auto& resource: resources) {
+        if (resource.type == ShaderResourceType::Input ||
+            resource.type == ShaderResourceType::Output ||
+            resource.type == ShaderResourceType::PushConstant ||
+            resource.type == ShaderResourceType::SpecializationConstant) {
+            continue;
+        }
+
+        if (set_resources.size() <= resource.set) {
+            set_resources.resize(resource.set + 1);
+        }
+        set_resources[resource.set].push_back(resource);
+    }
+
+    // set 编号必须连续，中间未使用的 set 以空布局占位
+    std::vector<vk_descriptor_set_layout*> set_layouts;
+    for (uint32_t set_index = 0; set_index < to_u32(set_resources.size()); ++set_index) {
+        set_layouts.push_back(&request_descriptor_set_layout(set_index, shader_modules, set_resources[set_index]));
+    }
+
+    std::size_t key = 0;
+    for (auto* set_layout: set_layouts) {
+        hash_combine(key, set_layout->get_handle());
+    }
+    for (const auto& range: push_constant_ranges) {
+        hash_combine(key, static_cast<VkShaderStageFlags>(range.stageFlags));
+        hash_combine(key, range.offset);
+        hash_combine(key, range.size);
+    }
+
+    std::lock_guard<std::mutex> guard(pipeline_layout_mutex);
+
+    auto it = pipeline_layouts.find(key);
+    if (it != pipeline_layouts.end()) {
+        return *it->second;
+    }
+
+    LOGD("Building #{} cache object (vk_pipeline_layout)", pipeline_layouts.size());
+
+    auto pipeline_layout = std::make_unique<vk_pipeline_layout>(*this, std::move(resources), std::move(set_layouts),
+                                                                std::move(push_constant_ranges));
+
+    return *pipeline_layouts.emplace(key, std::move(pipeline_layout)).first->second;
+}
@@ -10,6 +10,12 @@
 #include "VkCommon.hpp"
 #include "VkUnit.hpp"
 #include "CommandBuffer.hpp"
+#include "MemoryTelemetry.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Pipeline.hpp"
+#include "SubmitBatcher.hpp"
+#include "Sampler.hpp"
+#include <mutex>
 #include <vector>
 
 class vk_debug_utils;
@@ -52,6 +58,11 @@ public:
 
     const vk_queue& get_suitable_graphics_queue() const;
 
+    /**
+     * @brief 优先返回专用计算队列族中的队列，其次是图形队列族中的另一个队列，都没有时返回图形队列
+     */
+    const vk_queue& get_suitable_compute_queue() const;
+
     bool is_extension_supported(const std::string& extension) const;
 
     bool is_enabled(const std::string& extension) const;
@@ -71,19 +82,23 @@ public:
                                                         vk::MemoryPropertyFlags properties) const;
 
     //--------------------------------------------------------------------------------------------------
-    // 创建缓冲区
+    // 创建缓冲区，类别超出预算且无法回收时返回 nullptr
 
     std::unique_ptr<vk_buffer> createBuffer(const vk::DeviceSize& size,
                                             const void* data,
                                             vk::BufferUsageFlags usage,
-                                            vk::MemoryPropertyFlags memProps = vk::MemoryPropertyFlagBits::eDeviceLocal);
+                                            vk::MemoryPropertyFlags memProps = vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                            MemoryCategory category = MemoryCategory::Other,
+                                            const std::vector<uint32_t>& queue_family_indices = {});
 
     template<typename T>
     std::unique_ptr<vk_buffer> createBuffer(const std::vector<T>& data,
                                             vk::BufferUsageFlags usage,
-                                            vk::MemoryPropertyFlags memProps_ = vk::MemoryPropertyFlagBits::eDeviceLocal)
+                                            vk::MemoryPropertyFlags memProps_ = vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                            MemoryCategory category = MemoryCategory::Other,
+                                            const std::vector<uint32_t>& queue_family_indices = {})
     {
-        return createBuffer(sizeof(T) * data.size(), data.data(), usage, memProps_);
+        return createBuffer(sizeof(T) * data.size(), data.data(), usage, memProps_, category, queue_family_indices);
     }
     
     vk::CommandBuffer beginSingleTimeCommands();
@@ -93,6 +108,55 @@ public:
 
     vk_fence_pool& get_fence_pool();
 
+    /**
+     * @brief 每个队列一个提交合并器，首次请求时创建
+     */
+    vk_submit_batcher& get_submit_batcher(const vk_queue& queue);
+
+    /**
+     * @brief 汇总并清零所有合并器的本帧统计，记录到 FrameProfiler 的 "vk_submit_batcher" 计数器
+     */
+    SubmitStatistics end_submit_frame();
+
+    vk_memory_telemetry& get_memory_telemetry() const;
+
+    /**
+     * @brief 设备范围的描述符集布局缓存，键见 vk_descriptor_set_layout::compute_key。
+     *        内容相同的布局只创建一次，与请求它的着色器无关
+     */
+    vk_descriptor_set_layout& request_descriptor_set_layout(uint32_t set_index,
+                                                            const std::vector<ShaderModule*>& shader_modules,
+                                                            const std::vector<ShaderResource>& resources);
+
+    /**
+     * @brief 设备范围的管线布局缓存，以各 set 的布局与推送常量范围为键，
+     *        接口相同的着色器组合得到同一个布局，因而在切换管线时描述符集保持兼容
+     */
+    vk_pipeline_layout& request_pipeline_layout(const std::vector<ShaderModule*>& shader_modules);
+
+    /**
+     * @brief 按 (着色器模块, 管线布局, 特化常量) 的哈希缓存计算管线，相同的键只创建一次
+     */
+    vk_compute_pipeline& request_compute_pipeline(const ShaderModule& shader_module,
+                                                  const vk_pipeline_layout& pipeline_layout,
+                                                  const SpecializationConstantState& specialization_constant_state = {});
+
+    /**
+     * @brief 设备范围的采样器缓存，键见 vk_sampler::compute_key。
+     *        参数相同的采样器共享同一个句柄，避免超出 maxSamplerAllocationCount
+     */
+    vk_sampler& request_sampler(const vk::SamplerCreateInfo& info);
+
+    /**
+     * @brief profiling lock 属于整个设备，这里以引用计数管理：
+     *        第一次请求时调用 vkAcquireProfilingLockKHR，最后一次释放时调用 vkReleaseProfilingLockKHR
+     */
+    bool acquire_profiling_lock(uint64_t timeout_ns = UINT64_MAX);
+
+    void release_profiling_lock();
+
+    bool is_profiling_lock_held() const;
+
 private:
     const vk_physical_device& gpu;
 
@@ -112,4 +176,30 @@ private:
     vk::CommandPool commandPool{VK_NULL_HANDLE};
 
     std::unique_ptr<vk_fence_pool> fence_pool;
+
+    std::unique_ptr<vk_memory_telemetry> memory_telemetry;
+
+    std::unordered_map<std::size_t, vk_descriptor_set_layout> descriptor_set_layouts;
+
+    std::mutex descriptor_set_layout_mutex;
+
+    std::unordered_map<std::size_t, std::unique_ptr<vk_pipeline_layout>> pipeline_layouts;
+
+    std::mutex pipeline_layout_mutex;
+
+    std::unordered_map<std::size_t, vk_compute_pipeline> compute_pipelines;
+
+    std::mutex compute_pipeline_mutex;
+
+    std::unordered_map<std::size_t, vk_sampler> samplers;
+
+    std::mutex sampler_mutex;
+
+    std::unordered_map<const vk_queue*, std::unique_ptr<vk_submit_batcher>> submit_batchers;
+
+    std::mutex submit_batcher_mutex;
+
+    uint32_t profiling_lock_count{0};
+
+    mutable std::mutex profiling_lock_mutex;
 };
\ No newline at end of file
@@ -0,0 +1,170 @@
+﻿/**
+ * @File DrawBatcher.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "DrawBatcher.hpp"
+#include "CommandRecorder.hpp"
+#include "RenderFrame.hpp"
+#include "Profiler.hpp"
+#include "Helpers.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+namespace {
+auto make_sort_key(VkPipeline pipeline, uint64_t material, const GeometryRange& mesh)
+{
+    return std::make_tuple(reinterpret_cast<uint64_t>(pipeline), material, mesh.page, mesh.first_index,
+                           mesh.vertex_offset, mesh.index_count);
+}
+}        // namespace
+
+void vk_draw_batcher::submit(VkPipeline pipeline, uint64_t material, const GeometryRange& mesh,
+                             const InstanceData& instance, float depth)
+{
+    auto index = static_cast<uint32_t>(items.size());
+
+    // id 超出排序键位宽时只影响排序质量，批次合并仍比较完整的状态
+    queue.push(render_key::make(0, get_pipeline_id(pipeline), get_material_id(material), get_mesh_id(mesh),
+                                render_key::quantize_depth(depth)),
+               index);
+
+    items.push_back({pipeline, material, mesh, static_cast<uint32_t>(instances.size())});
+    instances.push_back(instance);
+}
+
+bool vk_draw_batcher::build(vk_render_frame& frame, size_t thread_index)
+{
+    PROFILE_SCOPE("vk_draw_batcher::build");
+
+    batches.clear();
+    packed_instances.clear();
+    instance_allocation = {};
+    instance_buffer_info = {VK_NULL_HANDLE, 0, 0};
+
+    stats                 = {};
+    stats.draws_submitted = static_cast<uint32_t>(items.size());
+    stats.instances       = static_cast<uint32_t>(items.size());
+
+    if (items.empty()) {
+        return false;
+    }
+
+    // 相同的 管线 + 材质 + 网格 排在一起，同时减少管线与材质的切换
+    queue.sort();
+
+    packed_instances.reserve(items.size());
+    for (auto& entry: queue.get_entries()) {
+        const auto& item = items[entry.payload];
+        auto instance_index = static_cast<uint32_t>(packed_instances.size());
+        packed_instances.push_back(instances[item.instance]);
+
+        if (!batches.empty()) {
+            auto& last = batches.back();
+            if (make_sort_key(last.pipeline, last.material, last.mesh)
+                == make_sort_key(item.pipeline, item.material, item.mesh)) {
+                ++last.instance_count;
+                continue;
+            }
+        }
+
+        batches.push_back({item.pipeline, item.material, item.mesh, instance_index, 1});
+    }
+
+    stats.draws_issued = static_cast<uint32_t>(batches.size());
+
+    auto size = static_cast<VkDeviceSize>(packed_instances.size() * sizeof(InstanceData));
+    instance_allocation = frame.allocate_buffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, size, thread_index);
+    if (instance_allocation.empty()) {
+        LOGE("分配逐实例数据失败 ({} 字节)", size);
+        batches.clear();
+        return false;
+    }
+
+    instance_allocation.get_buffer().update(reinterpret_cast<const uint8_t*>(packed_instances.data()), size,
+                                            instance_allocation.get_offset());
+
+    instance_buffer_info = {instance_allocation.get_buffer().handle(), instance_allocation.get_offset(), size};
+
+    FrameProfiler::get().record_counter("vk_draw_batcher", "draws_before", stats.draws_submitted);
+    FrameProfiler::get().record_counter("vk_draw_batcher", "draws_after", stats.draws_issued);
+
+    return true;
+}
+
+void vk_draw_batcher::record(vk_command_recorder& recorder, const vk_geometry_arena& arena,
+                             const BindCallback& bind) const
+{
+    VkCommandBuffer command_buffer = recorder.handle();
+
+    VkPipeline current_pipeline = VK_NULL_HANDLE;
+    uint64_t   current_material = 0;
+    uint32_t   current_page     = ~0u;
+    bool       first            = true;
+
+    for (auto& batch: batches) {
+        if (first || batch.pipeline != current_pipeline || batch.material != current_material) {
+            bind(recorder, batch.pipeline, batch.material);
+            current_pipeline = batch.pipeline;
+            current_material = batch.material;
+            first            = false;
+        }
+
+        if (batch.mesh.page != current_page) {
+            arena.bind(command_buffer, batch.mesh.page);
+            current_page = batch.mesh.page;
+        }
+
+        arena.draw(command_buffer, batch.mesh, batch.instance_count, batch.first_instance);
+    }
+}
+
+void vk_draw_batcher::clear()
+{
+    items.clear();
+    instances.clear();
+    queue.clear();
+
+    pipeline_ids.clear();
+    material_ids.clear();
+    mesh_ids.clear();
+}
+
+VkDescriptorBufferInfo vk_draw_batcher::get_instance_buffer_info() const
+{
+    return instance_buffer_info;
+}
+
+const std::vector<DrawBatch>& vk_draw_batcher::get_batches() const
+{
+    return batches;
+}
+
+const DrawBatchStats& vk_draw_batcher::get_stats() const
+{
+    return stats;
+}
+
+uint32_t vk_draw_batcher::get_pipeline_id(VkPipeline pipeline)
+{
+    return pipeline_ids.emplace(pipeline, static_cast<uint32_t>(pipeline_ids.size())).first->second;
+}
+
+uint32_t vk_draw_batcher::get_material_id(uint64_t material)
+{
+    return material_ids.emplace(material, static_cast<uint32_t>(material_ids.size())).first->second;
+}
+
+uint32_t vk_draw_batcher::get_mesh_id(const GeometryRange& mesh)
+{
+    std::size_t key = 0;
+    hash_combine(key, mesh.page);
+    hash_combine(key, mesh.first_index);
+    hash_combine(key, mesh.vertex_offset);
+    hash_combine(key, mesh.index_count);
+
+    return mesh_ids.emplace(key, static_cast<uint32_t>(mesh_ids.size())).first->second;
+}
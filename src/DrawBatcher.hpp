@@ -0,0 +1,127 @@
+﻿/**
+ * @File DrawBatcher.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 自动实例化：合并网格、管线、材质相同的绘制
+ */
+
+#pragma once
+
+#include "VkCommon.hpp"
+#include "BufferPool.hpp"
+#include "GeometryArena.hpp"
+#include "RenderQueue.hpp"
+
+#include <functional>
+#include <glm/glm.hpp>
+
+class vk_render_frame;
+class vk_command_recorder;
+
+/**
+ * @brief 每个实例写入存储缓冲区的数据（std430），着色器以 gl_InstanceIndex 索引
+ */
+struct InstanceData
+{
+    glm::mat4 model{1.0f};
+    glm::vec4 params{0.0f};        // 材质相关的逐实例参数，例如颜色
+};
+
+struct DrawBatch
+{
+    VkPipeline    pipeline{VK_NULL_HANDLE};
+    uint64_t      material{0};
+    GeometryRange mesh;
+    uint32_t      first_instance{0};
+    uint32_t      instance_count{0};
+};
+
+struct DrawBatchStats
+{
+    uint32_t draws_submitted{0};        // 合并前的绘制数
+    uint32_t draws_issued{0};           // 合并后的绘制数
+    uint32_t instances{0};
+};
+
+/**
+ * @brief 收集一帧中的绘制，把网格 + 管线 + 材质相同的绘制合并为一次实例化绘制
+ *
+ * 绘制按 管线 | 材质 | 网格 | 深度 的排序键经 vk_render_queue 基数排序，同一批次内的实例由近到远排列。
+ * 逐实例数据按批次顺序打包进当前帧 vk_render_frame::allocate_buffer 分配的存储缓冲区，
+ * 批次的 firstInstance 即为其数据在缓冲区中的起始下标。
+ * 用法：submit() 若干次 -> build() -> 绑定 get_instance_buffer_info() -> record()。
+ */
+class vk_draw_batcher
+{
+public:
+    /**
+     * @brief 管线或材质变化时调用，负责绑定管线与材质的描述符集
+     */
+    using BindCallback = std::function<void(vk_command_recorder&, VkPipeline, uint64_t)>;
+
+    vk_draw_batcher() = default;
+
+    vk_draw_batcher(const vk_draw_batcher&) = delete;
+    vk_draw_batcher(vk_draw_batcher&&) = delete;
+
+    vk_draw_batcher& operator=(const vk_draw_batcher&) = delete;
+    vk_draw_batcher& operator=(vk_draw_batcher&&) = delete;
+
+    /**
+     * @param depth 归一化的视空间深度 [0, 1]，用于由近到远排列
+     */
+    void submit(VkPipeline pipeline, uint64_t material, const GeometryRange& mesh, const InstanceData& instance,
+                float depth = 0.0f);
+
+    /**
+     * @brief 排序合并并上传逐实例数据，返回是否有需要绘制的内容
+     */
+    bool build(vk_render_frame& frame, size_t thread_index = 0);
+
+    void record(vk_command_recorder& recorder, const vk_geometry_arena& arena, const BindCallback& bind) const;
+
+    /**
+     * @brief 清空已提交的绘制，统计保留到下一次 build()
+     */
+    void clear();
+
+    VkDescriptorBufferInfo get_instance_buffer_info() const;
+
+    const std::vector<DrawBatch>& get_batches() const;
+
+    const DrawBatchStats& get_stats() const;
+
+private:
+    struct DrawItem
+    {
+        VkPipeline    pipeline;
+        uint64_t      material;
+        GeometryRange mesh;
+        uint32_t      instance;
+    };
+
+    uint32_t get_pipeline_id(VkPipeline pipeline);
+
+    uint32_t get_material_id(uint64_t material);
+
+    uint32_t get_mesh_id(const GeometryRange& mesh);
+
+    std::vector<DrawItem>     items;
+    std::vector<InstanceData> instances;
+
+    // 排序键中使用的紧凑 id，每次 clear() 后重新分配
+    std::unordered_map<VkPipeline, uint32_t>  pipeline_ids;
+    std::unordered_map<uint64_t, uint32_t>    material_ids;
+    std::unordered_map<std::size_t, uint32_t> mesh_ids;
+
+    vk_render_queue queue;
+
+    std::vector<DrawBatch>    batches;
+    std::vector<InstanceData> packed_instances;
+
+    vk_buffer_allocation instance_allocation;
+
+    VkDescriptorBufferInfo instance_buffer_info{VK_NULL_HANDLE, 0, 0};
+
+    DrawBatchStats stats;
+};
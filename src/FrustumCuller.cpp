@@ -0,0 +1,662 @@
+﻿/**
+ * @File FrustumCuller.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "FrustumCuller.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define VK_CULL_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VK_CULL_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VK_CULL_NEON 1
+#endif
+
+namespace {
+constexpr uint32_t ALL_PLANES = 0x3F;
+
+inline uint32_t count_trailing_zeros(uint32_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return index;
+#else
+    return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
+}
+
+inline void normalize_plane(float* plane)
+{
+    float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+    if (length > 0.0f) {
+        for (int i = 0; i < 4; ++i) {
+            plane[i] /= length;
+        }
+    }
+}
+}        // namespace
+
+Frustum Frustum::from_matrix(const float* m, bool zero_to_one)
+{
+    // 第 i 行为 (m[i], m[4 + i], m[8 + i], m[12 + i])
+    auto row = [m](int i, int j) { return m[j * 4 + i]; };
+
+    Frustum frustum;
+    for (int j = 0; j < 4; ++j) {
+        frustum.planes[0][j] = row(3, j) + row(0, j);
+        frustum.planes[1][j] = row(3, j) - row(0, j);
+        frustum.planes[2][j] = row(3, j) + row(1, j);
+        frustum.planes[3][j] = row(3, j) - row(1, j);
+        frustum.planes[4][j] = zero_to_one ? row(2, j) : row(3, j) + row(2, j);
+        frustum.planes[5][j] = row(3, j) - row(2, j);
+    }
+
+    for (auto& plane: frustum.planes) {
+        normalize_plane(plane);
+    }
+
+    return frustum;
+}
+
+FrustumCuller::FrustumCuller(uint32_t worker_count)
+{
+    if (worker_count == 0) {
+        uint32_t hardware = std::thread::hardware_concurrency();
+        worker_count = hardware > 1 ? hardware - 1 : 0;
+    }
+
+    workers.reserve(worker_count);
+    for (uint32_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back(&FrustumCuller::worker_loop, this);
+    }
+}
+
+FrustumCuller::~FrustumCuller()
+{
+    {
+        std::lock_guard<std::mutex> lock{job_mutex};
+        stopping = true;
+    }
+    job_start.notify_all();
+
+    for (auto& worker: workers) {
+        worker.join();
+    }
+}
+
+void FrustumCuller::build(const std::vector<BoundingSphere>& spheres)
+{
+    auto count = static_cast<uint32_t>(spheres.size());
+
+    slot_to_object.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        slot_to_object[i] = i;
+    }
+
+    // 构建时交错存放质心，便于按轴划分
+    std::vector<float> centroids(size_t{count} * 3);
+    for (uint32_t i = 0; i < count; ++i) {
+        centroids[i * 3 + 0] = spheres[i].x;
+        centroids[i * 3 + 1] = spheres[i].y;
+        centroids[i * 3 + 2] = spheres[i].z;
+    }
+
+    center_x.resize(count);
+    center_y.resize(count);
+    center_z.resize(count);
+    radius.resize(count);
+    object_to_slot.resize(count);
+    slot_to_leaf.resize(count);
+
+    nodes.clear();
+    nodes.reserve(count / (LEAF_SIZE / 2) + 1);
+    if (count > 0) {
+        build_recursive(0, count, 0, centroids);
+    }
+
+    // 按叶子顺序重排为 SoA
+    for (uint32_t slot = 0; slot < count; ++slot) {
+        auto& sphere = spheres[slot_to_object[slot]];
+        center_x[slot] = sphere.x;
+        center_y[slot] = sphere.y;
+        center_z[slot] = sphere.z;
+        radius[slot]   = sphere.radius;
+        object_to_slot[slot_to_object[slot]] = slot;
+    }
+
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i].right == 0) {
+            std::fill(slot_to_leaf.begin() + nodes[i].object_begin, slot_to_leaf.begin() + nodes[i].object_end, i);
+        }
+    }
+
+    dirty.assign(nodes.size(), 1);
+    any_dirty = true;
+    refit();
+
+    build_tasks();
+}
+
+uint32_t FrustumCuller::build_recursive(uint32_t begin, uint32_t end, uint32_t parent, std::vector<float>& centroids)
+{
+    auto index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back({});
+    nodes[index].object_begin = begin;
+    nodes[index].object_end   = end;
+    nodes[index].right        = 0;
+    nodes[index].parent       = parent;
+
+    if (end - begin <= LEAF_SIZE) {
+        return index;
+    }
+
+    float lo[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                   std::numeric_limits<float>::max()};
+    float hi[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                   std::numeric_limits<float>::lowest()};
+    for (uint32_t i = begin; i < end; ++i) {
+        const float* c = &centroids[slot_to_object[i] * 3];
+        for (int axis = 0; axis < 3; ++axis) {
+            lo[axis] = std::min(lo[axis], c[axis]);
+            hi[axis] = std::max(hi[axis], c[axis]);
+        }
+    }
+
+    int axis = 0;
+    for (int i = 1; i < 3; ++i) {
+        if (hi[i] - lo[i] > hi[axis] - lo[axis]) {
+            axis = i;
+        }
+    }
+
+    // 中位数划分，并对齐到叶子大小，使左子树的叶子尽量填满
+    uint32_t mid = begin + ((end - begin) / 2 + LEAF_SIZE - 1) / LEAF_SIZE * LEAF_SIZE;
+    mid = std::min(mid, end - 1);
+    std::nth_element(slot_to_object.begin() + begin, slot_to_object.begin() + mid, slot_to_object.begin() + end,
+                     [&centroids, axis](uint32_t a, uint32_t b) {
+                         return centroids[a * 3 + axis] < centroids[b * 3 + axis];
+                     });
+
+    build_recursive(begin, mid, index, centroids);
+    uint32_t right = build_recursive(mid, end, index, centroids);
+    nodes[index].right = right;
+
+    return index;
+}
+
+void FrustumCuller::update(uint32_t object, const BoundingSphere& sphere)
+{
+    assert(object < object_to_slot.size());
+    uint32_t slot = object_to_slot[object];
+
+    center_x[slot] = sphere.x;
+    center_y[slot] = sphere.y;
+    center_z[slot] = sphere.z;
+    radius[slot]   = sphere.radius;
+
+    // 标记叶子及其祖先，遇到已标记的节点即可停止
+    uint32_t node = slot_to_leaf[slot];
+    while (!dirty[node]) {
+        dirty[node] = 1;
+        if (node == 0) {
+            break;
+        }
+        node = nodes[node].parent;
+    }
+    any_dirty = true;
+}
+
+void FrustumCuller::refit()
+{
+    if (!any_dirty) {
+        return;
+    }
+
+    // 孩子的下标总是大于父节点，逆序遍历即可自底向上
+    for (size_t i = nodes.size(); i-- > 0;) {
+        if (dirty[i]) {
+            compute_bounds(nodes[i]);
+            dirty[i] = 0;
+        }
+    }
+    any_dirty = false;
+}
+
+void FrustumCuller::compute_bounds(Node& node) const
+{
+    if (node.right != 0) {
+        auto& left  = *(&node + 1);
+        auto& right = nodes[node.right];
+        for (int axis = 0; axis < 3; ++axis) {
+            node.min[axis] = std::min(left.min[axis], right.min[axis]);
+            node.max[axis] = std::max(left.max[axis], right.max[axis]);
+        }
+        return;
+    }
+
+    float lo[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                   std::numeric_limits<float>::max()};
+    float hi[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                   std::numeric_limits<float>::lowest()};
+    for (uint32_t i = node.object_begin; i < node.object_end; ++i) {
+        lo[0] = std::min(lo[0], center_x[i] - radius[i]);
+        lo[1] = std::min(lo[1], center_y[i] - radius[i]);
+        lo[2] = std::min(lo[2], center_z[i] - radius[i]);
+        hi[0] = std::max(hi[0], center_x[i] + radius[i]);
+        hi[1] = std::max(hi[1], center_y[i] + radius[i]);
+        hi[2] = std::max(hi[2], center_z[i] + radius[i]);
+    }
+
+    std::copy(lo, lo + 3, node.min);
+    std::copy(hi, hi + 3, node.max);
+}
+
+void FrustumCuller::cull(const Frustum& frustum, std::vector<uint32_t>& visible)
+{
+    visible.clear();
+    if (nodes.empty()) {
+        return;
+    }
+
+    if (workers.empty()) {
+        cull_single_threaded(frustum, visible);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{job_mutex};
+        job_frustum = &frustum;
+        job_pending = static_cast<uint32_t>(workers.size());
+        next_task.store(0, std::memory_order_relaxed);
+        ++job_generation;
+    }
+    job_start.notify_all();
+
+    process_tasks();
+
+    {
+        std::unique_lock<std::mutex> lock{job_mutex};
+        job_done.wait(lock, [this] { return job_pending == 0; });
+        job_frustum = nullptr;
+    }
+
+    size_t total = 0;
+    for (auto& output: task_outputs) {
+        total += output.size();
+    }
+    visible.reserve(total);
+    for (auto& output: task_outputs) {
+        visible.insert(visible.end(), output.begin(), output.end());
+    }
+}
+
+void FrustumCuller::cull_single_threaded(const Frustum& frustum, std::vector<uint32_t>& visible) const
+{
+    visible.clear();
+    if (!nodes.empty()) {
+        traverse(frustum, 0, visible);
+    }
+}
+
+void FrustumCuller::cull_flat(const Frustum& frustum, std::vector<uint32_t>& visible) const
+{
+    visible.clear();
+    test_range(frustum, ALL_PLANES, 0, static_cast<uint32_t>(center_x.size()), visible);
+}
+
+size_t FrustumCuller::get_object_count() const
+{
+    return center_x.size();
+}
+
+size_t FrustumCuller::get_node_count() const
+{
+    return nodes.size();
+}
+
+uint32_t FrustumCuller::get_thread_count() const
+{
+    return static_cast<uint32_t>(workers.size()) + 1;
+}
+
+const char* FrustumCuller::get_simd_name()
+{
+#if defined(VK_CULL_AVX)
+    return "AVX";
+#elif defined(VK_CULL_SSE)
+    return "SSE2";
+#elif defined(VK_CULL_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+void FrustumCuller::traverse(const Frustum& frustum, uint32_t root, std::vector<uint32_t>& out) const
+{
+    struct StackEntry
+    {
+        uint32_t node;
+        uint32_t plane_mask;
+    };
+
+    StackEntry stack[64];
+    uint32_t   stack_size = 0;
+    stack[stack_size++] = {root, ALL_PLANES};
+
+    while (stack_size > 0) {
+        auto [index, mask] = stack[--stack_size];
+        const Node& node = nodes[index];
+
+        float center[3], extent[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            center[axis] = (node.min[axis] + node.max[axis]) * 0.5f;
+            extent[axis] = (node.max[axis] - node.min[axis]) * 0.5f;
+        }
+
+        bool outside = false;
+        for (uint32_t bits = mask; bits != 0; bits &= bits - 1) {
+            uint32_t     p     = count_trailing_zeros(bits);
+            const float* plane = frustum.planes[p];
+
+            float distance = plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3];
+            float reach    = std::abs(plane[0]) * extent[0] + std::abs(plane[1]) * extent[1]
+                             + std::abs(plane[2]) * extent[2];
+
+            if (distance < -reach) {
+                outside = true;
+                break;
+            }
+            if (distance >= reach) {
+                mask &= ~(1u << p);        // 完全在该平面内侧，子树无需再测
+            }
+        }
+
+        if (outside) {
+            continue;
+        }
+
+        if (mask == 0) {
+            for (uint32_t i = node.object_begin; i < node.object_end; ++i) {
+                out.push_back(slot_to_object[i]);
+            }
+            continue;
+        }
+
+        if (node.right == 0) {
+            test_range(frustum, mask, node.object_begin, node.object_end, out);
+            continue;
+        }
+
+        assert(stack_size + 2 <= 64);
+        stack[stack_size++] = {node.right, mask};
+        stack[stack_size++] = {index + 1, mask};
+    }
+}
+
+void FrustumCuller::test_range(const Frustum& frustum, uint32_t plane_mask, uint32_t begin, uint32_t end,
+                               std::vector<uint32_t>& out) const
+{
+    uint32_t planes[6];
+    uint32_t plane_count = 0;
+    for (uint32_t bits = plane_mask; bits != 0; bits &= bits - 1) {
+        planes[plane_count++] = count_trailing_zeros(bits);
+    }
+
+    uint32_t i = begin;
+
+#if defined(VK_CULL_AVX)
+    for (; i + 8 <= end; i += 8) {
+        __m256 cx = _mm256_loadu_ps(&center_x[i]);
+        __m256 cy = _mm256_loadu_ps(&center_y[i]);
+        __m256 cz = _mm256_loadu_ps(&center_z[i]);
+        __m256 nr = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&radius[i]));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (uint32_t p = 0; p < plane_count; ++p) {
+            const float* plane = frustum.planes[planes[p]];
+            __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane[0])), _mm256_mul_ps(cy, _mm256_set1_ps(plane[1]))),
+                _mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(plane[2])), _mm256_set1_ps(plane[3])));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, nr, _CMP_GT_OQ));
+        }
+
+        for (auto bits = static_cast<uint32_t>(_mm256_movemask_ps(inside)); bits != 0; bits &= bits - 1) {
+            out.push_back(slot_to_object[i + count_trailing_zeros(bits)]);
+        }
+    }
+#elif defined(VK_CULL_SSE)
+    for (; i + 4 <= end; i += 4) {
+        __m128 cx = _mm_loadu_ps(&center_x[i]);
+        __m128 cy = _mm_loadu_ps(&center_y[i]);
+        __m128 cz = _mm_loadu_ps(&center_z[i]);
+        __m128 nr = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius[i]));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (uint32_t p = 0; p < plane_count; ++p) {
+            const float* plane = frustum.planes[planes[p]];
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane[0])), _mm_mul_ps(cy, _mm_set1_ps(plane[1]))),
+                _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane[2])), _mm_set1_ps(plane[3])));
+            inside = _mm_and_ps(inside, _mm_cmpgt_ps(distance, nr));
+        }
+
+        for (auto bits = static_cast<uint32_t>(_mm_movemask_ps(inside)); bits != 0; bits &= bits - 1) {
+            out.push_back(slot_to_object[i + count_trailing_zeros(bits)]);
+        }
+    }
+#elif defined(VK_CULL_NEON)
+    for (; i + 4 <= end; i += 4) {
+        float32x4_t cx = vld1q_f32(&center_x[i]);
+        float32x4_t cy = vld1q_f32(&center_y[i]);
+        float32x4_t cz = vld1q_f32(&center_z[i]);
+        float32x4_t nr = vnegq_f32(vld1q_f32(&radius[i]));
+
+        uint32x4_t inside = vdupq_n_u32(~0u);
+        for (uint32_t p = 0; p < plane_count; ++p) {
+            const float* plane    = frustum.planes[planes[p]];
+            float32x4_t  distance = vdupq_n_f32(plane[3]);
+            distance = vmlaq_n_f32(distance, cx, plane[0]);
+            distance = vmlaq_n_f32(distance, cy, plane[1]);
+            distance = vmlaq_n_f32(distance, cz, plane[2]);
+            inside   = vandq_u32(inside, vcgtq_f32(distance, nr));
+        }
+
+        // 每个通道取一位拼成掩码
+        static const uint32_t lane_bits_data[4] = {1, 2, 4, 8};
+        uint32x4_t lane_bits = vandq_u32(inside, vld1q_u32(lane_bits_data));
+        uint32_t   bits      = vgetq_lane_u32(lane_bits, 0) | vgetq_lane_u32(lane_bits, 1)
+                               | vgetq_lane_u32(lane_bits, 2) | vgetq_lane_u32(lane_bits, 3);
+        for (; bits != 0; bits &= bits - 1) {
+            out.push_back(slot_to_object[i + count_trailing_zeros(bits)]);
+        }
+    }
+#endif
+
+    for (; i < end; ++i) {
+        bool inside = true;
+        for (uint32_t p = 0; p < plane_count && inside; ++p) {
+            const float* plane = frustum.planes[planes[p]];
+            float distance = plane[0] * center_x[i] + plane[1] * center_y[i] + plane[2] * center_z[i] + plane[3];
+            inside = distance > -radius[i];
+        }
+        if (inside) {
+            out.push_back(slot_to_object[i]);
+        }
+    }
+}
+
+void FrustumCuller::build_tasks()
+{
+    tasks.clear();
+    if (nodes.empty()) {
+        task_outputs.clear();
+        return;
+    }
+
+    // 广度优先展开，直到任务数足够让各线程均衡
+    const size_t target = size_t{get_thread_count()} * 8;
+
+    std::vector<uint32_t> frontier{0};
+    while (frontier.size() < target) {
+        std::vector<uint32_t> next;
+        bool                  expanded = false;
+        for (auto index: frontier) {
+            if (nodes[index].right != 0) {
+                next.push_back(index + 1);
+                next.push_back(nodes[index].right);
+                expanded = true;
+            } else {
+                next.push_back(index);
+            }
+        }
+        frontier.swap(next);
+        if (!expanded) {
+            break;
+        }
+    }
+
+    // 保持对象顺序，使输出与单线程遍历一致
+    std::sort(frontier.begin(), frontier.end(), [this](uint32_t a, uint32_t b) {
+        return nodes[a].object_begin < nodes[b].object_begin;
+    });
+
+    tasks = std::move(frontier);
+    task_outputs.resize(tasks.size());
+}
+
+void FrustumCuller::worker_loop()
+{
+    uint64_t seen_generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock{job_mutex};
+            job_start.wait(lock, [this, seen_generation] { return stopping || job_generation != seen_generation; });
+            if (stopping) {
+                return;
+            }
+            seen_generation = job_generation;
+        }
+
+        process_tasks();
+
+        {
+            std::lock_guard<std::mutex> lock{job_mutex};
+            --job_pending;
+        }
+        job_done.notify_one();
+    }
+}
+
+void FrustumCuller::process_tasks()
+{
+    uint32_t task;
+    while ((task = next_task.fetch_add(1, std::memory_order_relaxed)) < tasks.size()) {
+        auto& output = task_outputs[task];
+        output.clear();
+        traverse(*job_frustum, tasks[task], output);
+    }
+}
+
+void run_frustum_culling_benchmark(size_t object_count, uint32_t worker_count)
+{
+    using clock = std::chrono::high_resolution_clock;
+
+    std::mt19937                          rng{42};
+    std::uniform_real_distribution<float> position{-1000.0f, 1000.0f};
+    std::uniform_real_distribution<float> size{0.5f, 4.0f};
+
+    std::vector<BoundingSphere> spheres(object_count);
+    for (auto& sphere: spheres) {
+        sphere = {position(rng), position(rng), position(rng), size(rng)};
+    }
+
+    // 位于原点、朝 -z 看的 60° 透视视锥，远平面 1000
+    const float f = 1.0f / std::tan(0.5f * 1.0471976f), n = 0.1f, far = 1000.0f;
+    const float clip[16] = {f, 0, 0, 0,
+                            0, f, 0, 0,
+                            0, 0, far / (n - far), -1,
+                            0, 0, far * n / (n - far), 0};
+    Frustum frustum = Frustum::from_matrix(clip);
+
+    FrustumCuller culler{worker_count};
+
+    auto t0 = clock::now();
+    culler.build(spheres);
+    auto build_ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+
+    std::vector<uint32_t> visible;
+    visible.reserve(object_count);
+
+    constexpr int ITERATIONS = 10;
+
+    auto measure = [&](const char* name, auto&& fn) {
+        fn();        // 预热
+        auto start = clock::now();
+        for (int i = 0; i < ITERATIONS; ++i) {
+            fn();
+        }
+        double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count() / ITERATIONS;
+        std::printf("  %-22s %10.3f ms  %7.3f ns/object  (%zu visible)\n",
+                    name, ns * 1e-6, ns / static_cast<double>(object_count), visible.size());
+    };
+
+    std::printf("Frustum culling benchmark: %zu objects, %zu BVH nodes, %s, %u threads, build %.1f ms\n",
+                object_count, culler.get_node_count(), FrustumCuller::get_simd_name(), culler.get_thread_count(),
+                build_ms);
+
+    measure("scalar flat", [&] {
+        visible.clear();
+        for (uint32_t i = 0; i < spheres.size(); ++i) {
+            bool inside = true;
+            for (int p = 0; p < 6 && inside; ++p) {
+                const float* plane = frustum.planes[p];
+                inside = plane[0] * spheres[i].x + plane[1] * spheres[i].y + plane[2] * spheres[i].z + plane[3]
+                         > -spheres[i].radius;
+            }
+            if (inside) {
+                visible.push_back(i);
+            }
+        }
+    });
+    measure("simd flat", [&] { culler.cull_flat(frustum, visible); });
+    measure("simd bvh", [&] { culler.cull_single_threaded(frustum, visible); });
+    measure("simd bvh threaded", [&] { culler.cull(frustum, visible); });
+
+    // 每帧移动 10% 的对象后 refit
+    std::uniform_int_distribution<uint32_t> pick{0, static_cast<uint32_t>(object_count - 1)};
+    std::uniform_real_distribution<float>   jitter{-1.0f, 1.0f};
+    const size_t moved = object_count / 10;
+
+    double refit_ns = 0.0;
+    for (int i = 0; i < ITERATIONS; ++i) {
+        for (size_t j = 0; j < moved; ++j) {
+            uint32_t id = pick(rng);
+            auto&    s  = spheres[id];
+            s.x += jitter(rng);
+            s.y += jitter(rng);
+            s.z += jitter(rng);
+            culler.update(id, s);
+        }
+        auto start = clock::now();
+        culler.refit();
+        refit_ns += std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    }
+    std::printf("  %-22s %10.3f ms  (%zu moved objects)\n", "refit", refit_ns / ITERATIONS * 1e-6, moved);
+}
@@ -0,0 +1,162 @@
+﻿/**
+ * @File FrustumCuller.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 基于扁平 BVH 的多线程 SIMD 视锥剔除（CPU）
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct BoundingSphere
+{
+    float x{0.0f};
+    float y{0.0f};
+    float z{0.0f};
+    float radius{0.0f};
+};
+
+/**
+ * @brief 六个归一化的平面，法线指向视锥内部：dot(n, p) + d >= 0 表示在内侧
+ */
+struct Frustum
+{
+    float planes[6][4]{};
+
+    /**
+     * @brief 从列主序的裁剪矩阵（proj * view）提取平面
+     * @param zero_to_one 深度范围是否为 [0, 1]（Vulkan），否则为 [-1, 1]
+     */
+    static Frustum from_matrix(const float* column_major, bool zero_to_one = true);
+};
+
+/**
+ * @brief CPU 视锥剔除
+ *
+ * - 包围球以 SoA 布局存放，叶子内的球按 SSE / AVX / NEON 宽度批量与平面比较；
+ *   x86 上默认使用 SSE2，AVX 需开启 CMake 选项 VK_ENABLE_AVX
+ * - BVH 以深度优先顺序扁平存放（左孩子紧随父节点），每个节点覆盖连续的对象区间，
+ *   遍历时记录仍需测试的平面，整棵子树完全在视锥内时直接输出整段区间
+ * - 对象移动后只标记所在叶子及其祖先，refit() 逆序刷新被标记的节点包围盒
+ * - 剔除按子树拆分为任务，由常驻工作线程与调用线程共同完成，结果按任务顺序拼接为紧凑的可见列表
+ */
+class FrustumCuller
+{
+public:
+    static constexpr uint32_t LEAF_SIZE = 32;
+
+    /**
+     * @param worker_count 额外的工作线程数，0 表示 hardware_concurrency - 1
+     */
+    explicit FrustumCuller(uint32_t worker_count = 0);
+
+    ~FrustumCuller();
+
+    FrustumCuller(const FrustumCuller&) = delete;
+    FrustumCuller(FrustumCuller&&) = delete;
+
+    FrustumCuller& operator=(const FrustumCuller&) = delete;
+    FrustumCuller& operator=(FrustumCuller&&) = delete;
+
+    /**
+     * @brief 重新构建 BVH，对象 id 为其在 spheres 中的下标
+     */
+    void build(const std::vector<BoundingSphere>& spheres);
+
+    /**
+     * @brief 更新对象的包围球，需要调用 refit() 后才会反映到 BVH 节点上
+     */
+    void update(uint32_t object, const BoundingSphere& sphere);
+
+    void refit();
+
+    /**
+     * @brief 多线程 BVH 剔除，visible 被替换为可见对象 id
+     */
+    void cull(const Frustum& frustum, std::vector<uint32_t>& visible);
+
+    /**
+     * @brief 单线程 BVH 剔除
+     */
+    void cull_single_threaded(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+
+    /**
+     * @brief 不使用 BVH，直接对所有对象做 SIMD 测试
+     */
+    void cull_flat(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+
+    size_t get_object_count() const;
+
+    size_t get_node_count() const;
+
+    uint32_t get_thread_count() const;
+
+    /**
+     * @brief 当前编译使用的指令集
+     */
+    static const char* get_simd_name();
+
+private:
+    struct Node
+    {
+        float    min[3];
+        float    max[3];
+        uint32_t object_begin;
+        uint32_t object_end;
+        uint32_t right;         // 0 表示叶子（根节点不会是右孩子）
+        uint32_t parent;
+    };
+
+    uint32_t build_recursive(uint32_t begin, uint32_t end, uint32_t parent, std::vector<float>& centroids);
+
+    void compute_bounds(Node& node) const;
+
+    void traverse(const Frustum& frustum, uint32_t root, std::vector<uint32_t>& out) const;
+
+    void test_range(const Frustum& frustum, uint32_t plane_mask, uint32_t begin, uint32_t end,
+                    std::vector<uint32_t>& out) const;
+
+    void build_tasks();
+
+    void worker_loop();
+
+    void process_tasks();
+
+    // SoA 包围球，按 BVH 叶子顺序排列
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> radius;
+
+    std::vector<uint32_t> slot_to_object;
+    std::vector<uint32_t> object_to_slot;
+    std::vector<uint32_t> slot_to_leaf;
+
+    std::vector<Node>    nodes;
+    std::vector<uint8_t> dirty;
+    bool                 any_dirty{false};
+
+    std::vector<uint32_t>              tasks;
+    std::vector<std::vector<uint32_t>> task_outputs;
+
+    std::vector<std::thread> workers;
+    std::mutex               job_mutex;
+    std::condition_variable  job_start;
+    std::condition_variable  job_done;
+    uint64_t                 job_generation{0};
+    uint32_t                 job_pending{0};
+    bool                     stopping{false};
+    const Frustum*           job_frustum{nullptr};
+    std::atomic<uint32_t>    next_task{0};
+};
+
+/**
+ * @brief 剔除基准：对随机分布的对象比较标量 / SIMD / BVH / 多线程 BVH 的 ns/object 以及 refit 开销
+ */
+void run_frustum_culling_benchmark(size_t object_count = 1000000, uint32_t worker_count = 0);
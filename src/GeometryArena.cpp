@@ -0,0 +1,278 @@
+﻿/**
+ * @File GeometryArena.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "GeometryArena.hpp"
+#include "Device.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+uint32_t get_index_size(vk::IndexType index_type)
+{
+    switch (index_type) {
+        case vk::IndexType::eUint16:
+            return 2;
+        case vk::IndexType::eUint32:
+            return 4;
+        default:
+            throw std::runtime_error("不支持的索引类型");
+    }
+}
+
+VmaVirtualBlock create_virtual_block(vk::DeviceSize element_count)
+{
+    VmaVirtualBlockCreateInfo create_info{};
+    create_info.size = element_count;
+
+    VmaVirtualBlock block{VK_NULL_HANDLE};
+    auto result = vmaCreateVirtualBlock(&create_info, &block);
+    if (result != VK_SUCCESS) {
+        throw VulkanException{vk::Result(result), "创建虚拟块失败"};
+    }
+    return block;
+}
+}        // namespace
+
+vk_geometry_arena::vk_geometry_arena(vk_device& device,
+                                     uint32_t vertex_stride,
+                                     vk::DeviceSize vertex_page_size,
+                                     vk::DeviceSize index_page_size,
+                                     vk::IndexType index_type) :
+    device{device},
+    vertex_stride{vertex_stride},
+    index_size{get_index_size(index_type)},
+    index_type{index_type},
+    vertex_page_size{vertex_page_size},
+    index_page_size{index_page_size}
+{
+    assert(vertex_stride > 0);
+}
+
+vk_geometry_arena::~vk_geometry_arena()
+{
+    for (auto& page: pages) {
+        // 未释放的区间随页一起回收
+        vmaClearVirtualBlock(page.vertex_block);
+        vmaClearVirtualBlock(page.index_block);
+        vmaDestroyVirtualBlock(page.vertex_block);
+        vmaDestroyVirtualBlock(page.index_block);
+    }
+}
+
+GeometryRange vk_geometry_arena::allocate(const void* vertex_data, uint32_t vertex_count,
+                                          const void* index_data, uint32_t index_count)
+{
+    PROFILE_SCOPE("vk_geometry_arena::allocate");
+
+    assert(vertex_count > 0 && index_count > 0);
+
+    GeometryRange range;
+
+    bool allocated = false;
+    for (uint32_t i = 0; i < pages.size() && !allocated; ++i) {
+        allocated = try_allocate(i, vertex_count, index_count, range);
+    }
+
+    if (!allocated) {
+        create_page(vk::DeviceSize{vertex_count} * vertex_stride, vk::DeviceSize{index_count} * index_size);
+        allocated = try_allocate(static_cast<uint32_t>(pages.size() - 1), vertex_count, index_count, range);
+        assert(allocated && "新页应当能容纳该网格");
+    }
+
+    stage(range.page, false, vertex_data, vk::DeviceSize(range.vertex_offset) * vertex_stride,
+          vk::DeviceSize{vertex_count} * vertex_stride);
+    stage(range.page, true, index_data, vk::DeviceSize{range.first_index} * index_size,
+          vk::DeviceSize{index_count} * index_size);
+
+    return range;
+}
+
+void vk_geometry_arena::free(GeometryRange& range)
+{
+    if (!range.valid()) {
+        return;
+    }
+
+    assert(range.page < pages.size());
+    auto& page = pages[range.page];
+
+    vmaVirtualFree(page.vertex_block, range.vertex_allocation);
+    vmaVirtualFree(page.index_block, range.index_allocation);
+    --page.mesh_count;
+
+    range = {};
+}
+
+void vk_geometry_arena::flush()
+{
+    if (pending_copies.empty()) {
+        return;
+    }
+
+    PROFILE_SCOPE("vk_geometry_arena::flush");
+
+    vk_buffer staging{device, staging_data.size(), vk::BufferUsageFlagBits::eTransferSrc,
+                      VMA_MEMORY_USAGE_CPU_ONLY, 0, {}, MemoryCategory::Staging};
+    staging.update(staging_data.data(), staging_data.size());
+
+    auto cmd = device.beginSingleTimeCommands();
+    for (auto& copy: pending_copies) {
+        auto& page = pages[copy.page];
+        auto& dst  = copy.index ? *page.index_buffer : *page.vertex_buffer;
+
+        vk::BufferCopy region(copy.src_offset, copy.dst_offset, copy.size);
+        cmd.copyBuffer(staging.handle(), dst.handle(), region);
+    }
+    device.endSingleTimeCommands(cmd);
+
+    std::vector<uint8_t>().swap(staging_data);
+    pending_copies.clear();
+}
+
+void vk_geometry_arena::bind(VkCommandBuffer command_buffer, uint32_t page, uint32_t first_binding) const
+{
+    assert(page < pages.size());
+
+    VkBuffer     vertex_buffer = pages[page].vertex_buffer->handle();
+    VkDeviceSize offset        = 0;
+    vkCmdBindVertexBuffers(command_buffer, first_binding, 1, &vertex_buffer, &offset);
+    vkCmdBindIndexBuffer(command_buffer, pages[page].index_buffer->handle(), 0, static_cast<VkIndexType>(index_type));
+}
+
+void vk_geometry_arena::draw(VkCommandBuffer command_buffer, const GeometryRange& range,
+                             uint32_t instance_count, uint32_t first_instance) const
+{
+    vkCmdDrawIndexed(command_buffer, range.index_count, instance_count, range.first_index, range.vertex_offset,
+                     first_instance);
+}
+
+uint32_t vk_geometry_arena::get_page_count() const
+{
+    return static_cast<uint32_t>(pages.size());
+}
+
+vk_buffer& vk_geometry_arena::get_vertex_buffer(uint32_t page) const
+{
+    assert(page < pages.size());
+    return *pages[page].vertex_buffer;
+}
+
+vk_buffer& vk_geometry_arena::get_index_buffer(uint32_t page) const
+{
+    assert(page < pages.size());
+    return *pages[page].index_buffer;
+}
+
+uint32_t vk_geometry_arena::get_vertex_stride() const
+{
+    return vertex_stride;
+}
+
+vk::IndexType vk_geometry_arena::get_index_type() const
+{
+    return index_type;
+}
+
+GeometryArenaStats vk_geometry_arena::get_stats() const
+{
+    GeometryArenaStats stats;
+    stats.page_count = static_cast<uint32_t>(pages.size());
+
+    for (auto& page: pages) {
+        VmaStatistics vertex_stats{}, index_stats{};
+        vmaGetVirtualBlockStatistics(page.vertex_block, &vertex_stats);
+        vmaGetVirtualBlockStatistics(page.index_block, &index_stats);
+
+        stats.mesh_count += page.mesh_count;
+        stats.vertex_bytes_used += vertex_stats.allocationBytes * vertex_stride;
+        stats.vertex_bytes_capacity += page.vertex_buffer->get_size();
+        stats.index_bytes_used += index_stats.allocationBytes * index_size;
+        stats.index_bytes_capacity += page.index_buffer->get_size();
+    }
+
+    return stats;
+}
+
+vk_geometry_arena::Page& vk_geometry_arena::create_page(vk::DeviceSize min_vertex_bytes, vk::DeviceSize min_index_bytes)
+{
+    // 页大小取整到元素大小，超大网格单独占用一页
+    vk::DeviceSize vertex_count = std::max(vertex_page_size, min_vertex_bytes) / vertex_stride;
+    vk::DeviceSize index_count  = std::max(index_page_size, min_index_bytes) / index_size;
+
+    Page page;
+    page.vertex_buffer = device.createBuffer(vertex_count * vertex_stride, nullptr,
+                                             vk::BufferUsageFlagBits::eVertexBuffer
+                                             | vk::BufferUsageFlagBits::eStorageBuffer
+                                             | vk::BufferUsageFlagBits::eTransferDst,
+                                             vk::MemoryPropertyFlagBits::eDeviceLocal, MemoryCategory::Mesh);
+    page.index_buffer  = device.createBuffer(index_count * index_size, nullptr,
+                                             vk::BufferUsageFlagBits::eIndexBuffer
+                                             | vk::BufferUsageFlagBits::eStorageBuffer
+                                             | vk::BufferUsageFlagBits::eTransferDst,
+                                             vk::MemoryPropertyFlagBits::eDeviceLocal, MemoryCategory::Mesh);
+
+    if (!page.vertex_buffer || !page.index_buffer) {
+        throw MemoryBudgetExceeded{"创建几何体页失败: 网格类别超出预算"};
+    }
+
+    page.vertex_block = create_virtual_block(vertex_count);
+    page.index_block  = create_virtual_block(index_count);
+
+    LOGI("几何体 arena 新增第 {} 页: {} 个顶点, {} 个索引", pages.size(), vertex_count, index_count);
+
+    pages.push_back(std::move(page));
+    return pages.back();
+}
+
+bool vk_geometry_arena::try_allocate(uint32_t page_index, uint32_t vertex_count, uint32_t index_count,
+                                     GeometryRange& range)
+{
+    auto& page = pages[page_index];
+
+    VmaVirtualAllocationCreateInfo vertex_info{};
+    vertex_info.size = vertex_count;
+
+    VmaVirtualAllocation vertex_allocation{VK_NULL_HANDLE};
+    VkDeviceSize         vertex_offset{0};
+    if (vmaVirtualAllocate(page.vertex_block, &vertex_info, &vertex_allocation, &vertex_offset) != VK_SUCCESS) {
+        return false;
+    }
+
+    VmaVirtualAllocationCreateInfo index_info{};
+    index_info.size = index_count;
+
+    VmaVirtualAllocation index_allocation{VK_NULL_HANDLE};
+    VkDeviceSize         index_offset{0};
+    if (vmaVirtualAllocate(page.index_block, &index_info, &index_allocation, &index_offset) != VK_SUCCESS) {
+        vmaVirtualFree(page.vertex_block, vertex_allocation);
+        return false;
+    }
+
+    ++page.mesh_count;
+
+    range.page              = page_index;
+    range.vertex_offset     = static_cast<int32_t>(vertex_offset);
+    range.vertex_count      = vertex_count;
+    range.first_index       = static_cast<uint32_t>(index_offset);
+    range.index_count       = index_count;
+    range.vertex_allocation = vertex_allocation;
+    range.index_allocation  = index_allocation;
+    return true;
+}
+
+void vk_geometry_arena::stage(uint32_t page, bool index, const void* data, vk::DeviceSize dst_offset,
+                              vk::DeviceSize size)
+{
+    // 暂存区内按 16 字节对齐，满足 vkCmdCopyBuffer 对任意元素大小的要求
+    vk::DeviceSize src_offset = (staging_data.size() + 15) & ~vk::DeviceSize{15};
+    staging_data.resize(src_offset + size);
+    std::memcpy(staging_data.data() + src_offset, data, size);
+
+    pending_copies.push_back({page, index, src_offset, dst_offset, size});
+}
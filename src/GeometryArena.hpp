@@ -0,0 +1,154 @@
+﻿/**
+ * @File GeometryArena.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 静态几何体的大顶点/索引缓冲区子分配器
+ */
+
+#pragma once
+
+#include "VkCommon.hpp"
+#include "Buffer.hpp"
+
+class vk_device;
+
+/**
+ * @brief 一个网格在几何体缓冲区中的位置，绘制时直接作为 firstIndex / vertexOffset 使用
+ */
+struct GeometryRange
+{
+    uint32_t page{0};
+
+    int32_t  vertex_offset{0};        // 以顶点为单位
+    uint32_t vertex_count{0};
+    uint32_t first_index{0};          // 以索引为单位
+    uint32_t index_count{0};
+
+    VmaVirtualAllocation vertex_allocation{VK_NULL_HANDLE};
+    VmaVirtualAllocation index_allocation{VK_NULL_HANDLE};
+
+    bool valid() const
+    {
+        return vertex_allocation != VK_NULL_HANDLE;
+    }
+};
+
+struct GeometryArenaStats
+{
+    uint32_t       page_count{0};
+    uint32_t       mesh_count{0};
+    vk::DeviceSize vertex_bytes_used{0};
+    vk::DeviceSize vertex_bytes_capacity{0};
+    vk::DeviceSize index_bytes_used{0};
+    vk::DeviceSize index_bytes_capacity{0};
+};
+
+/**
+ * @brief 几何体 arena：少量大的设备本地顶点/索引缓冲区，
+ *        以 VMA 虚拟块（TLSF）管理其中的区间，所有网格共用同一次绑定
+ *
+ * 虚拟块以元素（顶点/索引）为单位，因此分配偏移可以直接作为 vertexOffset / firstIndex。
+ * 一个网格的顶点与索引总在同一页中，页满后按需追加新页。
+ * 写入的数据先在 CPU 侧累积，flush() 时通过一次暂存缓冲区和一次提交上传。
+ */
+class vk_geometry_arena
+{
+public:
+    static constexpr vk::DeviceSize DEFAULT_VERTEX_PAGE_SIZE = 64 * 1024 * 1024;
+    static constexpr vk::DeviceSize DEFAULT_INDEX_PAGE_SIZE  = 32 * 1024 * 1024;
+
+    vk_geometry_arena(vk_device& device,
+                      uint32_t vertex_stride,
+                      vk::DeviceSize vertex_page_size = DEFAULT_VERTEX_PAGE_SIZE,
+                      vk::DeviceSize index_page_size = DEFAULT_INDEX_PAGE_SIZE,
+                      vk::IndexType index_type = vk::IndexType::eUint32);
+
+    ~vk_geometry_arena();
+
+    vk_geometry_arena(const vk_geometry_arena&) = delete;
+    vk_geometry_arena(vk_geometry_arena&&) = delete;
+
+    vk_geometry_arena& operator=(const vk_geometry_arena&) = delete;
+    vk_geometry_arena& operator=(vk_geometry_arena&&) = delete;
+
+    /**
+     * @brief 分配并暂存一个网格的数据，返回的区间在 flush() 之后才能用于绘制
+     */
+    GeometryRange allocate(const void* vertex_data, uint32_t vertex_count,
+                           const void* index_data, uint32_t index_count);
+
+    template<typename TVertex, typename TIndex>
+    GeometryRange allocate(const std::vector<TVertex>& vertices, const std::vector<TIndex>& indices)
+    {
+        assert(sizeof(TVertex) == vertex_stride && "顶点大小与 arena 的步长不一致");
+        assert(sizeof(TIndex) == index_size && "索引类型与 arena 不一致");
+        return allocate(vertices.data(), static_cast<uint32_t>(vertices.size()),
+                        indices.data(), static_cast<uint32_t>(indices.size()));
+    }
+
+    /**
+     * @brief 释放网格区间，调用方需保证 GPU 已不再使用该区间
+     */
+    void free(GeometryRange& range);
+
+    /**
+     * @brief 上传所有暂存的数据
+     */
+    void flush();
+
+    /**
+     * @brief 绑定某一页的顶点与索引缓冲区
+     */
+    void bind(VkCommandBuffer command_buffer, uint32_t page = 0, uint32_t first_binding = 0) const;
+
+    void draw(VkCommandBuffer command_buffer, const GeometryRange& range,
+              uint32_t instance_count = 1, uint32_t first_instance = 0) const;
+
+    uint32_t get_page_count() const;
+
+    vk_buffer& get_vertex_buffer(uint32_t page = 0) const;
+    vk_buffer& get_index_buffer(uint32_t page = 0) const;
+
+    uint32_t get_vertex_stride() const;
+    vk::IndexType get_index_type() const;
+
+    GeometryArenaStats get_stats() const;
+
+private:
+    struct Page
+    {
+        std::unique_ptr<vk_buffer> vertex_buffer;
+        std::unique_ptr<vk_buffer> index_buffer;
+        VmaVirtualBlock            vertex_block{VK_NULL_HANDLE};
+        VmaVirtualBlock            index_block{VK_NULL_HANDLE};
+        uint32_t                   mesh_count{0};
+    };
+
+    struct PendingCopy
+    {
+        uint32_t       page;
+        bool           index;
+        vk::DeviceSize src_offset;
+        vk::DeviceSize dst_offset;
+        vk::DeviceSize size;
+    };
+
+    Page& create_page(vk::DeviceSize min_vertex_bytes, vk::DeviceSize min_index_bytes);
+
+    bool try_allocate(uint32_t page_index, uint32_t vertex_count, uint32_t index_count, GeometryRange& range);
+
+    void stage(uint32_t page, bool index, const void* data, vk::DeviceSize dst_offset, vk::DeviceSize size);
+
+    vk_device& device;
+
+    uint32_t       vertex_stride;
+    uint32_t       index_size;
+    vk::IndexType  index_type;
+    vk::DeviceSize vertex_page_size;
+    vk::DeviceSize index_page_size;
+
+    std::vector<Page> pages;
+
+    std::vector<uint8_t>     staging_data;
+    std::vector<PendingCopy> pending_copies;
+};
@@ -0,0 +1,367 @@
+﻿/**
+ * @File GpuCulling.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "GpuCulling.hpp"
+#include "Buffer.hpp"
+#include "DescriptorPool.hpp"
+#include "DescriptorSet.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+#include "PhysicalDevice.hpp"
+#include "Pipeline.hpp"
+#include "Profiler.hpp"
+#include "ShaderModule.hpp"
+
+namespace {
+const char* CULL_SHADER_SOURCE = R"(
+#version 450
+
+layout(local_size_x = 64) in;
+
+// 是否支持 vkCmdDrawIndexedIndirectCount，创建管线时特化
+layout(constant_id = 0) const uint COMPACT = 1u;
+
+struct Instance
+{
+    mat4  transform;
+    vec4  bounding_sphere;
+    uint  index_count;
+    uint  first_index;
+    int   vertex_offset;
+    uint  padding;
+};
+
+struct DrawCommand
+{
+    uint index_count;
+    uint instance_count;
+    uint first_index;
+    int  vertex_offset;
+    uint first_instance;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances
+{
+    Instance instances[];
+};
+
+layout(std430, set = 0, binding = 1) writeonly buffer DrawCommands
+{
+    DrawCommand draws[];
+};
+
+layout(std430, set = 0, binding = 2) buffer DrawCount
+{
+    uint draw_count;
+};
+
+layout(push_constant) uniform CullParams
+{
+    vec4 planes[6];
+    uint instance_count;
+} params;
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= params.instance_count) {
+        return;
+    }
+
+    Instance instance = instances[id];
+
+    vec3  center = (instance.transform * vec4(instance.bounding_sphere.xyz, 1.0)).xyz;
+    float scale  = max(max(length(instance.transform[0].xyz), length(instance.transform[1].xyz)),
+                       length(instance.transform[2].xyz));
+    float radius = instance.bounding_sphere.w * scale;
+
+    bool visible = true;
+    for (int i = 0; i < 6; ++i) {
+        visible = visible && (dot(params.planes[i].xyz, center) + params.planes[i].w > -radius);
+    }
+
+    DrawCommand draw;
+    draw.index_count    = instance.index_count;
+    draw.instance_count = 1u;
+    draw.first_index    = instance.first_index;
+    draw.vertex_offset  = instance.vertex_offset;
+    draw.first_instance = id;
+
+    if (COMPACT != 0u) {
+        if (visible) {
+            draws[atomicAdd(draw_count, 1u)] = draw;
+        }
+    } else {
+        draw.instance_count = visible ? 1u : 0u;
+        draws[id] = draw;
+    }
+}
+)";
+
+struct CullParams
+{
+    glm::vec4 planes[6];
+    uint32_t  instance_count;
+};
+
+constexpr uint32_t COMPACT_CONSTANT_ID = 0;
+
+/**
+ * @brief 从裁剪矩阵中提取归一化的视锥平面（Gribb-Hartmann）
+ *        近平面取 z >= -w，对 [0, 1] 与 [-1, 1] 两种深度范围都是保守的
+ */
+void extract_frustum_planes(const glm::mat4& m, glm::vec4 (& planes)[6])
+{
+    auto row = [&m](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+
+    planes[0] = row(3) + row(0);
+    planes[1] = row(3) - row(0);
+    planes[2] = row(3) + row(1);
+    planes[3] = row(3) - row(1);
+    planes[4] = row(3) + row(2);
+    planes[5] = row(3) - row(2);
+
+    for (auto& plane: planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+}        // namespace
+
+vk_gpu_culler::vk_gpu_culler(vk_device& device, uint32_t frames_in_flight) :
+    device{device},
+    frames(frames_in_flight)
+{
+    draw_indirect_count = device.is_enabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    multi_draw_indirect = device.get_gpu().get_requested_features().multiDrawIndirect;
+
+    if (!draw_indirect_count) {
+        LOGW("不支持 {}，GPU 剔除将输出未压缩的间接命令", VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    }
+
+    ShaderSource source;
+    source.set_source(CULL_SHADER_SOURCE);
+    shader_module = std::make_unique<ShaderModule>(device, VK_SHADER_STAGE_COMPUTE_BIT, source, "main",
+                                                   ShaderVariant{});
+
+    // 描述符集布局与推送常量范围都来自着色器反射
+    pipeline_layout = &device.request_pipeline_layout({shader_module.get()});
+    descriptor_pool = std::make_unique<vk_descriptor_pool>(device, pipeline_layout->get_descriptor_set_layout(0));
+
+    // 是否压缩输出由特化常量决定，同一份 SPIR-V 生成两种管线变体
+    SpecializationConstantState specialization_constants;
+    specialization_constants.set_constant(COMPACT_CONSTANT_ID, draw_indirect_count ? 1u : 0u);
+
+    pipeline = &device.request_compute_pipeline(*shader_module, *pipeline_layout, specialization_constants);
+}
+
+vk_gpu_culler::~vk_gpu_culler()
+{
+    // 描述符集由池管理，先于池释放
+    frames.clear();
+}
+
+void vk_gpu_culler::set_queue_families(uint32_t compute_family, uint32_t graphics_family)
+{
+    this->compute_family  = compute_family;
+    this->graphics_family = graphics_family;
+}
+
+void vk_gpu_culler::set_instances(const std::vector<GpuCullInstance>& instances)
+{
+    instance_count = static_cast<uint32_t>(instances.size());
+    if (instance_count == 0) {
+        instance_buffer.reset();
+        return;
+    }
+
+    // 实例数据只在上传时写入一次，两个队列族并发读取比每帧转移所有权更简单
+    std::vector<uint32_t> sharing_families;
+    if (compute_family != graphics_family) {
+        sharing_families = {compute_family, graphics_family};
+    }
+
+    instance_buffer = device.createBuffer(instances, vk::BufferUsageFlagBits::eStorageBuffer,
+                                          vk::MemoryPropertyFlagBits::eDeviceLocal, MemoryCategory::Mesh,
+                                          sharing_families);
+    if (!instance_buffer) {
+        throw MemoryBudgetExceeded{"上传剔除实例数据失败: 网格类别超出预算"};
+    }
+
+    vk::DeviceSize draw_size = vk::DeviceSize{instance_count} * sizeof(VkDrawIndexedIndirectCommand);
+
+    for (auto& frame: frames) {
+        if (!frame.draw_buffer || frame.draw_buffer->get_size() < draw_size) {
+            frame.draw_buffer = device.createBuffer(draw_size, nullptr,
+                                                    vk::BufferUsageFlagBits::eStorageBuffer
+                                                    | vk::BufferUsageFlagBits::eIndirectBuffer);
+        }
+        if (!frame.count_buffer) {
+            frame.count_buffer = device.createBuffer(sizeof(uint32_t), nullptr,
+                                                     vk::BufferUsageFlagBits::eStorageBuffer
+                                                     | vk::BufferUsageFlagBits::eIndirectBuffer
+                                                     | vk::BufferUsageFlagBits::eTransferDst);
+        }
+        if (!frame.draw_buffer || !frame.count_buffer) {
+            throw MemoryBudgetExceeded{"创建间接绘制缓冲区失败: 超出预算"};
+        }
+    }
+
+    update_descriptor_sets();
+}
+
+void vk_gpu_culler::record_cull(VkCommandBuffer command_buffer, uint32_t frame_index, const glm::mat4& view_proj,
+                                bool release_to_graphics)
+{
+    if (instance_count == 0) {
+        return;
+    }
+
+    PROFILE_SCOPE("vk_gpu_culler::record_cull");
+
+    assert(frame_index < frames.size());
+    auto& frame = frames[frame_index];
+
+    vkCmdFillBuffer(command_buffer, frame.count_buffer->handle(), 0, sizeof(uint32_t), 0);
+
+    VkMemoryBarrier clear_barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    clear_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clear_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         1, &clear_barrier, 0, nullptr, 0, nullptr);
+
+    CullParams params{};
+    extract_frustum_planes(view_proj, params.planes);
+    params.instance_count = instance_count;
+
+    VkDescriptorSet descriptor_set = frame.descriptor_set->get_handle();
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->handle());
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout->handle(), 0, 1,
+                            &descriptor_set, 0, nullptr);
+    vkCmdPushConstants(command_buffer, pipeline_layout->handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params),
+                       &params);
+    vkCmdDispatch(command_buffer, (instance_count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    if (release_to_graphics) {
+        // 同一队列族的不同队列之间无需转移所有权，信号量已包含完整的内存依赖
+        if (compute_family == graphics_family) {
+            return;
+        }
+
+        // 下一帧计算着色器会完整重写输出，因此不需要反向（图形 -> 计算）的转移
+        std::array<VkBufferMemoryBarrier, 2> release_barriers{};
+        VkBuffer                             buffers[] = {frame.draw_buffer->handle(), frame.count_buffer->handle()};
+        for (size_t i = 0; i < release_barriers.size(); ++i) {
+            auto& barrier               = release_barriers[i];
+            barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcAccessMask       = VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask       = 0;
+            barrier.srcQueueFamilyIndex = compute_family;
+            barrier.dstQueueFamilyIndex = graphics_family;
+            barrier.buffer              = buffers[i];
+            barrier.offset              = 0;
+            barrier.size                = VK_WHOLE_SIZE;
+        }
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr,
+                             static_cast<uint32_t>(release_barriers.size()), release_barriers.data(), 0, nullptr);
+        return;
+    }
+
+    VkMemoryBarrier draw_barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    draw_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    draw_barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0,
+                         1, &draw_barrier, 0, nullptr, 0, nullptr);
+}
+
+void vk_gpu_culler::record_acquire(VkCommandBuffer command_buffer, uint32_t frame_index) const
+{
+    if (instance_count == 0 || compute_family == graphics_family) {
+        return;
+    }
+
+    assert(frame_index < frames.size());
+    auto& frame = frames[frame_index];
+
+    // 与 record_cull 中的释放屏障成对，队列族与缓冲区范围必须一致
+    std::array<VkBufferMemoryBarrier, 2> acquire_barriers{};
+    VkBuffer                             buffers[] = {frame.draw_buffer->handle(), frame.count_buffer->handle()};
+    for (size_t i = 0; i < acquire_barriers.size(); ++i) {
+        auto& barrier               = acquire_barriers[i];
+        barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask       = 0;
+        barrier.dstAccessMask       = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        barrier.srcQueueFamilyIndex = compute_family;
+        barrier.dstQueueFamilyIndex = graphics_family;
+        barrier.buffer              = buffers[i];
+        barrier.offset              = 0;
+        barrier.size                = VK_WHOLE_SIZE;
+    }
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0,
+                         0, nullptr, static_cast<uint32_t>(acquire_barriers.size()), acquire_barriers.data(), 0,
+                         nullptr);
+}
+
+void vk_gpu_culler::record_draw(VkCommandBuffer command_buffer, uint32_t frame_index) const
+{
+    if (instance_count == 0) {
+        return;
+    }
+
+    assert(frame_index < frames.size());
+    auto& frame  = frames[frame_index];
+    auto  stride = static_cast<uint32_t>(sizeof(VkDrawIndexedIndirectCommand));
+
+    if (draw_indirect_count) {
+        vkCmdDrawIndexedIndirectCountKHR(command_buffer, frame.draw_buffer->handle(), 0,
+                                         frame.count_buffer->handle(), 0, instance_count, stride);
+    } else if (multi_draw_indirect) {
+        vkCmdDrawIndexedIndirect(command_buffer, frame.draw_buffer->handle(), 0, instance_count, stride);
+    } else {
+        for (uint32_t i = 0; i < instance_count; ++i) {
+            vkCmdDrawIndexedIndirect(command_buffer, frame.draw_buffer->handle(), i * stride, 1, stride);
+        }
+    }
+}
+
+void vk_gpu_culler::update_descriptor_sets()
+{
+    if (!instance_buffer) {
+        return;
+    }
+
+    for (auto& frame: frames) {
+        BindingMap<VkDescriptorBufferInfo> buffer_infos;
+        buffer_infos[0][0] = {instance_buffer->handle(), 0, VK_WHOLE_SIZE};
+        buffer_infos[1][0] = {frame.draw_buffer->handle(), 0, VK_WHOLE_SIZE};
+        buffer_infos[2][0] = {frame.count_buffer->handle(), 0, VK_WHOLE_SIZE};
+
+        if (!frame.descriptor_set) {
+            frame.descriptor_set = std::make_unique<vk_descriptor_set>(
+                device, pipeline_layout->get_descriptor_set_layout(0), *descriptor_pool, buffer_infos);
+        } else {
+            frame.descriptor_set->reset(buffer_infos);
+        }
+        frame.descriptor_set->update();
+    }
+}
+
+uint32_t vk_gpu_culler::get_instance_count() const
+{
+    return instance_count;
+}
+
+bool vk_gpu_culler::is_compacting() const
+{
+    return draw_indirect_count;
+}
+
+vk_buffer* vk_gpu_culler::get_instance_buffer() const
+{
+    return instance_buffer.get();
+}
@@ -0,0 +1,128 @@
+﻿/**
+ * @File GpuCulling.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 计算着色器视锥剔除并生成间接绘制命令
+ */
+
+#pragma once
+
+#include "VkCommon.hpp"
+
+#include <glm/glm.hpp>
+
+class vk_device;
+class vk_buffer;
+class vk_pipeline_layout;
+class vk_descriptor_pool;
+class vk_descriptor_set;
+class vk_compute_pipeline;
+class ShaderModule;
+
+/**
+ * @brief 单个实例的剔除输入，与计算着色器中的 Instance 结构一致（std430）
+ */
+struct GpuCullInstance
+{
+    glm::mat4 transform{1.0f};
+    glm::vec4 bounding_sphere{0.0f};        // 模型空间的包围球，xyz 为球心，w 为半径
+    uint32_t  index_count{0};
+    uint32_t  first_index{0};
+    int32_t   vertex_offset{0};
+    uint32_t  padding{0};
+};
+
+/**
+ * @brief GPU 驱动的间接绘制：实例数据常驻于存储缓冲区，
+ *        每帧由计算着色器做视锥剔除并把可见实例压缩为 VkDrawIndexedIndirectCommand，
+ *        最后用一次 vkCmdDrawIndexedIndirectCount 绘制，CPU 开销与实例数量无关
+ *
+ * 输出命令的 firstInstance 为实例下标，顶点着色器可以通过 gl_InstanceIndex 读取实例变换。
+ * 设备不支持 VK_KHR_draw_indirect_count 时改为不压缩：剔除的实例写入 instanceCount = 0 的命令。
+ */
+class vk_gpu_culler
+{
+public:
+    static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+    vk_gpu_culler(vk_device& device, uint32_t frames_in_flight);
+
+    ~vk_gpu_culler();
+
+    vk_gpu_culler(const vk_gpu_culler&) = delete;
+    vk_gpu_culler(vk_gpu_culler&&) = delete;
+
+    vk_gpu_culler& operator=(const vk_gpu_culler&) = delete;
+    vk_gpu_culler& operator=(vk_gpu_culler&&) = delete;
+
+    /**
+     * @brief 设置剔除与绘制所在的队列族，需在 set_instances 之前调用。
+     *        两者不同时实例缓冲区以并发模式共享，每帧输出则在两个队列族之间转移所有权
+     */
+    void set_queue_families(uint32_t compute_family, uint32_t graphics_family);
+
+    /**
+     * @brief 上传实例数据并按需重建每帧的命令缓冲区，调用方需保证 GPU 已不再使用旧数据
+     */
+    void set_instances(const std::vector<GpuCullInstance>& instances);
+
+    /**
+     * @brief 记录剔除（必须在渲染通道之外），view_proj 用于提取视锥平面
+     * @param release_to_graphics 在异步计算队列上记录时为 true：结尾改为把输出释放给图形队列族，
+     *                            可见性由跨队列的信号量保证
+     */
+    void record_cull(VkCommandBuffer command_buffer, uint32_t frame_index, const glm::mat4& view_proj,
+                     bool release_to_graphics = false);
+
+    /**
+     * @brief 在图形队列上获取异步剔除释放的输出，需在渲染通道之外、间接绘制之前记录
+     */
+    void record_acquire(VkCommandBuffer command_buffer, uint32_t frame_index) const;
+
+    /**
+     * @brief 记录间接绘制，调用前需绑定好图形管线与几何体缓冲区
+     */
+    void record_draw(VkCommandBuffer command_buffer, uint32_t frame_index) const;
+
+    /**
+     * @brief 缓冲区句柄改变（如碎片整理）后重写描述符集
+     */
+    void update_descriptor_sets();
+
+    uint32_t get_instance_count() const;
+
+    bool is_compacting() const;
+
+    vk_buffer* get_instance_buffer() const;
+
+private:
+    struct FrameResources
+    {
+        std::unique_ptr<vk_buffer>         draw_buffer;
+        std::unique_ptr<vk_buffer>         count_buffer;
+        std::unique_ptr<vk_descriptor_set> descriptor_set;
+    };
+
+    vk_device& device;
+
+    bool draw_indirect_count{false};
+
+    bool multi_draw_indirect{false};
+
+    std::unique_ptr<ShaderModule>             shader_module;
+    vk_pipeline_layout*                       pipeline_layout{nullptr};        // 由设备的布局缓存持有
+    std::unique_ptr<vk_descriptor_pool>       descriptor_pool;
+
+    // 由设备的管线缓存持有
+    vk_compute_pipeline* pipeline{nullptr};
+
+    std::unique_ptr<vk_buffer> instance_buffer;
+
+    uint32_t instance_count{0};
+
+    uint32_t compute_family{VK_QUEUE_FAMILY_IGNORED};
+
+    uint32_t graphics_family{VK_QUEUE_FAMILY_IGNORED};
+
+    std::vector<FrameResources> frames;
+};
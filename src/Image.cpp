@@ -8,6 +8,7 @@
 #include "Image.hpp"
 #include "Debug.hpp"
 #include "Device.hpp"
+#include "Helpers.hpp"
 #include "ImageView.hpp"
 
 namespace {
@@ -39,7 +40,8 @@ vk_image::vk_image(vk_device& device,
                    vk::ImageTiling tiling,
                    vk::ImageCreateFlags flags,
                    uint32_t num_queue_families,
-                   const uint32_t* queue_families) :
+                   const uint32_t* queue_families,
+                   MemoryCategory category) :
     vk_unit{nullptr, &device},
     type{find_image_type(extent)},
     extent{extent},
@@ -47,7 +49,10 @@ vk_image::vk_image(vk_device& device,
     sample_count{sample_count},
     usage{image_usage},
     array_layer_count{array_layers},
-    tiling{tiling}
+    tiling{tiling},
+    category{category},
+    create_flags{flags},
+    concurrent{num_queue_families != 0}
 {
     assert(0 < mip_levels && "图像至少有一个 mip 等级");
     assert(0 < array_layers && "图像至少有一个层级");
@@ -64,23 +69,60 @@ vk_image::vk_image(vk_device& device,
         image_info.pQueueFamilyIndices   = queue_families;
     }
 
+    auto& telemetry = device.get_memory_telemetry();
+    auto  allocator = device.get_memory_allocator();
+
+    // 先创建图像再分配内存，预算检查与回收使用驱动给出的真实大小（含格式、mip 链与对齐）
+    VkImage image_handle{VK_NULL_HANDLE};
+    auto    result = vkCreateImage(device.handle(), reinterpret_cast<const VkImageCreateInfo*>(&image_info), nullptr,
+                                   &image_handle);
+    if (result != VK_SUCCESS) {
+        throw VulkanException{vk::Result(result), "创建图像失败"};
+    }
+
+    VkMemoryRequirements requirements{};
+    vkGetImageMemoryRequirements(device.handle(), image_handle, &requirements);
+
+    if (!telemetry.request(category, requirements.size)) {
+        vkDestroyImage(device.handle(), image_handle, nullptr);
+        throw MemoryBudgetExceeded{fmt::format("创建图像失败: 内存类别 {} 超出预算", to_string(category))};
+    }
+
     VmaAllocationCreateInfo memory_info{};
     memory_info.usage = memory_usage;
+    memory_info.flags = telemetry.get_allocation_flags(category);
 
     if (image_usage & vk::ImageUsageFlagBits::eTransientAttachment) {
         memory_info.preferredFlags = VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
     }
 
-    auto result = vmaCreateImage(device.get_memory_allocator(),
-                                 reinterpret_cast<const VkImageCreateInfo*>(&image_info),
-                                 &memory_info,
-                                 const_cast<VkImage*>(reinterpret_cast<const VkImage*>(&handle())),
-                                 &memory,
-                                 nullptr);
+    VmaAllocationInfo allocation_info{};
+
+    result = vmaAllocateMemoryForImage(allocator, image_handle, &memory_info, &memory, &allocation_info);
+
+    if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY && telemetry.evict(category, requirements.size)) {
+        result = vmaAllocateMemoryForImage(allocator, image_handle, &memory_info, &memory, &allocation_info);
+    }
+
+    if (result == VK_SUCCESS) {
+        result = vmaBindImageMemory(allocator, memory, image_handle);
+        if (result != VK_SUCCESS) {
+            vmaFreeMemory(allocator, memory);
+            memory = VK_NULL_HANDLE;
+        }
+    }
 
     if (result != VK_SUCCESS) {
+        vkDestroyImage(device.handle(), image_handle, nullptr);
         throw VulkanException{vk::Result(result), "创建图像失败"};
     }
+
+    set_handle(vk::Image{image_handle});
+
+    allocation_size = allocation_info.size;
+    telemetry.on_allocated(category, allocation_size);
+    vmaSetAllocationName(allocator, memory, to_string(category));
+    vmaSetAllocationUserData(allocator, memory, &owner);
 }
 
 vk_image::vk_image(vk_device& device,
@@ -106,10 +148,21 @@ vk_image::vk_image(vk_image&& other) noexcept :
     usage(std::exchange(other.usage, {})),
     tiling(std::exchange(other.tiling, {})),
     subresource(std::exchange(other.subresource, {})),
+    array_layer_count(std::exchange(other.array_layer_count, {})),
     views(std::exchange(other.views, {})),
+    cached_views(std::exchange(other.cached_views, {})),
     mapped_data(std::exchange(other.mapped_data, {})),
-    mapped(std::exchange(other.mapped, {}))
+    mapped(std::exchange(other.mapped, {})),
+    category(other.category),
+    allocation_size(std::exchange(other.allocation_size, {})),
+    create_flags(other.create_flags),
+    concurrent(other.concurrent),
+    steady_layout(other.steady_layout)
 {
+    if (memory != VK_NULL_HANDLE) {
+        vmaSetAllocationUserData(device().get_memory_allocator(), memory, &owner);
+    }
+
     // 更新所有引用这个图像的图像视图，防止空悬指针
     for (auto& view: views) {
         view->set_image(*this);
@@ -118,9 +171,16 @@ vk_image::vk_image(vk_image&& other) noexcept :
 
 vk_image::~vk_image()
 {
+    // 缓存的视图引用图像句柄，先于图像销毁
+    for (auto& [key, view]: cached_views) {
+        views.erase(view.get());
+    }
+    cached_views.clear();
+
     if (handle() && memory) {
         unmap();
         vmaDestroyImage(device().get_memory_allocator(), static_cast<VkImage>(handle()), memory);
+        device().get_memory_telemetry().on_freed(category, allocation_size);
     }
 }
 
@@ -129,6 +189,46 @@ VmaAllocation vk_image::get_memory() const
     return memory;
 }
 
+MemoryCategory vk_image::get_memory_category() const
+{
+    return category;
+}
+
+void vk_image::set_steady_layout(vk::ImageLayout layout)
+{
+    steady_layout = layout;
+}
+
+vk::ImageLayout vk_image::get_steady_layout() const
+{
+    return steady_layout;
+}
+
+bool vk_image::is_movable() const
+{
+    constexpr vk::ImageUsageFlags copy_usage = vk::ImageUsageFlagBits::eTransferSrc
+                                               | vk::ImageUsageFlagBits::eTransferDst;
+
+    return memory != VK_NULL_HANDLE && !concurrent && !mapped
+           && steady_layout != vk::ImageLayout::eUndefined
+           && (usage & copy_usage) == copy_usage
+           && tiling == vk::ImageTiling::eOptimal
+           && sample_count == vk::SampleCountFlagBits::e1
+           && category != MemoryCategory::RenderTarget;
+}
+
+vk::ImageCreateInfo vk_image::get_create_info() const
+{
+    return vk::ImageCreateInfo(create_flags, type, format, extent, subresource.mipLevel, subresource.arrayLayer,
+                               sample_count, tiling, usage);
+}
+
+void vk_image::replace_handle(vk::Image new_handle)
+{
+    device().handle().destroyImage(handle());
+    set_handle(new_handle);
+}
+
 uint8_t* vk_image::map()
 {
     if (!mapped_data) {
@@ -195,3 +295,40 @@ std::unordered_set<vk_image_view*>& vk_image::get_views()
 {
     return views;
 }
+
+vk_image_view& vk_image::request_view(vk::ImageViewType view_type,
+                                      vk::Format view_format,
+                                      uint32_t base_mip_level,
+                                      uint32_t base_array_layer,
+                                      uint32_t n_mip_levels,
+                                      uint32_t n_array_layers)
+{
+    // 与 vk_image_view 构造时相同的默认值规则，保证省略参数与显式给出完整范围的请求命中同一个视图
+    if (view_format == vk::Format::eUndefined) {
+        view_format = format;
+    }
+    if (n_mip_levels == 0) {
+        n_mip_levels = subresource.mipLevel;
+    }
+    if (n_array_layers == 0) {
+        n_array_layers = subresource.arrayLayer;
+    }
+
+    std::size_t key = 0;
+    hash_combine(key, static_cast<uint32_t>(view_type));
+    hash_combine(key, static_cast<uint32_t>(view_format));
+    hash_combine(key, base_mip_level);
+    hash_combine(key, base_array_layer);
+    hash_combine(key, n_mip_levels);
+    hash_combine(key, n_array_layers);
+
+    auto it = cached_views.find(key);
+    if (it != cached_views.end()) {
+        return *it->second;
+    }
+
+    auto view = std::make_unique<vk_image_view>(*this, view_type, view_format, base_mip_level, base_array_layer,
+                                                n_mip_levels, n_array_layers);
+
+    return *cached_views.emplace(key, std::move(view)).first->second;
+}
@@ -9,6 +9,8 @@
 
 #include "VkUnit.hpp"
 #include "VkCommon.hpp"
+#include "MemoryTelemetry.hpp"
+#include <memory>
 #include <unordered_set>
 
 class vk_image_view;
@@ -35,7 +37,8 @@ public:
              vk::ImageTiling         tiling             = vk::ImageTiling::eOptimal,
              vk::ImageCreateFlags    flags              = {},
              uint32_t                num_queue_families = 0,
-             const uint32_t         *queue_families     = nullptr);
+             const uint32_t         *queue_families     = nullptr,
+             MemoryCategory          category           = MemoryCategory::Other);
     // @formatter:on
 
     vk_image(vk_image&& other) noexcept;
@@ -49,6 +52,8 @@ public:
 
     VmaAllocation get_memory() const;
 
+    MemoryCategory get_memory_category() const;
+
     uint8_t* map();
 
     void unmap();
@@ -63,6 +68,33 @@ public:
     uint32_t get_array_layer_count() const;
     std::unordered_set<vk_image_view*>& get_views();
 
+    /**
+     * @brief 按 (视图类型, 格式, 子资源范围) 缓存的图像视图，相同的请求返回同一个句柄。
+     *        视图归图像所有，随图像一起销毁，同样登记在 get_views() 中以便碎片整理时重建
+     */
+    vk_image_view& request_view(vk::ImageViewType view_type,
+                                vk::Format format = vk::Format::eUndefined,
+                                uint32_t base_mip_level = 0,
+                                uint32_t base_array_layer = 0,
+                                uint32_t n_mip_levels = 0,
+                                uint32_t n_array_layers = 0);
+
+    /**
+     * @brief 图像在帧与帧之间保持的布局（例如纹理的 eShaderReadOnlyOptimal），
+     *        碎片整理据此拷贝内容；保持 eUndefined 表示该图像不可移动
+     */
+    void set_steady_layout(vk::ImageLayout layout);
+    vk::ImageLayout get_steady_layout() const;
+
+    bool is_movable() const;
+
+    vk::ImageCreateInfo get_create_info() const;
+
+    /**
+     * @brief 碎片整理时替换句柄，旧句柄会被销毁，需要随后重建所有图像视图
+     */
+    void replace_handle(vk::Image new_handle);
+
 private:
     VmaAllocation                      memory            = VK_NULL_HANDLE;
     vk::ImageType                      type;
@@ -74,6 +106,13 @@ private:
     vk::ImageSubresource               subresource;
     uint32_t                           array_layer_count = 0;
     std::unordered_set<vk_image_view*> views;                            /// HPPImage views referring to this image
+    std::unordered_map<std::size_t, std::unique_ptr<vk_image_view>> cached_views;
     uint8_t* mapped_data = nullptr;
     bool mapped = false;                                                /// Whether it was mapped with vmaMapMemory
+    MemoryCategory category = MemoryCategory::Other;
+    vk::DeviceSize allocation_size = 0;
+    vk::ImageCreateFlags create_flags;
+    bool concurrent = false;
+    vk::ImageLayout steady_layout = vk::ImageLayout::eUndefined;
+    AllocationOwner owner{AllocationOwner::Kind::Image, this};
 };
\ No newline at end of file
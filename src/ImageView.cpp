@@ -18,7 +18,7 @@ vk_image_view::vk_image_view(vk_image& img,
                              uint32_t array_layer,
                              uint32_t n_mip_levels,
                              uint32_t n_array_layers) :
-    vk_unit{nullptr, &img.device()}, image{&img}, format{format}
+    vk_unit{nullptr, &img.device()}, view_type{view_type}, image{&img}, format{format}
 {
     if (format == vk::Format::eUndefined) {
         this->format = format = image->get_format();
@@ -48,7 +48,8 @@ vk_image_view::vk_image_view(vk_image& img,
 }
 
 vk_image_view::vk_image_view(vk_image_view&& other) :
-    vk_unit{std::move(other)}, image{other.image}, format{other.format}, subresource_range{other.subresource_range}
+    vk_unit{std::move(other)}, view_type{other.view_type}, image{other.image}, format{other.format},
+    subresource_range{other.subresource_range}
 {
     // Remove old view from image set and add this new one
     auto& views = image->get_views();
@@ -90,4 +91,18 @@ vk::ImageSubresourceLayers vk_image_view::get_subresource_layers() const
 vk::ImageSubresourceRange vk_image_view::get_subresource_range() const
 {
     return subresource_range;
+}
+
+vk::ImageView vk_image_view::recreate()
+{
+    vk::ImageView old_handle = handle();
+
+    vk::ImageViewCreateInfo image_view_create_info({}, image->handle(), view_type, format, {}, subresource_range);
+    set_handle(device().handle().createImageView(image_view_create_info));
+
+    if (old_handle) {
+        device().handle().destroyImageView(old_handle);
+    }
+
+    return old_handle;
 }
\ No newline at end of file
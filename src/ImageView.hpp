@@ -37,7 +37,13 @@ public:
     vk::ImageSubresourceLayers get_subresource_layers() const;
     vk::ImageSubresourceRange get_subresource_range() const;
 
+    /**
+     * @brief 图像句柄被替换后（如碎片整理）重新创建视图，返回被销毁的旧句柄以便修正引用它的描述符
+     */
+    vk::ImageView recreate();
+
 private:
+    vk::ImageViewType view_type;
     vk_image* image = nullptr;
     vk::Format                format;
     vk::ImageSubresourceRange subresource_range;
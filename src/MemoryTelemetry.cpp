@@ -0,0 +1,239 @@
+﻿/**
+ * @File MemoryTelemetry.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "MemoryTelemetry.hpp"
+#include "Device.hpp"
+#include "PhysicalDevice.hpp"
+
+#include <fstream>
+
+const char* to_string(MemoryCategory category)
+{
+    switch (category) {
+        case MemoryCategory::Other:
+            return "other";
+        case MemoryCategory::Mesh:
+            return "mesh";
+        case MemoryCategory::Texture:
+            return "texture";
+        case MemoryCategory::FrameRing:
+            return "frame_ring";
+        case MemoryCategory::Staging:
+            return "staging";
+        case MemoryCategory::RenderTarget:
+            return "render_target";
+        default:
+            return "unknown";
+    }
+}
+
+vk_memory_telemetry::vk_memory_telemetry(vk_device& device, bool memory_budget_enabled) :
+    device{device},
+    memory_budget_enabled{memory_budget_enabled}
+{
+}
+
+void vk_memory_telemetry::set_category_budget(MemoryCategory category, vk::DeviceSize bytes)
+{
+    categories[static_cast<size_t>(category)].budget = bytes;
+}
+
+void vk_memory_telemetry::set_evict_callback(MemoryCategory category, EvictCallback callback)
+{
+    std::lock_guard<std::mutex> lock{evict_mutex};
+    evict_callbacks[static_cast<size_t>(category)] = std::move(callback);
+}
+
+bool vk_memory_telemetry::request(MemoryCategory category, vk::DeviceSize size)
+{
+    auto& state = categories[static_cast<size_t>(category)];
+
+    vk::DeviceSize budget = state.budget.load();
+    if (budget == 0 || state.bytes.load() + size <= budget) {
+        return true;
+    }
+
+    vk::DeviceSize needed = state.bytes.load() + size - budget;
+    evict(category, needed);
+
+    if (state.bytes.load() + size <= budget) {
+        return true;
+    }
+
+    LOGW("内存类别 {} 超出预算: 已用 {} + 请求 {} > 预算 {} 字节",
+         to_string(category), state.bytes.load(), size, budget);
+    return false;
+}
+
+bool vk_memory_telemetry::evict(MemoryCategory category, vk::DeviceSize size)
+{
+    EvictCallback callback;
+    {
+        std::lock_guard<std::mutex> lock{evict_mutex};
+        callback = evict_callbacks[static_cast<size_t>(category)];
+    }
+
+    if (!callback) {
+        return false;
+    }
+
+    // 回调内部会销毁资源，不能持有锁
+    vk::DeviceSize released = callback(category, size);
+    LOGI("内存类别 {} 回收了 {} 字节 (请求 {} 字节)", to_string(category), released, size);
+
+    return released > 0;
+}
+
+VmaAllocationCreateFlags vk_memory_telemetry::get_allocation_flags(MemoryCategory category) const
+{
+    if (!memory_budget_enabled) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock{evict_mutex};
+    return evict_callbacks[static_cast<size_t>(category)] ? VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT : 0;
+}
+
+void vk_memory_telemetry::on_allocated(MemoryCategory category, vk::DeviceSize size)
+{
+    auto& state = categories[static_cast<size_t>(category)];
+
+    vk::DeviceSize bytes = state.bytes.fetch_add(size) + size;
+    state.allocation_count.fetch_add(1);
+
+    vk::DeviceSize peak = state.peak_bytes.load();
+    while (bytes > peak && !state.peak_bytes.compare_exchange_weak(peak, bytes)) {}
+}
+
+void vk_memory_telemetry::on_freed(MemoryCategory category, vk::DeviceSize size)
+{
+    auto& state = categories[static_cast<size_t>(category)];
+
+    state.bytes.fetch_sub(size);
+    state.allocation_count.fetch_sub(1);
+}
+
+bool vk_memory_telemetry::is_memory_budget_enabled() const
+{
+    return memory_budget_enabled;
+}
+
+std::vector<MemoryHeapBudget> vk_memory_telemetry::get_heap_budgets() const
+{
+    const auto& memory_properties = device.get_gpu().memory_properties();
+
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+    vmaGetHeapBudgets(device.get_memory_allocator(), budgets.data());
+
+    std::vector<MemoryHeapBudget> result;
+    result.reserve(memory_properties.memoryHeapCount);
+
+    for (uint32_t i = 0; i < memory_properties.memoryHeapCount; ++i) {
+        MemoryHeapBudget heap;
+        heap.heap_index       = i;
+        heap.flags            = memory_properties.memoryHeaps[i].flags;
+        heap.heap_size        = memory_properties.memoryHeaps[i].size;
+        heap.usage            = budgets[i].usage;
+        heap.budget           = budgets[i].budget;
+        heap.block_bytes      = budgets[i].statistics.blockBytes;
+        heap.allocation_bytes = budgets[i].statistics.allocationBytes;
+        heap.block_count      = budgets[i].statistics.blockCount;
+        heap.allocation_count = budgets[i].statistics.allocationCount;
+        result.push_back(heap);
+    }
+
+    return result;
+}
+
+MemoryCategoryUsage vk_memory_telemetry::get_category_usage(MemoryCategory category) const
+{
+    const auto& state = categories[static_cast<size_t>(category)];
+
+    MemoryCategoryUsage usage;
+    usage.category         = category;
+    usage.bytes            = state.bytes.load();
+    usage.peak_bytes       = state.peak_bytes.load();
+    usage.budget           = state.budget.load();
+    usage.allocation_count = state.allocation_count.load();
+    return usage;
+}
+
+std::vector<MemoryCategoryUsage> vk_memory_telemetry::get_category_usages() const
+{
+    std::vector<MemoryCategoryUsage> result;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); ++i) {
+        result.push_back(get_category_usage(static_cast<MemoryCategory>(i)));
+    }
+    return result;
+}
+
+std::string vk_memory_telemetry::to_json(bool detailed_map) const
+{
+    std::string json = "{\n  \"heaps\": [\n";
+
+    auto heaps = get_heap_budgets();
+    for (size_t i = 0; i < heaps.size(); ++i) {
+        const auto& heap = heaps[i];
+        json += fmt::format("    {{\"index\": {}, \"device_local\": {}, \"size\": {}, \"usage\": {}, \"budget\": {}, "
+                            "\"block_bytes\": {}, \"allocation_bytes\": {}, \"blocks\": {}, \"allocations\": {}}}{}\n",
+                            heap.heap_index,
+                            (heap.flags & vk::MemoryHeapFlagBits::eDeviceLocal) ? "true" : "false",
+                            heap.heap_size, heap.usage, heap.budget, heap.block_bytes, heap.allocation_bytes,
+                            heap.block_count, heap.allocation_count, i + 1 < heaps.size() ? "," : "");
+    }
+
+    json += "  ],\n  \"categories\": {\n";
+
+    auto usages = get_category_usages();
+    for (size_t i = 0; i < usages.size(); ++i) {
+        const auto& usage = usages[i];
+        json += fmt::format("    \"{}\": {{\"bytes\": {}, \"peak_bytes\": {}, \"budget\": {}, \"allocations\": {}}}{}\n",
+                            to_string(usage.category), usage.bytes, usage.peak_bytes, usage.budget,
+                            usage.allocation_count, i + 1 < usages.size() ? "," : "");
+    }
+
+    char* vma_stats = nullptr;
+    vmaBuildStatsString(device.get_memory_allocator(), &vma_stats, detailed_map ? VK_TRUE : VK_FALSE);
+    json += fmt::format("  }},\n  \"vma\": {}\n}}\n", vma_stats ? vma_stats : "null");
+    vmaFreeStatsString(device.get_memory_allocator(), vma_stats);
+
+    return json;
+}
+
+bool vk_memory_telemetry::write_json(const std::string& path, bool detailed_map) const
+{
+    std::ofstream file{path, std::ios::out | std::ios::trunc};
+    if (!file.is_open()) {
+        LOGE("Failed to open memory telemetry file {}", path);
+        return false;
+    }
+
+    file << to_json(detailed_map);
+    return true;
+}
+
+void vk_memory_telemetry::log_summary() const
+{
+    constexpr double MB = 1024.0 * 1024.0;
+
+    for (auto& heap: get_heap_budgets()) {
+        LOGI("Heap {} ({}): usage {:.1f} MB / budget {:.1f} MB, {} blocks, {} allocations",
+             heap.heap_index,
+             (heap.flags & vk::MemoryHeapFlagBits::eDeviceLocal) ? "device" : "host",
+             heap.usage / MB, heap.budget / MB, heap.block_count, heap.allocation_count);
+    }
+
+    for (auto& usage: get_category_usages()) {
+        if (usage.allocation_count == 0 && usage.peak_bytes == 0) {
+            continue;
+        }
+        LOGI("  {:<14} {:>10.2f} MB (peak {:.2f} MB, budget {}), {} allocations",
+             to_string(usage.category), usage.bytes / MB, usage.peak_bytes / MB,
+             usage.budget ? fmt::format("{:.2f} MB", usage.budget / MB) : std::string{"-"},
+             usage.allocation_count);
+    }
+}
@@ -0,0 +1,159 @@
+﻿/**
+ * @File MemoryTelemetry.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 显存预算与分类统计
+ */
+
+#pragma once
+
+#include "VkCommon.hpp"
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+class vk_device;
+
+/**
+ * @brief 分配时附加的类别标签
+ */
+enum class MemoryCategory : uint32_t
+{
+    Other,
+    Mesh,
+    Texture,
+    FrameRing,
+    Staging,
+    RenderTarget,
+    Count,
+};
+
+const char* to_string(MemoryCategory category);
+
+/**
+ * @brief 类别超出配置的预算且无法通过回收腾出空间时抛出
+ */
+class MemoryBudgetExceeded : public VulkanException
+{
+public:
+    explicit MemoryBudgetExceeded(const std::string& msg) :
+        VulkanException{vk::Result::eErrorOutOfDeviceMemory, msg} {}
+};
+
+/**
+ * @brief 写入 VMA allocation 的 pUserData，碎片整理时据此找到持有该分配的对象
+ */
+struct AllocationOwner
+{
+    enum class Kind
+    {
+        Buffer,
+        Image,
+    };
+
+    Kind  kind;
+    void* object;
+};
+
+struct MemoryHeapBudget
+{
+    uint32_t            heap_index{0};
+    vk::MemoryHeapFlags flags;
+    vk::DeviceSize      heap_size{0};
+    vk::DeviceSize      usage{0};               // 整个进程在该堆上的估计使用量
+    vk::DeviceSize      budget{0};              // 驱动给出的可用预算
+    vk::DeviceSize      block_bytes{0};         // VMA 申请的 VkDeviceMemory 总量
+    vk::DeviceSize      allocation_bytes{0};    // 实际被分配占用的字节数
+    uint32_t            block_count{0};
+    uint32_t            allocation_count{0};
+};
+
+struct MemoryCategoryUsage
+{
+    MemoryCategory category{MemoryCategory::Other};
+    vk::DeviceSize bytes{0};
+    vk::DeviceSize peak_bytes{0};
+    vk::DeviceSize budget{0};                   // 0 表示不限制
+    uint32_t       allocation_count{0};
+};
+
+class vk_memory_telemetry
+{
+public:
+    /**
+     * @brief 回收回调：尝试为 category 释放至少 bytes_needed 字节，返回实际释放的字节数
+     */
+    using EvictCallback = std::function<vk::DeviceSize(MemoryCategory category, vk::DeviceSize bytes_needed)>;
+
+    explicit vk_memory_telemetry(vk_device& device, bool memory_budget_enabled);
+
+    vk_memory_telemetry(const vk_memory_telemetry&) = delete;
+    vk_memory_telemetry(vk_memory_telemetry&&) = delete;
+    vk_memory_telemetry& operator=(const vk_memory_telemetry&) = delete;
+    vk_memory_telemetry& operator=(vk_memory_telemetry&&) = delete;
+
+    /**
+     * @brief 设置类别预算，0 表示不限制
+     */
+    void set_category_budget(MemoryCategory category, vk::DeviceSize bytes);
+
+    /**
+     * @brief 注册回收回调；注册后该类别的分配会带上 VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT，
+     *        超出堆预算时先回收再重试，而不是让驱动去换页
+     */
+    void set_evict_callback(MemoryCategory category, EvictCallback callback);
+
+    /**
+     * @brief 分配前调用：超出类别预算时先尝试回收，仍然不足返回 false
+     */
+    bool request(MemoryCategory category, vk::DeviceSize size);
+
+    /**
+     * @brief 堆预算不足导致分配失败后调用，返回是否值得重试
+     */
+    bool evict(MemoryCategory category, vk::DeviceSize size);
+
+    VmaAllocationCreateFlags get_allocation_flags(MemoryCategory category) const;
+
+    void on_allocated(MemoryCategory category, vk::DeviceSize size);
+
+    void on_freed(MemoryCategory category, vk::DeviceSize size);
+
+    bool is_memory_budget_enabled() const;
+
+    std::vector<MemoryHeapBudget> get_heap_budgets() const;
+
+    MemoryCategoryUsage get_category_usage(MemoryCategory category) const;
+
+    std::vector<MemoryCategoryUsage> get_category_usages() const;
+
+    /**
+     * @brief 输出 JSON：堆预算、类别统计以及 vmaBuildStatsString 的完整内容
+     */
+    std::string to_json(bool detailed_map = false) const;
+
+    bool write_json(const std::string& path, bool detailed_map = false) const;
+
+    void log_summary() const;
+
+private:
+    struct CategoryState
+    {
+        std::atomic<vk::DeviceSize> bytes{0};
+        std::atomic<vk::DeviceSize> peak_bytes{0};
+        std::atomic<vk::DeviceSize> budget{0};
+        std::atomic<uint32_t>       allocation_count{0};
+    };
+
+    vk_device& device;
+
+    bool memory_budget_enabled{false};
+
+    std::array<CategoryState, static_cast<size_t>(MemoryCategory::Count)> categories;
+
+    mutable std::mutex evict_mutex;
+
+    std::array<EvictCallback, static_cast<size_t>(MemoryCategory::Count)> evict_callbacks;
+};
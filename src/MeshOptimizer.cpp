@@ -0,0 +1,1274 @@
+﻿/**
+ * @File MeshOptimizer.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+
+namespace {
+inline const float* get_attribute(const MeshView& mesh, size_t vertex, size_t offset)
+{
+    return reinterpret_cast<const float*>(static_cast<const uint8_t*>(mesh.vertices) + vertex * mesh.vertex_stride
+                                          + offset);
+}
+
+inline uint16_t quantize_unorm16(float value)
+{
+    return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+inline uint8_t quantize_unorm8(float value)
+{
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+// Forsyth 评分参数，LRU 缓存大小独立于分析时模拟的 FIFO 大小
+constexpr int   FORSYTH_CACHE_SIZE         = 32;
+constexpr int   FORSYTH_MAX_VALENCE        = 32;
+constexpr float FORSYTH_CACHE_DECAY_POWER  = 1.5f;
+constexpr float FORSYTH_LAST_TRIANGLE      = 0.75f;
+constexpr float FORSYTH_VALENCE_BOOST      = 2.0f;
+constexpr float FORSYTH_VALENCE_POWER      = 0.5f;
+
+struct ForsythTables
+{
+    float cache[FORSYTH_CACHE_SIZE];
+    float valence[FORSYTH_MAX_VALENCE + 1];
+
+    ForsythTables()
+    {
+        for (int i = 0; i < FORSYTH_CACHE_SIZE; ++i) {
+            cache[i] = i < 3 ? FORSYTH_LAST_TRIANGLE
+                             : std::pow(1.0f - static_cast<float>(i - 3) / (FORSYTH_CACHE_SIZE - 3),
+                                        FORSYTH_CACHE_DECAY_POWER);
+        }
+
+        valence[0] = 0.0f;
+        for (int i = 1; i <= FORSYTH_MAX_VALENCE; ++i) {
+            valence[i] = FORSYTH_VALENCE_BOOST * std::pow(static_cast<float>(i), -FORSYTH_VALENCE_POWER);
+        }
+    }
+};
+
+float forsyth_vertex_score(const ForsythTables& tables, int cache_position, uint32_t live_triangles)
+{
+    // 已无待输出三角形的顶点不再参与评分
+    if (live_triangles == 0) {
+        return -1.0f;
+    }
+
+    float score = cache_position >= 0 ? tables.cache[cache_position] : 0.0f;
+    return score + tables.valence[std::min<uint32_t>(live_triangles, FORSYTH_MAX_VALENCE)];
+}
+
+inline const float* get_position(const float* positions, size_t stride, uint32_t vertex)
+{
+    return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + vertex * stride);
+}
+
+/**
+ * @brief 以时间戳模拟 FIFO 缓存：顶点进入缓存时记录当前时间戳，时间差小于缓存大小即命中
+ */
+class FifoCache
+{
+public:
+    FifoCache(size_t vertex_count, uint32_t cache_size)
+        : timestamps_(vertex_count, 0), cache_size_(cache_size), time_(cache_size + 1) {}
+
+    bool access(uint32_t vertex)
+    {
+        if (time_ - timestamps_[vertex] > cache_size_) {
+            timestamps_[vertex] = time_++;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    std::vector<uint32_t> timestamps_;
+    uint32_t              cache_size_;
+    uint32_t              time_;
+};
+
+/**
+ * @brief 以面积加权的平面二次误差，error() 返回加权平均的平方距离
+ */
+struct Quadric
+{
+    double a00{0}, a01{0}, a02{0}, a11{0}, a12{0}, a22{0};
+    double b0{0}, b1{0}, b2{0};
+    double c{0};
+    double weight{0};
+
+    static Quadric from_plane(double nx, double ny, double nz, double d, double w)
+    {
+        Quadric q;
+        q.a00    = w * nx * nx;
+        q.a01    = w * nx * ny;
+        q.a02    = w * nx * nz;
+        q.a11    = w * ny * ny;
+        q.a12    = w * ny * nz;
+        q.a22    = w * nz * nz;
+        q.b0     = w * nx * d;
+        q.b1     = w * ny * d;
+        q.b2     = w * nz * d;
+        q.c      = w * d * d;
+        q.weight = w;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& r)
+    {
+        a00 += r.a00, a01 += r.a01, a02 += r.a02, a11 += r.a11, a12 += r.a12, a22 += r.a22;
+        b0 += r.b0, b1 += r.b1, b2 += r.b2;
+        c += r.c;
+        weight += r.weight;
+        return *this;
+    }
+
+    double error(const float* p) const
+    {
+        double x = p[0], y = p[1], z = p[2];
+        double e = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+                   + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return weight > 0.0 ? std::abs(e) / weight : 0.0;
+    }
+};
+
+inline void triangle_normal(const float* p0, const float* p1, const float* p2, double (& n)[3])
+{
+    double e1[3] = {double(p1[0]) - p0[0], double(p1[1]) - p0[1], double(p1[2]) - p0[2]};
+    double e2[3] = {double(p2[0]) - p0[0], double(p2[1]) - p0[1], double(p2[2]) - p0[2]};
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+MeshletBounds compute_meshlet_bounds(const MeshletMesh& mesh, const Meshlet& meshlet, const float* positions,
+                                     size_t position_stride)
+{
+    MeshletBounds bounds;
+
+    // 包围球：AABB 中心 + 最远顶点距离
+    float min_position[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                             std::numeric_limits<float>::max()};
+    float max_position[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                             std::numeric_limits<float>::lowest()};
+
+    for (uint32_t i = 0; i < meshlet.vertex_count; ++i) {
+        const float* p = get_position(positions, position_stride, mesh.vertices[meshlet.vertex_offset + i]);
+        for (int axis = 0; axis < 3; ++axis) {
+            min_position[axis] = std::min(min_position[axis], p[axis]);
+            max_position[axis] = std::max(max_position[axis], p[axis]);
+        }
+    }
+
+    for (int axis = 0; axis < 3; ++axis) {
+        bounds.center[axis] = (min_position[axis] + max_position[axis]) * 0.5f;
+    }
+
+    float radius_sq = 0.0f;
+    for (uint32_t i = 0; i < meshlet.vertex_count; ++i) {
+        const float* p  = get_position(positions, position_stride, mesh.vertices[meshlet.vertex_offset + i]);
+        float        dx = p[0] - bounds.center[0], dy = p[1] - bounds.center[1], dz = p[2] - bounds.center[2];
+        radius_sq = std::max(radius_sq, dx * dx + dy * dy + dz * dz);
+    }
+    bounds.radius = std::sqrt(radius_sq);
+
+    // 法线锥：单位面法线的平均方向，cutoff = sin(最大夹角)
+    std::vector<std::array<float, 3>> normals;
+    normals.reserve(meshlet.triangle_count);
+
+    float axis[3]{};
+    for (uint32_t t = 0; t < meshlet.triangle_count; ++t) {
+        const uint8_t* triangle = mesh.triangles.data() + meshlet.triangle_offset + t * 3;
+        const float*   p0 = get_position(positions, position_stride, mesh.vertices[meshlet.vertex_offset + triangle[0]]);
+        const float*   p1 = get_position(positions, position_stride, mesh.vertices[meshlet.vertex_offset + triangle[1]]);
+        const float*   p2 = get_position(positions, position_stride, mesh.vertices[meshlet.vertex_offset + triangle[2]]);
+
+        float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        float n[3]  = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        float len   = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+        // 退化三角形不影响朝向
+        if (len == 0.0f) {
+            continue;
+        }
+
+        normals.push_back({n[0] / len, n[1] / len, n[2] / len});
+        for (int k = 0; k < 3; ++k) {
+            axis[k] += normals.back()[k];
+        }
+    }
+
+    float axis_len = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    if (normals.empty() || axis_len == 0.0f) {
+        return bounds;
+    }
+
+    float min_dot = 1.0f;
+    for (int k = 0; k < 3; ++k) {
+        bounds.cone_axis[k] = axis[k] / axis_len;
+    }
+    for (const auto& n: normals) {
+        min_dot = std::min(min_dot, n[0] * bounds.cone_axis[0] + n[1] * bounds.cone_axis[1]
+                                    + n[2] * bounds.cone_axis[2]);
+    }
+
+    // 锥角接近或超过 90° 时无法据此剔除
+    bounds.cone_cutoff = min_dot <= 0.1f ? 1.0f : std::sqrt(1.0f - min_dot * min_dot);
+
+    return bounds;
+}
+}        // namespace
+
+VkVertexInputBindingDescription QuantizedVertex::get_binding_description(uint32_t binding)
+{
+    VkVertexInputBindingDescription binding_description{};
+    binding_description.binding   = binding;
+    binding_description.stride    = sizeof(QuantizedVertex);
+    binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    return binding_description;
+}
+
+std::array<VkVertexInputAttributeDescription, 3> QuantizedVertex::get_attribute_descriptions(uint32_t binding,
+                                                                                             uint32_t first_location)
+{
+    std::array<VkVertexInputAttributeDescription, 3> attribute_descriptions{};
+
+    // R16G16B16 的顶点输入支持并不普遍，位置使用 4 分量格式，着色器只读取 xyz
+    attribute_descriptions[0].binding  = binding;
+    attribute_descriptions[0].location = first_location + 0;
+    attribute_descriptions[0].format   = VK_FORMAT_R16G16B16A16_UNORM;
+    attribute_descriptions[0].offset   = offsetof(QuantizedVertex, position);
+
+    attribute_descriptions[1].binding  = binding;
+    attribute_descriptions[1].location = first_location + 1;
+    attribute_descriptions[1].format   = VK_FORMAT_R8G8B8A8_UNORM;
+    attribute_descriptions[1].offset   = offsetof(QuantizedVertex, color);
+
+    attribute_descriptions[2].binding  = binding;
+    attribute_descriptions[2].location = first_location + 2;
+    attribute_descriptions[2].format   = VK_FORMAT_R16G16_SFLOAT;
+    attribute_descriptions[2].offset   = offsetof(QuantizedVertex, tex_coord);
+
+    return attribute_descriptions;
+}
+
+const void* QuantizedMesh::get_index_data() const
+{
+    return index_type == vk::IndexType::eUint16 ? static_cast<const void*>(indices16.data())
+                                                : static_cast<const void*>(indices32.data());
+}
+
+uint32_t QuantizedMesh::get_index_count() const
+{
+    return static_cast<uint32_t>(index_type == vk::IndexType::eUint16 ? indices16.size() : indices32.size());
+}
+
+uint32_t QuantizedMesh::get_index_size() const
+{
+    return index_type == vk::IndexType::eUint16 ? 2 : 4;
+}
+
+std::array<float, 16> QuantizedMesh::get_dequantization_matrix() const
+{
+    std::array<float, 16> matrix{};
+    for (int axis = 0; axis < 3; ++axis) {
+        matrix[axis * 4 + axis] = bounds_max[axis] - bounds_min[axis];
+        matrix[12 + axis]       = bounds_min[axis];
+    }
+    matrix[15] = 1.0f;
+
+    return matrix;
+}
+
+QuantizedMesh quantize_mesh(const MeshView& mesh)
+{
+    QuantizedMesh result;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        result.bounds_min[axis] = std::numeric_limits<float>::max();
+        result.bounds_max[axis] = std::numeric_limits<float>::lowest();
+    }
+
+    for (size_t i = 0; i < mesh.vertex_count; ++i) {
+        const float* position = get_attribute(mesh, i, mesh.position_offset);
+        for (int axis = 0; axis < 3; ++axis) {
+            result.bounds_min[axis] = std::min(result.bounds_min[axis], position[axis]);
+            result.bounds_max[axis] = std::max(result.bounds_max[axis], position[axis]);
+        }
+    }
+
+    float inv_extent[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        if (mesh.vertex_count == 0) {
+            result.bounds_min[axis] = result.bounds_max[axis] = 0.0f;
+        }
+
+        // 退化轴保持非零范围，避免除零
+        if (result.bounds_max[axis] <= result.bounds_min[axis]) {
+            result.bounds_max[axis] = result.bounds_min[axis] + 1.0f;
+        }
+
+        float extent = result.bounds_max[axis] - result.bounds_min[axis];
+        inv_extent[axis] = 1.0f / extent;
+        result.max_position_error = std::max(result.max_position_error, extent / 65535.0f * 0.5f);
+    }
+
+    result.vertices.resize(mesh.vertex_count);
+    for (size_t i = 0; i < mesh.vertex_count; ++i) {
+        auto& vertex = result.vertices[i];
+
+        const float* position = get_attribute(mesh, i, mesh.position_offset);
+        for (int axis = 0; axis < 3; ++axis) {
+            vertex.position[axis] = quantize_unorm16((position[axis] - result.bounds_min[axis]) * inv_extent[axis]);
+        }
+        vertex.position[3] = 0;
+
+        if (mesh.color_offset != MeshView::NO_ATTRIBUTE) {
+            const float* color = get_attribute(mesh, i, mesh.color_offset);
+            for (int c = 0; c < 3; ++c) {
+                vertex.color[c] = quantize_unorm8(color[c]);
+            }
+        } else {
+            vertex.color[0] = vertex.color[1] = vertex.color[2] = 255;
+        }
+        vertex.color[3] = 255;
+
+        if (mesh.tex_coord_offset != MeshView::NO_ATTRIBUTE) {
+            const float* tex_coord = get_attribute(mesh, i, mesh.tex_coord_offset);
+            vertex.tex_coord[0] = float_to_half(tex_coord[0]);
+            vertex.tex_coord[1] = float_to_half(tex_coord[1]);
+        } else {
+            vertex.tex_coord[0] = vertex.tex_coord[1] = 0;
+        }
+    }
+
+    if (mesh.vertex_count <= 65536) {
+        result.index_type = vk::IndexType::eUint16;
+        result.indices16.resize(mesh.index_count);
+        for (size_t i = 0; i < mesh.index_count; ++i) {
+            result.indices16[i] = static_cast<uint16_t>(mesh.indices[i]);
+        }
+    } else {
+        result.index_type = vk::IndexType::eUint32;
+        result.indices32.assign(mesh.indices, mesh.indices + mesh.index_count);
+    }
+
+    return result;
+}
+
+uint16_t float_to_half(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign     = (bits >> 16) & 0x8000u;
+    int32_t  exponent = static_cast<int32_t>((bits >> 23) & 0xFFu) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    // NaN / Inf
+    if (((bits >> 23) & 0xFFu) == 0xFFu) {
+        return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    }
+
+    // 上溢为 Inf
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+
+    // 非规格化数或下溢为 0
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        uint32_t shift     = static_cast<uint32_t>(14 - exponent);
+        uint32_t half      = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        uint32_t halfway   = 1u << (shift - 1u);
+        if (remainder > halfway || (remainder == halfway && (half & 1u))) {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // 规格化数，就近舍入到偶数（进位可能使指数加一，结果仍然正确）
+    uint32_t half      = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+        ++half;
+    }
+    return static_cast<uint16_t>(half);
+}
+
+float half_to_float(uint16_t value)
+{
+    uint32_t sign     = static_cast<uint32_t>(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+
+    uint32_t bits;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // 非规格化数，规格化后再组装
+            exponent = 127 - 15 + 1;
+            while ((mantissa & 0x400u) == 0) {
+                mantissa <<= 1;
+                --exponent;
+            }
+            mantissa &= 0x3FFu;
+            bits = sign | (exponent << 23) | (mantissa << 13);
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+VertexCacheStatistics analyze_vertex_cache(const uint32_t* indices, size_t index_count, size_t vertex_count,
+                                           size_t vertex_size, uint32_t cache_size)
+{
+    assert(index_count % 3 == 0);
+
+    constexpr size_t CACHE_LINE       = 64;
+    constexpr uint32_t FETCH_LINES    = 64;        // 4KB 顶点读取缓存
+
+    VertexCacheStatistics stats;
+    if (index_count == 0 || vertex_count == 0) {
+        return stats;
+    }
+
+    size_t line_count = (vertex_count * vertex_size + CACHE_LINE - 1) / CACHE_LINE;
+
+    FifoCache             transform_cache{vertex_count, cache_size};
+    FifoCache             fetch_cache{line_count, FETCH_LINES};
+    std::vector<uint8_t>  referenced(vertex_count, 0);
+    size_t                unique_count = 0;
+
+    for (size_t i = 0; i < index_count; ++i) {
+        uint32_t vertex = indices[i];
+        assert(vertex < vertex_count);
+
+        if (!referenced[vertex]) {
+            referenced[vertex] = 1;
+            ++unique_count;
+        }
+
+        if (transform_cache.access(vertex)) {
+            continue;
+        }
+
+        ++stats.vertices_transformed;
+
+        // 变换未命中时才需要读取顶点，顶点可能跨越两条缓存行
+        size_t first_line = vertex * vertex_size / CACHE_LINE;
+        size_t last_line  = ((vertex + 1) * vertex_size - 1) / CACHE_LINE;
+        for (size_t line = first_line; line <= last_line; ++line) {
+            if (!fetch_cache.access(static_cast<uint32_t>(line))) {
+                stats.bytes_fetched += CACHE_LINE;
+            }
+        }
+    }
+
+    stats.acmr      = static_cast<float>(stats.vertices_transformed) / static_cast<float>(index_count / 3);
+    stats.atvr      = static_cast<float>(stats.vertices_transformed) / static_cast<float>(unique_count);
+    stats.overfetch = static_cast<float>(stats.bytes_fetched) / static_cast<float>(vertex_count * vertex_size);
+
+    return stats;
+}
+
+void optimize_vertex_cache(uint32_t* destination, const uint32_t* indices, size_t index_count, size_t vertex_count)
+{
+    assert(destination != indices);
+    assert(index_count % 3 == 0);
+
+    static const ForsythTables tables;
+
+    size_t triangle_count = index_count / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+
+    // 顶点 -> 相邻三角形，live_triangles 记录尚未输出的相邻三角形数
+    std::vector<uint32_t> live_triangles(vertex_count, 0);
+    for (size_t i = 0; i < index_count; ++i) {
+        assert(indices[i] < vertex_count);
+        ++live_triangles[indices[i]];
+    }
+
+    std::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        adjacency_offsets[v + 1] = adjacency_offsets[v] + live_triangles[v];
+    }
+
+    std::vector<uint32_t> adjacency(index_count);
+    {
+        std::vector<uint32_t> cursor(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+        for (size_t i = 0; i < index_count; ++i) {
+            adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<float> vertex_score(vertex_count);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        vertex_score[v] = forsyth_vertex_score(tables, -1, live_triangles[v]);
+    }
+
+    std::vector<float>   triangle_score(triangle_count);
+    std::vector<uint8_t> emitted(triangle_count, 0);
+
+    int64_t best_triangle = -1;
+    float   best_score    = std::numeric_limits<float>::lowest();
+    for (size_t t = 0; t < triangle_count; ++t) {
+        triangle_score[t] = vertex_score[indices[t * 3 + 0]] + vertex_score[indices[t * 3 + 1]]
+                            + vertex_score[indices[t * 3 + 2]];
+        if (triangle_score[t] > best_score) {
+            best_score    = triangle_score[t];
+            best_triangle = static_cast<int64_t>(t);
+        }
+    }
+
+    uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+    uint32_t new_cache[FORSYTH_CACHE_SIZE + 3];
+    size_t   cache_count = 0;
+
+    size_t output      = 0;
+    size_t scan_cursor = 0;
+
+    while (output < index_count) {
+        // 缓存中的顶点已没有待输出三角形时，退化为顺序扫描下一个未输出三角形
+        if (best_triangle < 0) {
+            while (scan_cursor < triangle_count && emitted[scan_cursor]) {
+                ++scan_cursor;
+            }
+            assert(scan_cursor < triangle_count);
+            best_triangle = static_cast<int64_t>(scan_cursor);
+        }
+
+        const uint32_t* triangle = indices + best_triangle * 3;
+        destination[output++] = triangle[0];
+        destination[output++] = triangle[1];
+        destination[output++] = triangle[2];
+        emitted[best_triangle] = 1;
+
+        // LRU 更新：新三角形的顶点置于最前
+        size_t new_count = 0;
+        for (int k = 0; k < 3; ++k) {
+            new_cache[new_count++] = triangle[k];
+        }
+        for (size_t i = 0; i < cache_count; ++i) {
+            uint32_t v = cache[i];
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                new_cache[new_count++] = v;
+            }
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            uint32_t  v     = triangle[k];
+            uint32_t* begin = adjacency.data() + adjacency_offsets[v];
+            uint32_t* end   = begin + live_triangles[v];
+            uint32_t* it    = std::find(begin, end, static_cast<uint32_t>(best_triangle));
+            assert(it != end);
+            std::swap(*it, *(end - 1));
+            --live_triangles[v];
+        }
+
+        // 先更新所有受影响顶点与三角形的分数，再从中挑选下一个三角形
+        for (size_t i = 0; i < new_count; ++i) {
+            uint32_t v        = new_cache[i];
+            int32_t  position = i < FORSYTH_CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+
+            float score = forsyth_vertex_score(tables, position, live_triangles[v]);
+            float delta = score - vertex_score[v];
+            vertex_score[v] = score;
+
+            const uint32_t* begin = adjacency.data() + adjacency_offsets[v];
+            for (uint32_t j = 0; j < live_triangles[v]; ++j) {
+                triangle_score[begin[j]] += delta;
+            }
+        }
+
+        best_triangle = -1;
+        best_score    = std::numeric_limits<float>::lowest();
+        cache_count   = std::min<size_t>(new_count, FORSYTH_CACHE_SIZE);
+        for (size_t i = 0; i < cache_count; ++i) {
+            uint32_t v = new_cache[i];
+            cache[i]   = v;
+
+            const uint32_t* begin = adjacency.data() + adjacency_offsets[v];
+            for (uint32_t j = 0; j < live_triangles[v]; ++j) {
+                uint32_t t = begin[j];
+                if (triangle_score[t] > best_score) {
+                    best_score    = triangle_score[t];
+                    best_triangle = t;
+                }
+            }
+        }
+    }
+}
+
+void optimize_overdraw(uint32_t* destination, const uint32_t* indices, size_t index_count, const float* positions,
+                       size_t vertex_count, size_t position_stride, float threshold)
+{
+    assert(destination != indices);
+    assert(index_count % 3 == 0);
+
+    constexpr uint32_t CACHE_SIZE = 16;
+
+    size_t triangle_count = index_count / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+
+    // 硬边界：三个顶点全部未命中的三角形，说明缓存已完全刷新，在此切分不会损失命中
+    std::vector<uint32_t> hard_boundaries;
+    {
+        FifoCache cache{vertex_count, CACHE_SIZE};
+        for (size_t t = 0; t < triangle_count; ++t) {
+            int misses = 0;
+            for (int k = 0; k < 3; ++k) {
+                misses += cache.access(indices[t * 3 + k]) ? 0 : 1;
+            }
+            if (t == 0 || misses == 3) {
+                hard_boundaries.push_back(static_cast<uint32_t>(t));
+            }
+        }
+        hard_boundaries.push_back(static_cast<uint32_t>(triangle_count));
+    }
+
+    // 软边界：簇内前缀 ACMR 不超过簇整体 ACMR * threshold 时即可在此切分
+    std::vector<uint32_t> clusters;
+    for (size_t c = 0; c + 1 < hard_boundaries.size(); ++c) {
+        uint32_t begin = hard_boundaries[c];
+        uint32_t end   = hard_boundaries[c + 1];
+
+        FifoCache cache{vertex_count, CACHE_SIZE};
+        uint32_t  cluster_misses = 0;
+        for (uint32_t t = begin; t < end; ++t) {
+            for (int k = 0; k < 3; ++k) {
+                cluster_misses += cache.access(indices[t * 3 + k]) ? 0 : 1;
+            }
+        }
+        float cluster_acmr = static_cast<float>(cluster_misses) / static_cast<float>(end - begin);
+
+        clusters.push_back(begin);
+
+        FifoCache prefix_cache{vertex_count, CACHE_SIZE};
+        uint32_t  prefix_start  = begin;
+        uint32_t  prefix_misses = 0;
+        for (uint32_t t = begin; t < end; ++t) {
+            for (int k = 0; k < 3; ++k) {
+                prefix_misses += prefix_cache.access(indices[t * 3 + k]) ? 0 : 1;
+            }
+
+            float prefix_acmr = static_cast<float>(prefix_misses) / static_cast<float>(t + 1 - prefix_start);
+            if (t + 1 < end && prefix_acmr <= cluster_acmr * threshold) {
+                prefix_start  = t + 1;
+                prefix_misses = 0;
+                prefix_cache  = FifoCache{vertex_count, CACHE_SIZE};
+                clusters.push_back(prefix_start);
+            }
+        }
+    }
+    clusters.push_back(static_cast<uint32_t>(triangle_count));
+
+    size_t cluster_count = clusters.size() - 1;
+
+    // 网格质心（面积加权）
+    double mesh_centroid[3]{};
+    double mesh_area = 0.0;
+
+    std::vector<float> cluster_keys(cluster_count);
+    std::vector<float> cluster_data(cluster_count * 6);        // 质心 xyz + 法线 xyz
+
+    for (size_t c = 0; c < cluster_count; ++c) {
+        float centroid[3]{};
+        float normal[3]{};
+        float area_sum = 0.0f;
+
+        for (uint32_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const float* p0 = get_position(positions, position_stride, indices[t * 3 + 0]);
+            const float* p1 = get_position(positions, position_stride, indices[t * 3 + 1]);
+            const float* p2 = get_position(positions, position_stride, indices[t * 3 + 2]);
+
+            float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            float n[3]  = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            float area  = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            for (int axis = 0; axis < 3; ++axis) {
+                centroid[axis] += (p0[axis] + p1[axis] + p2[axis]) * (area / 3.0f);
+                normal[axis] += n[axis];
+            }
+            area_sum += area;
+        }
+
+        for (int axis = 0; axis < 3; ++axis) {
+            mesh_centroid[axis] += centroid[axis];
+        }
+        mesh_area += area_sum;
+
+        float inv_area   = area_sum > 0.0f ? 1.0f / area_sum : 0.0f;
+        float normal_len = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        float inv_normal = normal_len > 0.0f ? 1.0f / normal_len : 0.0f;
+
+        for (int axis = 0; axis < 3; ++axis) {
+            cluster_data[c * 6 + axis]     = centroid[axis] * inv_area;
+            cluster_data[c * 6 + 3 + axis] = normal[axis] * inv_normal;
+        }
+    }
+
+    if (mesh_area > 0.0) {
+        for (double& axis: mesh_centroid) {
+            axis /= mesh_area;
+        }
+    }
+
+    // 簇中心相对网格质心越朝外（沿簇法线方向越远），越应先绘制
+    for (size_t c = 0; c < cluster_count; ++c) {
+        const float* data = cluster_data.data() + c * 6;
+        cluster_keys[c] = static_cast<float>((data[0] - mesh_centroid[0]) * data[3]
+                                             + (data[1] - mesh_centroid[1]) * data[4]
+                                             + (data[2] - mesh_centroid[2]) * data[5]);
+    }
+
+    std::vector<uint32_t> order(cluster_count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](uint32_t a, uint32_t b) { return cluster_keys[a] > cluster_keys[b]; });
+
+    size_t output = 0;
+    for (uint32_t c: order) {
+        size_t begin = clusters[c] * 3;
+        size_t count = (clusters[c + 1] - clusters[c]) * 3;
+        std::memcpy(destination + output, indices + begin, count * sizeof(uint32_t));
+        output += count;
+    }
+
+    assert(output == index_count);
+}
+
+size_t optimize_vertex_fetch(void* destination, uint32_t* indices, size_t index_count, const void* vertices,
+                             size_t vertex_count, size_t vertex_size)
+{
+    assert(destination != vertices);
+
+    constexpr uint32_t UNUSED = ~0u;
+
+    std::vector<uint32_t> remap(vertex_count, UNUSED);
+    uint32_t              next_vertex = 0;
+
+    auto* dst = static_cast<uint8_t*>(destination);
+    auto* src = static_cast<const uint8_t*>(vertices);
+
+    for (size_t i = 0; i < index_count; ++i) {
+        uint32_t vertex = indices[i];
+        assert(vertex < vertex_count);
+
+        if (remap[vertex] == UNUSED) {
+            std::memcpy(dst + next_vertex * vertex_size, src + vertex * vertex_size, vertex_size);
+            remap[vertex] = next_vertex++;
+        }
+
+        indices[i] = remap[vertex];
+    }
+
+    return next_vertex;
+}
+
+MeshletMesh build_meshlets(const uint32_t* indices, size_t index_count, const float* positions, size_t vertex_count,
+                           size_t position_stride, uint32_t max_vertices, uint32_t max_triangles)
+{
+    assert(index_count % 3 == 0);
+    assert(max_vertices >= 3 && max_vertices <= 256 && "局部索引以 uint8 存放");
+    assert(max_triangles >= 1);
+
+    MeshletMesh result;
+
+    // 原顶点 -> 当前 meshlet 内的局部下标，in_meshlet 标记该下标是否有效
+    std::vector<uint8_t> local_index(vertex_count, 0);
+    std::vector<uint8_t> in_meshlet(vertex_count, 0);
+
+    Meshlet current;
+
+    auto finish_meshlet = [&]() {
+        if (current.triangle_count == 0) {
+            return;
+        }
+
+        for (uint32_t i = 0; i < current.vertex_count; ++i) {
+            uint32_t vertex = result.vertices[current.vertex_offset + i];
+            in_meshlet[vertex] = 0;
+        }
+
+        result.meshlets.push_back(current);
+        result.bounds.push_back(compute_meshlet_bounds(result, current, positions, position_stride));
+
+        current                 = Meshlet{};
+        current.vertex_offset   = static_cast<uint32_t>(result.vertices.size());
+        current.triangle_offset = static_cast<uint32_t>(result.triangles.size());
+    };
+
+    for (size_t i = 0; i < index_count; i += 3) {
+        uint32_t triangle[3] = {indices[i + 0], indices[i + 1], indices[i + 2]};
+
+        uint32_t new_vertices = 0;
+        for (int k = 0; k < 3; ++k) {
+            assert(triangle[k] < vertex_count);
+            bool duplicate = (k > 0 && triangle[k] == triangle[0]) || (k > 1 && triangle[k] == triangle[1]);
+            new_vertices += !in_meshlet[triangle[k]] && !duplicate ? 1 : 0;
+        }
+
+        if (current.vertex_count + new_vertices > max_vertices || current.triangle_count + 1 > max_triangles) {
+            finish_meshlet();
+        }
+
+        for (uint32_t vertex: triangle) {
+            if (!in_meshlet[vertex]) {
+                in_meshlet[vertex]  = 1;
+                local_index[vertex] = static_cast<uint8_t>(current.vertex_count++);
+                result.vertices.push_back(vertex);
+            }
+            result.triangles.push_back(local_index[vertex]);
+        }
+
+        ++current.triangle_count;
+    }
+
+    finish_meshlet();
+
+    return result;
+}
+
+size_t simplify_mesh(uint32_t* destination, const uint32_t* indices, size_t index_count, const float* positions,
+                     size_t vertex_count, size_t position_stride, size_t target_index_count, float target_error,
+                     float* result_error)
+{
+    assert(index_count % 3 == 0);
+
+    std::vector<uint32_t> result(indices, indices + index_count);
+
+    auto position = [&](uint32_t v) { return get_position(positions, position_stride, v); };
+
+    // 位置相同的顶点（纹理接缝两侧）归并到同一个规范顶点
+    std::vector<uint32_t> canonical(vertex_count);
+    std::vector<uint32_t> wedge_count(vertex_count, 0);
+    {
+        struct PositionHash
+        {
+            size_t operator()(const std::array<float, 3>& p) const
+            {
+                uint32_t bits[3];
+                std::memcpy(bits, p.data(), sizeof(bits));
+                return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+            }
+        };
+
+        std::unordered_map<std::array<float, 3>, uint32_t, PositionHash> first_vertex;
+        first_vertex.reserve(vertex_count);
+        for (uint32_t v = 0; v < vertex_count; ++v) {
+            const float* p = position(v);
+            canonical[v] = first_vertex.emplace(std::array<float, 3>{p[0], p[1], p[2]}, v).first->second;
+            ++wedge_count[canonical[v]];
+        }
+    }
+
+    // 锁定接缝顶点与边界顶点（有向边没有反向边）
+    std::vector<uint8_t> locked(vertex_count, 0);
+    {
+        std::vector<uint64_t> edges;
+        edges.reserve(index_count);
+        for (size_t i = 0; i < index_count; i += 3) {
+            for (int k = 0; k < 3; ++k) {
+                uint64_t a = canonical[result[i + k]];
+                uint64_t b = canonical[result[i + (k + 1) % 3]];
+                edges.push_back(a << 32 | b);
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        for (uint64_t edge: edges) {
+            auto a = static_cast<uint32_t>(edge >> 32);
+            auto b = static_cast<uint32_t>(edge);
+            if (!std::binary_search(edges.begin(), edges.end(), uint64_t{b} << 32 | a)) {
+                locked[a] = locked[b] = 1;
+            }
+        }
+
+        for (uint32_t v = 0; v < vertex_count; ++v) {
+            if (wedge_count[canonical[v]] > 1) {
+                locked[canonical[v]] = 1;
+            }
+        }
+    }
+
+    std::vector<Quadric> quadrics(vertex_count);
+    for (size_t i = 0; i < index_count; i += 3) {
+        double n[3];
+        triangle_normal(position(result[i]), position(result[i + 1]), position(result[i + 2]), n);
+
+        double area2 = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (area2 == 0.0) {
+            continue;
+        }
+
+        const float* p0 = position(result[i]);
+        double nx = n[0] / area2, ny = n[1] / area2, nz = n[2] / area2;
+        double d  = -(nx * p0[0] + ny * p0[1] + nz * p0[2]);
+
+        Quadric q = Quadric::from_plane(nx, ny, nz, d, area2 * 0.5);
+        for (int k = 0; k < 3; ++k) {
+            quadrics[canonical[result[i + k]]] += q;
+        }
+    }
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double   cost;
+    };
+
+    double error_limit   = double(target_error) * target_error;
+    double max_error     = 0.0;
+
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> collapse_remap(vertex_count);
+    std::vector<uint8_t>  touched(vertex_count);
+    std::vector<uint32_t> adjacency_offsets(vertex_count + 1);
+    std::vector<uint32_t> adjacency;
+
+    while (result.size() > target_index_count) {
+        size_t triangle_count = result.size() / 3;
+
+        // 当前三角形的顶点邻接表，用于翻转检查
+        std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0u);
+        for (uint32_t v: result) {
+            ++adjacency_offsets[v + 1];
+        }
+        for (size_t v = 0; v < vertex_count; ++v) {
+            adjacency_offsets[v + 1] += adjacency_offsets[v];
+        }
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> cursor(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+            for (size_t i = 0; i < result.size(); ++i) {
+                adjacency[cursor[result[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        // 未锁定的顶点只有一个 wedge，因此 from 即是其规范顶点
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; ++k) {
+                uint32_t a = result[i + k];
+                uint32_t b = result[i + (k + 1) % 3];
+                for (auto [from, to]: {std::pair{a, b}, std::pair{b, a}}) {
+                    if (locked[canonical[from]] || canonical[from] == canonical[to]) {
+                        continue;
+                    }
+
+                    Quadric q = quadrics[canonical[from]];
+                    q += quadrics[canonical[to]];
+                    collapses.push_back({from, to, q.error(position(to))});
+                }
+            }
+        }
+
+        if (collapses.empty()) {
+            break;
+        }
+
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& l, const Collapse& r) { return l.cost < r.cost; });
+
+        std::iota(collapse_remap.begin(), collapse_remap.end(), 0u);
+        std::fill(touched.begin(), touched.end(), uint8_t{0});
+
+        size_t removed  = 0;
+        size_t accepted = 0;
+
+        for (const auto& collapse: collapses) {
+            if (collapse.cost > error_limit || (triangle_count - removed) * 3 <= target_index_count) {
+                break;
+            }
+
+            uint32_t from = collapse.from;
+            uint32_t to   = collapse.to;
+            if (touched[canonical[from]] || touched[canonical[to]]) {
+                continue;
+            }
+
+            // 移动 from 到 to 后，不含 to 的相邻三角形不能翻转
+            bool   flipped        = false;
+            size_t shared_count   = 0;
+            for (uint32_t j = adjacency_offsets[from]; j < adjacency_offsets[from + 1] && !flipped; ++j) {
+                const uint32_t* triangle = result.data() + adjacency[j] * 3;
+
+                bool has_to = false;
+                for (int k = 0; k < 3; ++k) {
+                    has_to = has_to || canonical[triangle[k]] == canonical[to];
+                }
+                if (has_to) {
+                    ++shared_count;
+                    continue;
+                }
+
+                const float* before[3];
+                const float* after[3];
+                for (int k = 0; k < 3; ++k) {
+                    before[k] = position(triangle[k]);
+                    after[k]  = triangle[k] == from ? position(to) : before[k];
+                }
+
+                double n0[3], n1[3];
+                triangle_normal(before[0], before[1], before[2], n0);
+                triangle_normal(after[0], after[1], after[2], n1);
+
+                double d  = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+                double l0 = n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2];
+                double l1 = n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2];
+                flipped = d <= 0.25 * std::sqrt(l0 * l1);
+            }
+
+            if (flipped) {
+                continue;
+            }
+
+            // 同一轮中 from 的一环邻域保持不动，保证上面的翻转检查仍然有效
+            for (uint32_t j = adjacency_offsets[from]; j < adjacency_offsets[from + 1]; ++j) {
+                const uint32_t* triangle = result.data() + adjacency[j] * 3;
+                for (int k = 0; k < 3; ++k) {
+                    touched[canonical[triangle[k]]] = 1;
+                }
+            }
+
+            collapse_remap[from] = to;
+            quadrics[canonical[to]] += quadrics[canonical[from]];
+            max_error = std::max(max_error, collapse.cost);
+            removed += shared_count;
+            ++accepted;
+        }
+
+        if (accepted == 0) {
+            break;
+        }
+
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            uint32_t a = collapse_remap[result[i + 0]];
+            uint32_t b = collapse_remap[result[i + 1]];
+            uint32_t c = collapse_remap[result[i + 2]];
+
+            if (canonical[a] == canonical[b] || canonical[b] == canonical[c] || canonical[a] == canonical[c]) {
+                continue;
+            }
+
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    if (result_error) {
+        *result_error = static_cast<float>(std::sqrt(max_error));
+    }
+
+    std::copy(result.begin(), result.end(), destination);
+    return result.size();
+}
+
+LodChain build_lod_chain(const uint32_t* indices, size_t index_count, const float* positions, size_t vertex_count,
+                         size_t position_stride, uint32_t max_lods, float reduction, float max_error)
+{
+    LodChain chain;
+    chain.indices.assign(indices, indices + index_count);
+    chain.lods.push_back({0, static_cast<uint32_t>(index_count), 0.0f});
+
+    float min_position[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                             std::numeric_limits<float>::max()};
+    float max_position[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                             std::numeric_limits<float>::lowest()};
+    for (size_t v = 0; v < vertex_count; ++v) {
+        const float* p = get_position(positions, position_stride, static_cast<uint32_t>(v));
+        for (int axis = 0; axis < 3; ++axis) {
+            min_position[axis] = std::min(min_position[axis], p[axis]);
+            max_position[axis] = std::max(max_position[axis], p[axis]);
+        }
+    }
+
+    float extent = 0.0f;
+    for (int axis = 0; axis < 3 && vertex_count > 0; ++axis) {
+        extent += (max_position[axis] - min_position[axis]) * (max_position[axis] - min_position[axis]);
+    }
+    extent = std::sqrt(extent);
+
+    std::vector<uint32_t> current(indices, indices + index_count);
+    std::vector<uint32_t> simplified(index_count);
+
+    for (uint32_t level = 1; level < max_lods; ++level) {
+        size_t target = static_cast<size_t>(static_cast<float>(current.size()) * reduction) / 3 * 3;
+        float  error  = 0.0f;
+
+        // 以上一级为输入逐级简化，误差累加作为相对原网格的上界
+        size_t count = simplify_mesh(simplified.data(), current.data(), current.size(), positions, vertex_count,
+                                     position_stride, target, max_error * extent, &error);
+        if (count == 0 || count > current.size() * 9 / 10) {
+            break;
+        }
+
+        current.resize(count);
+        optimize_vertex_cache(current.data(), simplified.data(), count, vertex_count);
+
+        chain.lods.push_back({static_cast<uint32_t>(chain.indices.size()), static_cast<uint32_t>(count),
+                              chain.lods.back().error + error});
+        chain.indices.insert(chain.indices.end(), current.begin(), current.end());
+    }
+
+    return chain;
+}
+
+uint32_t select_lod(const std::vector<MeshLod>& lods, float distance, float projection_scale, float max_pixel_error)
+{
+    distance = std::max(distance, std::numeric_limits<float>::epsilon());
+
+    for (size_t i = lods.size(); i-- > 1;) {
+        if (lods[i].error * projection_scale / distance <= max_pixel_error) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+
+    return 0;
+}
+
+void run_mesh_optimizer_benchmark(uint32_t grid_size)
+{
+    using clock = std::chrono::high_resolution_clock;
+
+    struct BenchVertex
+    {
+        float position[3];
+        float normal[3];
+        float tex_coord[2];
+    };
+
+    // 起伏网格，打乱三角形与顶点顺序以模拟未经整理的导入数据
+    uint32_t                 side = grid_size + 1;
+    std::vector<BenchVertex> vertices(static_cast<size_t>(side) * side);
+    for (uint32_t y = 0; y < side; ++y) {
+        for (uint32_t x = 0; x < side; ++x) {
+            float u = static_cast<float>(x) / grid_size;
+            float v = static_cast<float>(y) / grid_size;
+            vertices[y * side + x] = {{u, v, 0.05f * std::sin(u * 20.0f) * std::cos(v * 20.0f)}, {0, 0, 1}, {u, v}};
+        }
+    }
+
+    std::vector<uint32_t> indices;
+    indices.reserve(static_cast<size_t>(grid_size) * grid_size * 6);
+    for (uint32_t y = 0; y < grid_size; ++y) {
+        for (uint32_t x = 0; x < grid_size; ++x) {
+            uint32_t i0 = y * side + x;
+            uint32_t i1 = i0 + 1;
+            uint32_t i2 = i0 + side;
+            uint32_t i3 = i2 + 1;
+            indices.insert(indices.end(), {i0, i1, i2, i2, i1, i3});
+        }
+    }
+
+    std::mt19937 rng{42};
+
+    std::vector<uint32_t> vertex_shuffle(vertices.size());
+    std::iota(vertex_shuffle.begin(), vertex_shuffle.end(), 0u);
+    std::shuffle(vertex_shuffle.begin(), vertex_shuffle.end(), rng);
+    for (auto& index: indices) {
+        index = vertex_shuffle[index];
+    }
+    std::vector<BenchVertex> shuffled(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        shuffled[vertex_shuffle[i]] = vertices[i];
+    }
+    vertices.swap(shuffled);
+
+    size_t                triangle_count = indices.size() / 3;
+    std::vector<uint32_t> triangle_order(triangle_count);
+    std::iota(triangle_order.begin(), triangle_order.end(), 0u);
+    std::shuffle(triangle_order.begin(), triangle_order.end(), rng);
+    std::vector<uint32_t> shuffled_indices(indices.size());
+    for (size_t t = 0; t < triangle_count; ++t) {
+        std::memcpy(&shuffled_indices[t * 3], &indices[triangle_order[t] * 3], 3 * sizeof(uint32_t));
+    }
+    indices.swap(shuffled_indices);
+
+    auto print = [&](const char* name, const std::vector<uint32_t>& ib, double ms) {
+        auto stats = analyze_vertex_cache(ib.data(), ib.size(), vertices.size(), sizeof(BenchVertex));
+        std::printf("  %-16s ACMR %.3f  ATVR %.3f  overfetch %.3f  %9.2f ms\n", name, stats.acmr, stats.atvr,
+                    stats.overfetch, ms);
+    };
+
+    std::printf("Mesh optimizer benchmark: %zu vertices, %zu triangles\n", vertices.size(), triangle_count);
+    print("original", indices, 0.0);
+
+    std::vector<uint32_t> cache_optimized(indices.size());
+    auto                  t0 = clock::now();
+    optimize_vertex_cache(cache_optimized.data(), indices.data(), indices.size(), vertices.size());
+    print("vertex cache", cache_optimized, std::chrono::duration<double, std::milli>(clock::now() - t0).count());
+
+    std::vector<uint32_t> overdraw_optimized(indices.size());
+    t0 = clock::now();
+    optimize_overdraw(overdraw_optimized.data(), cache_optimized.data(), cache_optimized.size(),
+                      vertices[0].position, vertices.size(), sizeof(BenchVertex));
+    print("overdraw", overdraw_optimized, std::chrono::duration<double, std::milli>(clock::now() - t0).count());
+
+    std::vector<BenchVertex> remapped(vertices.size());
+    t0 = clock::now();
+    size_t unique_count = optimize_vertex_fetch(remapped.data(), overdraw_optimized.data(), overdraw_optimized.size(),
+                                                vertices.data(), vertices.size(), sizeof(BenchVertex));
+    double fetch_ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+    remapped.resize(unique_count);
+    vertices.swap(remapped);
+    print("vertex fetch", overdraw_optimized, fetch_ms);
+
+    t0 = clock::now();
+    auto meshlets = build_meshlets(overdraw_optimized.data(), overdraw_optimized.size(), vertices[0].position,
+                                   vertices.size(), sizeof(BenchVertex));
+    double meshlet_ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+
+    std::printf("  %-16s %zu meshlets, %.1f vertices / %.1f triangles per meshlet  %9.2f ms\n", "meshlets",
+                meshlets.meshlets.size(), static_cast<double>(meshlets.vertices.size()) / meshlets.meshlets.size(),
+                static_cast<double>(meshlets.triangles.size() / 3) / meshlets.meshlets.size(), meshlet_ms);
+
+    t0 = clock::now();
+    auto lod_chain = build_lod_chain(overdraw_optimized.data(), overdraw_optimized.size(), vertices[0].position,
+                                     vertices.size(), sizeof(BenchVertex));
+    double lod_ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+
+    std::printf("  %-16s %zu levels  %9.2f ms\n", "lod chain", lod_chain.lods.size(), lod_ms);
+    for (size_t i = 0; i < lod_chain.lods.size(); ++i) {
+        std::printf("    LOD %zu: %8u triangles, error %.6f\n", i, lod_chain.lods[i].index_count / 3,
+                    lod_chain.lods[i].error);
+    }
+}
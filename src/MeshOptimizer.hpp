@@ -0,0 +1,277 @@
+﻿/**
+ * @File MeshOptimizer.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 网格优化：顶点量化、索引压缩、顶点缓存 / overdraw / 顶点读取重排、meshlet 划分与 LOD 生成
+ */
+
+#pragma once
+
+#include "VkCommon.hpp"
+
+#include <array>
+#include <chrono>
+#include <type_traits>
+
+/**
+ * @brief 量化后的顶点，16 字节
+ *        position: 相对网格包围盒的 unorm16（w 分量为填充）
+ *        color:    RGBA8 unorm
+ *        tex_coord: 半精度浮点
+ */
+struct QuantizedVertex
+{
+    uint16_t position[4];
+    uint8_t  color[4];
+    uint16_t tex_coord[2];
+
+    static VkVertexInputBindingDescription get_binding_description(uint32_t binding = 0);
+
+    /**
+     * @brief 与着色器中 vec3 position / vec3 color / vec2 uv 输入对应的属性描述
+     */
+    static std::array<VkVertexInputAttributeDescription, 3> get_attribute_descriptions(uint32_t binding = 0,
+                                                                                       uint32_t first_location = 0);
+};
+
+static_assert(sizeof(QuantizedVertex) == 16, "QuantizedVertex 应为 16 字节");
+
+/**
+ * @brief 描述待处理的顶点与索引，属性以字节偏移给出，偏移为 NO_ATTRIBUTE 表示不存在
+ */
+struct MeshView
+{
+    static constexpr size_t NO_ATTRIBUTE = ~size_t{0};
+
+    const void* vertices{nullptr};
+    size_t      vertex_count{0};
+    size_t      vertex_stride{0};
+
+    size_t position_offset{0};                 // float3
+    size_t color_offset{NO_ATTRIBUTE};         // float3，缺省为白色
+    size_t tex_coord_offset{NO_ATTRIBUTE};     // float2
+
+    const uint32_t* indices{nullptr};
+    size_t          index_count{0};
+};
+
+struct QuantizedMesh
+{
+    std::vector<QuantizedVertex> vertices;
+
+    // 顶点数不超过 65536 时使用 16 位索引
+    vk::IndexType         index_type{vk::IndexType::eUint32};
+    std::vector<uint16_t> indices16;
+    std::vector<uint32_t> indices32;
+
+    float bounds_min[3]{};
+    float bounds_max[3]{};
+
+    /// 位置量化带来的最大误差（网格空间）
+    float max_position_error{0.0f};
+
+    const void* get_index_data() const;
+
+    uint32_t get_index_count() const;
+
+    uint32_t get_index_size() const;
+
+    /**
+     * @brief 把 unorm 位置还原到网格空间的列主序矩阵，可直接并入模型矩阵
+     */
+    std::array<float, 16> get_dequantization_matrix() const;
+};
+
+/**
+ * @brief 量化顶点并在可能时把索引压缩为 16 位
+ */
+QuantizedMesh quantize_mesh(const MeshView& mesh);
+
+uint16_t float_to_half(float value);
+
+float half_to_float(uint16_t value);
+
+/**
+ * @brief 顶点缓存模拟结果
+ *        acmr: 每三角形变换的顶点数（理想值 0.5，最差 3）
+ *        atvr: 每个被引用顶点的平均变换次数（理想值 1）
+ *        overfetch: 从顶点缓冲读取的字节数 / 顶点数据总字节数（理想值 1）
+ */
+struct VertexCacheStatistics
+{
+    uint32_t vertices_transformed{0};
+    uint32_t bytes_fetched{0};
+
+    float acmr{0.0f};
+    float atvr{0.0f};
+    float overfetch{0.0f};
+};
+
+/**
+ * @brief 以 FIFO 变换后缓存与 64 字节缓存行模拟索引序列的顶点处理开销
+ */
+VertexCacheStatistics analyze_vertex_cache(const uint32_t* indices, size_t index_count, size_t vertex_count,
+                                           size_t vertex_size, uint32_t cache_size = 16);
+
+/**
+ * @brief Forsyth 线性速度顶点缓存优化，按变换后缓存命中重排三角形
+ *        destination 与 indices 不可重叠
+ */
+void optimize_vertex_cache(uint32_t* destination, const uint32_t* indices, size_t index_count, size_t vertex_count);
+
+/**
+ * @brief Tipsify 风格 overdraw 优化：在缓存优化后的序列上切分簇，按簇朝外程度排序，
+ *        使外侧面先绘制以便 early-z 剔除内部片元
+ *        threshold 为允许的簇内 ACMR 相对退化比例；destination 与 indices 不可重叠
+ */
+void optimize_overdraw(uint32_t* destination, const uint32_t* indices, size_t index_count, const float* positions,
+                       size_t vertex_count, size_t position_stride, float threshold = 1.05f);
+
+/**
+ * @brief 按首次引用顺序重排顶点，提升顶点读取局部性；未引用的顶点被丢弃
+ *        索引原地重映射，返回新的顶点数。destination 与 vertices 不可重叠
+ */
+size_t optimize_vertex_fetch(void* destination, uint32_t* indices, size_t index_count, const void* vertices,
+                             size_t vertex_count, size_t vertex_size);
+
+struct MeshOptimizationReport
+{
+    VertexCacheStatistics before;
+    VertexCacheStatistics after;
+
+    size_t vertex_count_before{0};
+    size_t vertex_count_after{0};
+
+    double milliseconds{0.0};
+};
+
+/**
+ * @brief 导入期网格优化：顶点缓存 -> overdraw（threshold <= 0 时跳过）-> 顶点读取
+ */
+template<typename TVertex>
+MeshOptimizationReport optimize_mesh(std::vector<TVertex>& vertices, std::vector<uint32_t>& indices,
+                                     size_t position_offset, float overdraw_threshold = 1.05f)
+{
+    static_assert(std::is_trivially_copyable_v<TVertex>, "顶点重排按字节拷贝");
+
+    MeshOptimizationReport report;
+    report.vertex_count_before = vertices.size();
+    report.before = analyze_vertex_cache(indices.data(), indices.size(), vertices.size(), sizeof(TVertex));
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<uint32_t> reordered(indices.size());
+    optimize_vertex_cache(reordered.data(), indices.data(), indices.size(), vertices.size());
+
+    if (overdraw_threshold > 0.0f) {
+        const auto* positions = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(vertices.data())
+                                                               + position_offset);
+        optimize_overdraw(indices.data(), reordered.data(), indices.size(), positions, vertices.size(),
+                          sizeof(TVertex), overdraw_threshold);
+    } else {
+        indices.swap(reordered);
+    }
+
+    std::vector<TVertex> remapped(vertices.size());
+    size_t unique_count = optimize_vertex_fetch(remapped.data(), indices.data(), indices.size(), vertices.data(),
+                                                vertices.size(), sizeof(TVertex));
+    remapped.resize(unique_count);
+    vertices.swap(remapped);
+
+    report.milliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    report.vertex_count_after = vertices.size();
+    report.after = analyze_vertex_cache(indices.data(), indices.size(), vertices.size(), sizeof(TVertex));
+
+    return report;
+}
+
+/**
+ * @brief 一个 meshlet 在 MeshletMesh::vertices / triangles 中的区间
+ */
+struct Meshlet
+{
+    uint32_t vertex_offset{0};
+    uint32_t triangle_offset{0};        // 以字节为单位，每个三角形 3 个局部索引
+    uint32_t vertex_count{0};
+    uint32_t triangle_count{0};
+};
+
+/**
+ * @brief meshlet 的包围球与法线锥（网格空间）
+ *        满足 dot(center - camera, cone_axis) >= cone_cutoff * |center - camera| + radius 时整个 meshlet 背向相机；
+ *        法线过于分散时 cone_cutoff 为 1，此时该测试永不成立
+ */
+struct MeshletBounds
+{
+    float center[3]{};
+    float radius{0.0f};
+    float cone_axis[3]{};
+    float cone_cutoff{1.0f};
+};
+
+struct MeshletMesh
+{
+    std::vector<Meshlet>       meshlets;
+    std::vector<MeshletBounds> bounds;
+    std::vector<uint32_t>      vertices;         // 原网格中的顶点下标
+    std::vector<uint8_t>       triangles;        // meshlet 内的局部顶点下标
+};
+
+/**
+ * @brief 按索引顺序贪心划分 meshlet，输入最好先经过 optimize_vertex_cache 以获得紧凑的簇
+ */
+MeshletMesh build_meshlets(const uint32_t* indices, size_t index_count, const float* positions, size_t vertex_count,
+                           size_t position_stride, uint32_t max_vertices = 64, uint32_t max_triangles = 124);
+
+/**
+ * @brief 基于二次误差度量（QEM）的边折叠简化，只重写索引，不产生新顶点
+ *        边界与纹理接缝上的顶点保持不动；destination 可以与 indices 相同
+ * @param target_error 允许的最大误差（网格空间距离）
+ * @param result_error 输出实际产生的最大误差（网格空间距离）
+ * @return 简化后的索引数
+ */
+size_t simplify_mesh(uint32_t* destination, const uint32_t* indices, size_t index_count, const float* positions,
+                     size_t vertex_count, size_t position_stride, size_t target_index_count, float target_error,
+                     float* result_error = nullptr);
+
+/**
+ * @brief 一级 LOD 在 LodChain::indices 中的区间，error 为相对原网格的误差上界（网格空间距离）
+ */
+struct MeshLod
+{
+    uint32_t first_index{0};
+    uint32_t index_count{0};
+    float    error{0.0f};
+};
+
+/**
+ * @brief 各级 LOD 的索引首尾相接存放，共用同一份顶点，绘制时只需改变 firstIndex / indexCount
+ */
+struct LodChain
+{
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod>  lods;
+};
+
+/**
+ * @brief 逐级简化生成 LOD 链，每级目标索引数为上一级的 reduction 倍，简化幅度不足 10% 时停止
+ * @param max_error 每级允许的最大误差，相对于网格包围盒对角线长度
+ */
+LodChain build_lod_chain(const uint32_t* indices, size_t index_count, const float* positions, size_t vertex_count,
+                         size_t position_stride, uint32_t max_lods = 5, float reduction = 0.5f,
+                         float max_error = 0.02f);
+
+/**
+ * @brief 按投影到屏幕的误差选择 LOD：返回误差不超过 max_pixel_error 的最粗一级
+ * @param distance 相机到物体的距离（网格空间单位）
+ * @param projection_scale 距离 1 处一个单位对应的像素数，即 proj[1][1] * viewport_height / 2
+ */
+uint32_t select_lod(const std::vector<MeshLod>& lods, float distance, float projection_scale,
+                    float max_pixel_error = 1.0f);
+
+/**
+ * @brief 网格优化基准：打乱三角形顺序的网格在各阶段后的 ACMR / ATVR / overfetch 与耗时
+ */
+void run_mesh_optimizer_benchmark(uint32_t grid_size = 512);
@@ -0,0 +1,344 @@
+﻿/**
+ * @File MeshletRenderer.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "MeshletRenderer.hpp"
+#include "Buffer.hpp"
+#include "DescriptorPool.hpp"
+#include "DescriptorSet.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+#include "FrustumCuller.hpp"
+#include "MeshOptimizer.hpp"
+#include "Pipeline.hpp"
+#include "Profiler.hpp"
+#include "ShaderModule.hpp"
+
+#include <cstring>
+
+namespace {
+const char* MESHLET_CULL_SHADER_SOURCE = R"(
+#version 450
+
+layout(local_size_x = 128) in;
+
+struct Meshlet
+{
+    vec4 bounding_sphere;
+    vec4 cone;
+    uint vertex_offset;
+    uint first_index;
+    uint index_count;
+    uint padding;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Meshlets
+{
+    Meshlet meshlets[];
+};
+
+// arena 中的局部索引，16 位索引按两个一组打包读取
+layout(std430, set = 0, binding = 1) readonly buffer SourceIndices
+{
+    uint source_indices[];
+};
+
+layout(std430, set = 0, binding = 2) writeonly buffer OutputIndices
+{
+    uint output_indices[];
+};
+
+layout(std430, set = 0, binding = 3) buffer DrawCommand
+{
+    uint index_count;
+    uint instance_count;
+    uint first_index;
+    int  vertex_offset;
+    uint first_instance;
+} draw;
+
+layout(push_constant) uniform CullParams
+{
+    vec4 planes[6];
+    vec4 camera_position;
+    uint meshlet_count;
+    uint index_16bit;
+    uint first_index;
+    uint padding;
+} params;
+
+shared uint output_base;
+shared uint visible;
+
+uint load_index(uint i)
+{
+    if (params.index_16bit != 0u) {
+        uint word = source_indices[i >> 1];
+        return (i & 1u) != 0u ? (word >> 16) : (word & 0xFFFFu);
+    }
+    return source_indices[i];
+}
+
+void main()
+{
+    // 超出 x 维上限时分散到 y 维，同一工作组内的 id 一致
+    uint id = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    if (id >= params.meshlet_count) {
+        return;
+    }
+
+    Meshlet meshlet = meshlets[id];
+
+    if (gl_LocalInvocationIndex == 0u) {
+        vec3  center = meshlet.bounding_sphere.xyz;
+        float radius = meshlet.bounding_sphere.w;
+
+        bool in_frustum = true;
+        for (int i = 0; i < 6; ++i) {
+            in_frustum = in_frustum && (dot(params.planes[i].xyz, center) + params.planes[i].w > -radius);
+        }
+
+        vec3 to_center = center - params.camera_position.xyz;
+        bool backface  = dot(to_center, meshlet.cone.xyz) >= meshlet.cone.w * length(to_center) + radius;
+
+        visible = (in_frustum && !backface) ? 1u : 0u;
+        if (visible != 0u) {
+            output_base = atomicAdd(draw.index_count, meshlet.index_count);
+        }
+    }
+
+    barrier();
+
+    if (visible == 0u) {
+        return;
+    }
+
+    for (uint i = gl_LocalInvocationIndex; i < meshlet.index_count; i += gl_WorkGroupSize.x) {
+        output_indices[output_base + i] = meshlet.vertex_offset + load_index(params.first_index + meshlet.first_index + i);
+    }
+}
+)";
+
+struct CullParams
+{
+    glm::vec4 planes[6];
+    glm::vec4 camera_position;
+    uint32_t  meshlet_count;
+    uint32_t  index_16bit;
+    uint32_t  first_index;
+    uint32_t  padding;
+};
+
+constexpr uint32_t MAX_WORKGROUPS_X = 65535;
+}        // namespace
+
+vk_meshlet_renderer::vk_meshlet_renderer(vk_device& device, uint32_t frames_in_flight) :
+    device{device},
+    frames(frames_in_flight)
+{
+    ShaderSource source;
+    source.set_source(MESHLET_CULL_SHADER_SOURCE);
+    shader_module = std::make_unique<ShaderModule>(device, VK_SHADER_STAGE_COMPUTE_BIT, source, "main",
+                                                   ShaderVariant{});
+
+    // 描述符集布局与推送常量范围都来自着色器反射
+    pipeline_layout = &device.request_pipeline_layout({shader_module.get()});
+    descriptor_pool = std::make_unique<vk_descriptor_pool>(device, pipeline_layout->get_descriptor_set_layout(0));
+
+    pipeline = &device.request_compute_pipeline(*shader_module, *pipeline_layout);
+}
+
+vk_meshlet_renderer::~vk_meshlet_renderer()
+{
+    // 描述符集由池管理，先于池释放
+    frames.clear();
+}
+
+void vk_meshlet_renderer::set_mesh(vk_geometry_arena& arena_, const void* vertices, const MeshletMesh& mesh)
+{
+    PROFILE_SCOPE("vk_meshlet_renderer::set_mesh");
+
+    if (arena && range.valid()) {
+        arena->free(range);
+    }
+    arena = &arena_;
+
+    meshlet_count = static_cast<uint32_t>(mesh.meshlets.size());
+    if (meshlet_count == 0) {
+        meshlet_buffer.reset();
+        return;
+    }
+
+    // 按 meshlet 顺序展开顶点流，meshlet 边界上的顶点会重复
+    uint32_t stride = arena->get_vertex_stride();
+    auto     src    = static_cast<const uint8_t*>(vertices);
+
+    std::vector<uint8_t> vertex_stream(mesh.vertices.size() * stride);
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+        std::memcpy(vertex_stream.data() + i * stride, src + vk::DeviceSize{mesh.vertices[i]} * stride, stride);
+    }
+
+    bool                  index_16bit = arena->get_index_type() == vk::IndexType::eUint16;
+    std::vector<uint16_t> indices16;
+    std::vector<uint32_t> indices32;
+    if (index_16bit) {
+        indices16.assign(mesh.triangles.begin(), mesh.triangles.end());
+    } else {
+        indices32.assign(mesh.triangles.begin(), mesh.triangles.end());
+    }
+
+    auto index_count = static_cast<uint32_t>(mesh.triangles.size());
+    range = arena->allocate(vertex_stream.data(), static_cast<uint32_t>(mesh.vertices.size()),
+                            index_16bit ? static_cast<const void*>(indices16.data()) : indices32.data(), index_count);
+
+    std::vector<GpuMeshlet> meshlets(meshlet_count);
+    for (uint32_t i = 0; i < meshlet_count; ++i) {
+        const auto& meshlet = mesh.meshlets[i];
+        const auto& bounds  = mesh.bounds[i];
+
+        auto& gpu_meshlet           = meshlets[i];
+        gpu_meshlet.bounding_sphere = {bounds.center[0], bounds.center[1], bounds.center[2], bounds.radius};
+        gpu_meshlet.cone            = {bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2],
+                                       bounds.cone_cutoff};
+        gpu_meshlet.vertex_offset   = meshlet.vertex_offset;
+        gpu_meshlet.first_index     = meshlet.triangle_offset;
+        gpu_meshlet.index_count     = meshlet.triangle_count * 3;
+    }
+
+    meshlet_buffer = device.createBuffer(meshlets, vk::BufferUsageFlagBits::eStorageBuffer,
+                                         vk::MemoryPropertyFlagBits::eDeviceLocal, MemoryCategory::Mesh);
+    if (!meshlet_buffer) {
+        throw MemoryBudgetExceeded{"上传 meshlet 数据失败: 网格类别超出预算"};
+    }
+
+    vk::DeviceSize index_size = vk::DeviceSize{index_count} * sizeof(uint32_t);
+
+    for (auto& frame: frames) {
+        if (!frame.index_buffer || frame.index_buffer->get_size() < index_size) {
+            frame.index_buffer = device.createBuffer(index_size, nullptr,
+                                                     vk::BufferUsageFlagBits::eStorageBuffer
+                                                     | vk::BufferUsageFlagBits::eIndexBuffer,
+                                                     vk::MemoryPropertyFlagBits::eDeviceLocal, MemoryCategory::Mesh);
+        }
+        if (!frame.draw_buffer) {
+            frame.draw_buffer = device.createBuffer(sizeof(VkDrawIndexedIndirectCommand), nullptr,
+                                                    vk::BufferUsageFlagBits::eStorageBuffer
+                                                    | vk::BufferUsageFlagBits::eIndirectBuffer
+                                                    | vk::BufferUsageFlagBits::eTransferDst);
+        }
+        if (!frame.index_buffer || !frame.draw_buffer) {
+            throw MemoryBudgetExceeded{"创建 meshlet 输出缓冲区失败: 超出预算"};
+        }
+    }
+
+    update_descriptor_sets();
+
+    LOGI("meshlet: {} 个, 顶点流 {} (平均 {:.1f}/meshlet), 三角形 {}", meshlet_count, mesh.vertices.size(),
+         static_cast<float>(mesh.vertices.size()) / meshlet_count, index_count / 3);
+}
+
+void vk_meshlet_renderer::record_cull(VkCommandBuffer command_buffer, uint32_t frame_index,
+                                      const glm::mat4& view_proj, const glm::vec3& camera_position)
+{
+    if (meshlet_count == 0) {
+        return;
+    }
+
+    PROFILE_SCOPE("vk_meshlet_renderer::record_cull");
+
+    assert(frame_index < frames.size());
+    auto& frame = frames[frame_index];
+
+    // 重置间接命令：索引数由着色器累加，顶点偏移为网格区间在 arena 中的位置
+    VkDrawIndexedIndirectCommand reset{0, 1, 0, range.vertex_offset, 0};
+    vkCmdUpdateBuffer(command_buffer, frame.draw_buffer->handle(), 0, sizeof(reset), &reset);
+
+    VkMemoryBarrier clear_barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    clear_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clear_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         1, &clear_barrier, 0, nullptr, 0, nullptr);
+
+    CullParams params{};
+    Frustum    frustum = Frustum::from_matrix(&view_proj[0][0]);
+    for (int i = 0; i < 6; ++i) {
+        params.planes[i] = {frustum.planes[i][0], frustum.planes[i][1], frustum.planes[i][2], frustum.planes[i][3]};
+    }
+    params.camera_position = glm::vec4(camera_position, 1.0f);
+    params.meshlet_count   = meshlet_count;
+    params.index_16bit     = arena->get_index_type() == vk::IndexType::eUint16 ? 1u : 0u;
+    params.first_index     = range.first_index;
+
+    VkDescriptorSet descriptor_set = frame.descriptor_set->get_handle();
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->handle());
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout->handle(), 0, 1,
+                            &descriptor_set, 0, nullptr);
+    vkCmdPushConstants(command_buffer, pipeline_layout->handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params),
+                       &params);
+
+    uint32_t groups_x = std::min(meshlet_count, MAX_WORKGROUPS_X);
+    uint32_t groups_y = (meshlet_count + groups_x - 1) / groups_x;
+    vkCmdDispatch(command_buffer, groups_x, groups_y, 1);
+
+    VkMemoryBarrier draw_barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    draw_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    draw_barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0,
+                         1, &draw_barrier, 0, nullptr, 0, nullptr);
+}
+
+void vk_meshlet_renderer::record_draw(VkCommandBuffer command_buffer, uint32_t frame_index) const
+{
+    if (meshlet_count == 0) {
+        return;
+    }
+
+    assert(frame_index < frames.size());
+    auto& frame = frames[frame_index];
+
+    VkBuffer     vertex_buffer = arena->get_vertex_buffer(range.page).handle();
+    VkDeviceSize offset        = 0;
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, &vertex_buffer, &offset);
+    vkCmdBindIndexBuffer(command_buffer, frame.index_buffer->handle(), 0, VK_INDEX_TYPE_UINT32);
+
+    vkCmdDrawIndexedIndirect(command_buffer, frame.draw_buffer->handle(), 0, 1,
+                             sizeof(VkDrawIndexedIndirectCommand));
+}
+
+void vk_meshlet_renderer::update_descriptor_sets()
+{
+    if (!meshlet_buffer) {
+        return;
+    }
+
+    for (auto& frame: frames) {
+        BindingMap<VkDescriptorBufferInfo> buffer_infos;
+        buffer_infos[0][0] = {meshlet_buffer->handle(), 0, VK_WHOLE_SIZE};
+        buffer_infos[1][0] = {arena->get_index_buffer(range.page).handle(), 0, VK_WHOLE_SIZE};
+        buffer_infos[2][0] = {frame.index_buffer->handle(), 0, VK_WHOLE_SIZE};
+        buffer_infos[3][0] = {frame.draw_buffer->handle(), 0, VK_WHOLE_SIZE};
+
+        if (!frame.descriptor_set) {
+            frame.descriptor_set = std::make_unique<vk_descriptor_set>(
+                device, pipeline_layout->get_descriptor_set_layout(0), *descriptor_pool, buffer_infos);
+        } else {
+            frame.descriptor_set->reset(buffer_infos);
+        }
+        frame.descriptor_set->update();
+    }
+}
+
+uint32_t vk_meshlet_renderer::get_meshlet_count() const
+{
+    return meshlet_count;
+}
+
+const GeometryRange& vk_meshlet_renderer::get_range() const
+{
+    return range;
+}
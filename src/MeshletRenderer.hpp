@@ -0,0 +1,116 @@
+﻿/**
+ * @File MeshletRenderer.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 基于 meshlet 的 GPU 剔除渲染路径
+ */
+
+#pragma once
+
+#include "VkCommon.hpp"
+#include "GeometryArena.hpp"
+
+#include <glm/glm.hpp>
+
+struct MeshletMesh;
+
+class vk_device;
+class vk_buffer;
+class vk_pipeline_layout;
+class vk_descriptor_pool;
+class vk_descriptor_set;
+class vk_compute_pipeline;
+class ShaderModule;
+
+/**
+ * @brief 单个 meshlet 的剔除输入，与计算着色器中的 Meshlet 结构一致（std430）
+ */
+struct GpuMeshlet
+{
+    glm::vec4 bounding_sphere{0.0f};        // 网格空间，xyz 为球心，w 为半径
+    glm::vec4 cone{0.0f};                   // xyz 为法线锥轴，w 为 cutoff
+    uint32_t  vertex_offset{0};             // 相对网格区间的顶点偏移
+    uint32_t  first_index{0};               // 相对网格区间的索引偏移
+    uint32_t  index_count{0};
+    uint32_t  padding{0};
+};
+
+/**
+ * @brief meshlet 剔除渲染：meshlet 的顶点流与局部索引存放于几何体 arena，
+ *        每帧由计算着色器（每个工作组处理一个 meshlet）做视锥与法线锥剔除，
+ *        把可见 meshlet 的三角形写入每帧的输出索引缓冲区，最后以一次 vkCmdDrawIndexedIndirect 绘制
+ *
+ * arena 中的索引是 meshlet 内的局部下标，因此即使网格顶点很多也能使用 16 位索引，
+ * 输出索引为 32 位，已加上 meshlet 的顶点偏移。
+ * 未使用 VK_EXT_mesh_shader，任务/网格着色器路径可以复用同一份 meshlet 数据。
+ */
+class vk_meshlet_renderer
+{
+public:
+    static constexpr uint32_t WORKGROUP_SIZE = 128;
+
+    vk_meshlet_renderer(vk_device& device, uint32_t frames_in_flight);
+
+    ~vk_meshlet_renderer();
+
+    vk_meshlet_renderer(const vk_meshlet_renderer&) = delete;
+    vk_meshlet_renderer(vk_meshlet_renderer&&) = delete;
+
+    vk_meshlet_renderer& operator=(const vk_meshlet_renderer&) = delete;
+    vk_meshlet_renderer& operator=(vk_meshlet_renderer&&) = delete;
+
+    /**
+     * @brief 把 meshlet 的顶点流与局部索引写入 arena 并上传 meshlet 描述
+     *        vertices 的步长须与 arena 一致；写入的数据在 arena.flush() 之后可用，调用方需保证 GPU 已不再使用旧数据
+     */
+    void set_mesh(vk_geometry_arena& arena, const void* vertices, const MeshletMesh& mesh);
+
+    /**
+     * @brief 记录剔除（必须在渲染通道之外）
+     * @param view_proj 网格空间到裁剪空间的矩阵
+     * @param camera_position 网格空间中的相机位置，用于法线锥剔除
+     */
+    void record_cull(VkCommandBuffer command_buffer, uint32_t frame_index, const glm::mat4& view_proj,
+                     const glm::vec3& camera_position);
+
+    /**
+     * @brief 绑定顶点与输出索引缓冲区并记录间接绘制，调用前需绑定好图形管线与描述符
+     */
+    void record_draw(VkCommandBuffer command_buffer, uint32_t frame_index) const;
+
+    /**
+     * @brief 缓冲区句柄改变（如碎片整理）后重写描述符集
+     */
+    void update_descriptor_sets();
+
+    uint32_t get_meshlet_count() const;
+
+    const GeometryRange& get_range() const;
+
+private:
+    struct FrameResources
+    {
+        std::unique_ptr<vk_buffer>         index_buffer;
+        std::unique_ptr<vk_buffer>         draw_buffer;
+        std::unique_ptr<vk_descriptor_set> descriptor_set;
+    };
+
+    vk_device& device;
+
+    vk_geometry_arena* arena{nullptr};
+
+    GeometryRange range;
+
+    std::unique_ptr<ShaderModule>             shader_module;
+    vk_pipeline_layout*                       pipeline_layout{nullptr};        // 由设备的布局缓存持有
+    std::unique_ptr<vk_descriptor_pool>       descriptor_pool;
+
+    // 由设备的管线缓存持有
+    vk_compute_pipeline* pipeline{nullptr};
+
+    std::unique_ptr<vk_buffer> meshlet_buffer;
+
+    uint32_t meshlet_count{0};
+
+    std::vector<FrameResources> frames;
+};
@@ -0,0 +1,420 @@
+﻿/**
+ * @File PerformanceQuery.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "PerformanceQuery.hpp"
+#include "Device.hpp"
+#include "PhysicalDevice.hpp"
+#include "Helpers.hpp"
+#include "Profiler.hpp"
+
+namespace {
+
+// pipeline statistics 的位顺序即结果数组的顺序
+// @formatter:off
+const std::vector<std::pair<VkQueryPipelineStatisticFlagBits, const char*>> PIPELINE_STATISTICS = {
+    {VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT,                    "Input assembly vertices"},
+    {VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT,                  "Input assembly primitives"},
+    {VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT,                  "Vertex shader invocations"},
+    {VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT,                       "Clipping invocations"},
+    {VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT,                        "Clipping primitives"},
+    {VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT,                "Fragment shader invocations"},
+    {VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT,                 "Compute shader invocations"},
+};
+// @formatter:on
+
+double to_double(const VkPerformanceCounterResultKHR& result, vk::PerformanceCounterStorageKHR storage)
+{
+    switch (storage) {
+        case vk::PerformanceCounterStorageKHR::eInt32:
+            return static_cast<double>(result.int32);
+        case vk::PerformanceCounterStorageKHR::eInt64:
+            return static_cast<double>(result.int64);
+        case vk::PerformanceCounterStorageKHR::eUint32:
+            return static_cast<double>(result.uint32);
+        case vk::PerformanceCounterStorageKHR::eUint64:
+            return static_cast<double>(result.uint64);
+        case vk::PerformanceCounterStorageKHR::eFloat32:
+            return static_cast<double>(result.float32);
+        case vk::PerformanceCounterStorageKHR::eFloat64:
+            return result.float64;
+        default:
+            return 0.0;
+    }
+}
+
+} // namespace
+
+std::vector<PerformanceCounterInfo>
+vk_counter_session::enumerate_counters(const vk_device& device, uint32_t queue_family_index)
+{
+    std::vector<PerformanceCounterInfo> result;
+
+    if (!device.is_enabled(VK_KHR_PERFORMANCE_QUERY_EXTENSION_NAME)) {
+        return result;
+    }
+
+    VkPhysicalDevice gpu = device.get_gpu().handle();
+
+    uint32_t count = 0;
+    VK_CHECK(vkEnumeratePhysicalDeviceQueueFamilyPerformanceQueryCountersKHR(gpu, queue_family_index, &count,
+                                                                              nullptr, nullptr));
+
+    std::vector<VkPerformanceCounterKHR>            counters(count, {VK_STRUCTURE_TYPE_PERFORMANCE_COUNTER_KHR});
+    std::vector<VkPerformanceCounterDescriptionKHR> descriptions(count,
+                                                                 {VK_STRUCTURE_TYPE_PERFORMANCE_COUNTER_DESCRIPTION_KHR});
+    VK_CHECK(vkEnumeratePhysicalDeviceQueueFamilyPerformanceQueryCountersKHR(gpu, queue_family_index, &count,
+                                                                              counters.data(), descriptions.data()));
+
+    result.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        PerformanceCounterInfo info;
+        info.index       = i;
+        info.name        = descriptions[i].name;
+        info.category    = descriptions[i].category;
+        info.description = descriptions[i].description;
+        info.unit        = static_cast<vk::PerformanceCounterUnitKHR>(counters[i].unit);
+        info.storage     = static_cast<vk::PerformanceCounterStorageKHR>(counters[i].storage);
+        info.scope       = static_cast<vk::PerformanceCounterScopeKHR>(counters[i].scope);
+        result.push_back(std::move(info));
+    }
+
+    return result;
+}
+
+vk_counter_session::vk_counter_session(vk_device& device, uint32_t queue_family_index,
+                                       const std::vector<std::string>& counter_names, uint32_t max_scopes) :
+    device{device},
+    queue_family_index{queue_family_index},
+    max_scopes{max_scopes}
+{
+    if (device.is_enabled(VK_KHR_PERFORMANCE_QUERY_EXTENSION_NAME)) {
+        create_performance_query_pool(counter_names);
+    }
+
+    if (mode == Mode::Unsupported && device.get_gpu().get_requested_features().pipelineStatisticsQuery) {
+        LOGI("VK_KHR_performance_query 不可用，使用 pipeline statistics 查询");
+        create_pipeline_statistics_pool();
+    }
+
+    if (mode == Mode::Unsupported) {
+        LOGW("设备既不支持性能查询也不支持 pipeline statistics 查询，计数器会话不可用");
+    }
+
+    scope_names.resize(max_scopes, nullptr);
+}
+
+vk_counter_session::~vk_counter_session()
+{
+    release_profiling_lock();
+
+    if (query_pool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device.handle(), query_pool, nullptr);
+    }
+}
+
+void vk_counter_session::create_performance_query_pool(const std::vector<std::string>& counter_names)
+{
+    auto available = enumerate_counters(device, queue_family_index);
+
+    for (auto& counter: available) {
+        bool selected = counter_names.empty()
+                        || std::find(counter_names.begin(), counter_names.end(), counter.name) != counter_names.end();
+        if (selected) {
+            counter_indices.push_back(counter.index);
+            counters.push_back(counter);
+        }
+    }
+
+    for (auto& name: counter_names) {
+        auto it = std::find_if(available.begin(), available.end(),
+                               [&name](const PerformanceCounterInfo& info) { return info.name == name; });
+        if (it == available.end()) {
+            LOGW("队列族 {} 上没有名为 \"{}\" 的性能计数器", queue_family_index, name);
+        }
+    }
+
+    if (counter_indices.empty()) {
+        counters.clear();
+        return;
+    }
+
+    VkQueryPoolPerformanceCreateInfoKHR perf_create_info{VK_STRUCTURE_TYPE_QUERY_POOL_PERFORMANCE_CREATE_INFO_KHR};
+    perf_create_info.queueFamilyIndex  = queue_family_index;
+    perf_create_info.counterIndexCount = to_u32(counter_indices.size());
+    perf_create_info.pCounterIndices   = counter_indices.data();
+
+    vkGetPhysicalDeviceQueueFamilyPerformanceQueryPassesKHR(device.get_gpu().handle(), &perf_create_info, &pass_count);
+    pass_count = std::max(pass_count, 1u);
+
+    VkQueryPoolCreateInfo pool_create_info{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    pool_create_info.pNext      = &perf_create_info;
+    pool_create_info.queryType  = VK_QUERY_TYPE_PERFORMANCE_QUERY_KHR;
+    pool_create_info.queryCount = max_scopes;
+
+    VkResult result = vkCreateQueryPool(device.handle(), &pool_create_info, nullptr, &query_pool);
+    if (result != VK_SUCCESS) {
+        LOGW("创建性能查询池失败: {}", vk::to_string(static_cast<vk::Result>(result)));
+        query_pool = VK_NULL_HANDLE;
+        counters.clear();
+        counter_indices.clear();
+        return;
+    }
+
+    mode = Mode::PerformanceQuery;
+    LOGI("性能计数器会话: 队列族 {}, {} 个计数器, 需要 {} 个 pass", queue_family_index, counters.size(), pass_count);
+}
+
+void vk_counter_session::create_pipeline_statistics_pool()
+{
+    VkQueryPipelineStatisticFlags statistics = 0;
+    for (auto& stat: PIPELINE_STATISTICS) {
+        statistics |= stat.first;
+
+        PerformanceCounterInfo info;
+        info.index   = to_u32(counters.size());
+        info.name    = stat.second;
+        info.unit    = vk::PerformanceCounterUnitKHR::eGeneric;
+        info.storage = vk::PerformanceCounterStorageKHR::eUint64;
+        counters.push_back(std::move(info));
+    }
+
+    VkQueryPoolCreateInfo pool_create_info{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    pool_create_info.queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    pool_create_info.queryCount         = max_scopes;
+    pool_create_info.pipelineStatistics = statistics;
+
+    VkResult result = vkCreateQueryPool(device.handle(), &pool_create_info, nullptr, &query_pool);
+    if (result != VK_SUCCESS) {
+        LOGW("创建 pipeline statistics 查询池失败: {}", vk::to_string(static_cast<vk::Result>(result)));
+        query_pool = VK_NULL_HANDLE;
+        counters.clear();
+        return;
+    }
+
+    pass_count = 1;
+    mode       = Mode::PipelineStatistics;
+}
+
+vk_counter_session::Mode vk_counter_session::get_mode() const
+{
+    return mode;
+}
+
+uint32_t vk_counter_session::get_pass_count() const
+{
+    return pass_count;
+}
+
+const std::vector<PerformanceCounterInfo>& vk_counter_session::get_counters() const
+{
+    return counters;
+}
+
+bool vk_counter_session::acquire_profiling_lock(uint64_t timeout_ns)
+{
+    if (mode != Mode::PerformanceQuery || profiling_lock_held) {
+        return true;
+    }
+
+    profiling_lock_held = device.acquire_profiling_lock(timeout_ns);
+    return profiling_lock_held;
+}
+
+void vk_counter_session::release_profiling_lock()
+{
+    if (profiling_lock_held) {
+        device.release_profiling_lock();
+        profiling_lock_held = false;
+    }
+}
+
+void vk_counter_session::reset(VkCommandBuffer cmd)
+{
+    used_queries = 0;
+
+    if (mode == Mode::PerformanceQuery) {
+        // 性能查询不能在包含其 begin 的同一个命令缓冲里重置，因此使用 host reset
+        vkResetQueryPoolEXT(device.handle(), query_pool, 0, max_scopes);
+    } else if (mode == Mode::PipelineStatistics) {
+        assert(cmd != VK_NULL_HANDLE && "Pipeline statistics queries must be reset in a command buffer");
+        vkCmdResetQueryPool(cmd, query_pool, 0, max_scopes);
+    }
+}
+
+void vk_counter_session::begin_scope(VkCommandBuffer cmd, const char* name)
+{
+    if (mode == Mode::Unsupported) {
+        return;
+    }
+
+    assert(!scope_active && "Counter scopes can't be nested");
+    assert((mode != Mode::PerformanceQuery || device.is_profiling_lock_held())
+           && "The profiling lock must be held before recording performance queries");
+
+    if (used_queries >= max_scopes) {
+        LOGW("计数器作用域 \"{}\" 超出上限 {}，忽略", name, max_scopes);
+        return;
+    }
+
+    scope_names[used_queries] = name;
+    vkCmdBeginQuery(cmd, query_pool, used_queries, 0);
+    scope_active = true;
+}
+
+void vk_counter_session::end_scope(VkCommandBuffer cmd)
+{
+    if (!scope_active) {
+        return;
+    }
+
+    vkCmdEndQuery(cmd, query_pool, used_queries);
+    ++used_queries;
+    scope_active = false;
+}
+
+void vk_counter_session::replay(const vk::Queue& queue, const std::function<void(VkCommandBuffer, uint32_t)>& record)
+{
+    if (mode == Mode::Unsupported) {
+        return;
+    }
+
+    PROFILE_SCOPE("vk_counter_session::replay");
+
+    bool own_lock = !profiling_lock_held;
+    if (!acquire_profiling_lock()) {
+        return;
+    }
+
+    VkDevice device_handle = device.handle();
+
+    VkCommandPoolCreateInfo pool_info{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    pool_info.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    pool_info.queueFamilyIndex = queue_family_index;
+
+    VkCommandPool command_pool{VK_NULL_HANDLE};
+    VK_CHECK(vkCreateCommandPool(device_handle, &pool_info, nullptr, &command_pool));
+
+    VkFenceCreateInfo fence_info{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+    VkFence           fence{VK_NULL_HANDLE};
+    VK_CHECK(vkCreateFence(device_handle, &fence_info, nullptr, &fence));
+
+    if (mode == Mode::PerformanceQuery) {
+        reset();
+    }
+
+    for (uint32_t pass = 0; pass < pass_count; ++pass) {
+        VkCommandBufferAllocateInfo alloc_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        alloc_info.commandPool        = command_pool;
+        alloc_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandBufferCount = 1;
+
+        VkCommandBuffer cmd{VK_NULL_HANDLE};
+        VK_CHECK(vkAllocateCommandBuffers(device_handle, &alloc_info, &cmd));
+
+        VkCommandBufferBeginInfo begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VK_CHECK(vkBeginCommandBuffer(cmd, &begin_info));
+
+        // 每个 pass 都从第 0 个查询开始录制，查询槽位在各 pass 间共享
+        if (mode == Mode::PipelineStatistics) {
+            reset(cmd);
+        }
+        used_queries = 0;
+
+        record(cmd, pass);
+
+        assert(!scope_active && "Counter scope left open at the end of a replay pass");
+        VK_CHECK(vkEndCommandBuffer(cmd));
+
+        VkPerformanceQuerySubmitInfoKHR perf_submit_info{VK_STRUCTURE_TYPE_PERFORMANCE_QUERY_SUBMIT_INFO_KHR};
+        perf_submit_info.counterPassIndex = pass;
+
+        VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        submit_info.pNext              = mode == Mode::PerformanceQuery ? &perf_submit_info : nullptr;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers    = &cmd;
+
+        VK_CHECK(vkQueueSubmit(queue, 1, &submit_info, fence));
+        VK_CHECK(vkWaitForFences(device_handle, 1, &fence, VK_TRUE, DEFAULT_FENCE_TIMEOUT));
+        VK_CHECK(vkResetFences(device_handle, 1, &fence));
+
+        vkFreeCommandBuffers(device_handle, command_pool, 1, &cmd);
+    }
+
+    vkDestroyFence(device_handle, fence, nullptr);
+    vkDestroyCommandPool(device_handle, command_pool, nullptr);
+
+    if (own_lock) {
+        release_profiling_lock();
+    }
+
+    resolve();
+}
+
+const std::vector<PerformanceCounterSample>& vk_counter_session::resolve()
+{
+    last_samples.clear();
+
+    if (mode == Mode::Unsupported || used_queries == 0) {
+        return last_samples;
+    }
+
+    PROFILE_SCOPE("vk_counter_session::resolve");
+
+    const size_t counter_count = counters.size();
+
+    if (mode == Mode::PerformanceQuery) {
+        std::vector<VkPerformanceCounterResultKHR> results(used_queries * counter_count);
+        const VkDeviceSize stride = sizeof(VkPerformanceCounterResultKHR) * counter_count;
+
+        VkResult result = vkGetQueryPoolResults(device.handle(), query_pool, 0, used_queries,
+                                                results.size() * sizeof(VkPerformanceCounterResultKHR),
+                                                results.data(), stride, VK_QUERY_RESULT_WAIT_BIT);
+        if (result != VK_SUCCESS) {
+            LOGW("读取性能计数器结果失败: {}", vk::to_string(static_cast<vk::Result>(result)));
+            return last_samples;
+        }
+
+        for (uint32_t q = 0; q < used_queries; ++q) {
+            for (size_t c = 0; c < counter_count; ++c) {
+                double value = to_double(results[q * counter_count + c], counters[c].storage);
+                last_samples.push_back({scope_names[q], counters[c].name, value});
+            }
+        }
+    } else {
+        std::vector<uint64_t> results(used_queries * counter_count);
+        const VkDeviceSize    stride = sizeof(uint64_t) * counter_count;
+
+        VkResult result = vkGetQueryPoolResults(device.handle(), query_pool, 0, used_queries,
+                                                results.size() * sizeof(uint64_t), results.data(), stride,
+                                                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+        if (result != VK_SUCCESS) {
+            LOGW("读取 pipeline statistics 结果失败: {}", vk::to_string(static_cast<vk::Result>(result)));
+            return last_samples;
+        }
+
+        for (uint32_t q = 0; q < used_queries; ++q) {
+            for (size_t c = 0; c < counter_count; ++c) {
+                last_samples.push_back({scope_names[q], counters[c].name,
+                                        static_cast<double>(results[q * counter_count + c])});
+            }
+        }
+    }
+
+    auto& profiler = FrameProfiler::get();
+    for (auto& sample: last_samples) {
+        profiler.record_counter(sample.scope, sample.counter, sample.value);
+    }
+
+    used_queries = 0;
+    return last_samples;
+}
+
+const std::vector<PerformanceCounterSample>& vk_counter_session::get_last_samples() const
+{
+    return last_samples;
+}
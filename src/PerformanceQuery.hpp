@@ -0,0 +1,166 @@
+﻿/**
+ * @File PerformanceQuery.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 硬件/驱动计数器采集：VK_KHR_performance_query，缺失时退化为 pipeline statistics 查询
+ */
+
+#pragma once
+
+#include "VkCommon.hpp"
+
+#include <functional>
+
+class vk_device;
+
+struct PerformanceCounterInfo
+{
+    uint32_t                        index{0};
+    std::string                     name;
+    std::string                     category;
+    std::string                     description;
+    vk::PerformanceCounterUnitKHR   unit{vk::PerformanceCounterUnitKHR::eGeneric};
+    vk::PerformanceCounterStorageKHR storage{vk::PerformanceCounterStorageKHR::eUint64};
+    vk::PerformanceCounterScopeKHR  scope{vk::PerformanceCounterScopeKHR::eCommandBuffer};
+};
+
+struct PerformanceCounterSample
+{
+    const char* scope{nullptr};
+    std::string counter;
+    double      value{0.0};
+};
+
+/**
+ * @brief 一次计数器会话，负责查询池、profiling lock 以及多 pass 重放
+ *
+ * 用法：
+ *  - 单 pass（get_pass_count() == 1）：每帧 reset(cmd) -> begin_scope/end_scope -> 等待 fence 后 resolve()
+ *  - 多 pass：replay(queue, record)，record 会被调用 get_pass_count() 次，每次都必须录制相同的作用域
+ *
+ * 作用域名称应与 PROFILE_SCOPE 使用的名称一致，resolve() 会将结果挂到 FrameProfiler 的同名作用域上。
+ * 同一个命令缓冲中作用域不可嵌套。
+ */
+class vk_counter_session
+{
+public:
+    enum class Mode
+    {
+        PerformanceQuery,
+        PipelineStatistics,
+        Unsupported,
+    };
+
+    /**
+     * @brief 枚举某个队列族上可用的性能计数器，扩展未开启时返回空
+     */
+    static std::vector<PerformanceCounterInfo> enumerate_counters(const vk_device& device, uint32_t queue_family_index);
+
+    /**
+     * @param counter_names 需要采集的计数器名称，为空时采集该队列族的全部计数器
+     * @param max_scopes 每帧（每次重放）最多的作用域数量
+     */
+    vk_counter_session(vk_device& device, uint32_t queue_family_index,
+                       const std::vector<std::string>& counter_names = {}, uint32_t max_scopes = 32);
+
+    ~vk_counter_session();
+
+    vk_counter_session(const vk_counter_session&) = delete;
+    vk_counter_session(vk_counter_session&&) = delete;
+    vk_counter_session& operator=(const vk_counter_session&) = delete;
+    vk_counter_session& operator=(vk_counter_session&&) = delete;
+
+    Mode get_mode() const;
+
+    uint32_t get_pass_count() const;
+
+    const std::vector<PerformanceCounterInfo>& get_counters() const;
+
+    /**
+     * @brief 录制任何包含性能查询的命令缓冲之前必须持有 profiling lock。
+     *        锁由 vk_device 引用计数，多个会话共享同一把锁，会话只持有其中一份引用
+     */
+    bool acquire_profiling_lock(uint64_t timeout_ns = UINT64_MAX);
+
+    void release_profiling_lock();
+
+    /**
+     * @brief 重置查询池；性能查询使用 host reset，pipeline statistics 需要在 cmd 中重置（必须位于 render pass 外）
+     */
+    void reset(VkCommandBuffer cmd = VK_NULL_HANDLE);
+
+    void begin_scope(VkCommandBuffer cmd, const char* name);
+
+    void end_scope(VkCommandBuffer cmd);
+
+    /**
+     * @brief 在 queue 上按需多次录制并提交同一段工作，每次使用不同的 counter pass，完成后自动 resolve()
+     */
+    void replay(const vk::Queue& queue, const std::function<void(VkCommandBuffer, uint32_t)>& record);
+
+    /**
+     * @brief 读回结果（会等待查询可用），并写入 FrameProfiler
+     */
+    const std::vector<PerformanceCounterSample>& resolve();
+
+    const std::vector<PerformanceCounterSample>& get_last_samples() const;
+
+private:
+    void create_performance_query_pool(const std::vector<std::string>& counter_names);
+
+    void create_pipeline_statistics_pool();
+
+    vk_device& device;
+
+    uint32_t queue_family_index{0};
+
+    Mode mode{Mode::Unsupported};
+
+    VkQueryPool query_pool{VK_NULL_HANDLE};
+
+    uint32_t max_scopes{0};
+
+    uint32_t pass_count{1};
+
+    std::vector<PerformanceCounterInfo> counters;
+
+    std::vector<uint32_t> counter_indices;
+
+    std::vector<const char*> scope_names;
+
+    uint32_t used_queries{0};
+
+    bool scope_active{false};
+
+    bool profiling_lock_held{false};        // 是否持有设备 profiling lock 的一份引用
+
+    std::vector<PerformanceCounterSample> last_samples;
+};
+
+/**
+ * @brief RAII 版本的 begin_scope/end_scope
+ */
+class vk_counter_scope
+{
+public:
+    vk_counter_scope(vk_counter_session& session, VkCommandBuffer cmd, const char* name) :
+        session{session},
+        cmd{cmd}
+    {
+        session.begin_scope(cmd, name);
+    }
+
+    ~vk_counter_scope()
+    {
+        session.end_scope(cmd);
+    }
+
+    vk_counter_scope(const vk_counter_scope&) = delete;
+    vk_counter_scope(vk_counter_scope&&) = delete;
+    vk_counter_scope& operator=(const vk_counter_scope&) = delete;
+    vk_counter_scope& operator=(vk_counter_scope&&) = delete;
+
+private:
+    vk_counter_session& session;
+    VkCommandBuffer     cmd;
+};
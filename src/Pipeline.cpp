@@ -0,0 +1,276 @@
+﻿/**
+ * @File Pipeline.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "Pipeline.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+#include "ShaderModule.hpp"
+
+#include <tuple>
+
+void vk_pipeline_layout::merge_shader_resources(const std::vector<ShaderModule*>& shader_modules,
+                                                std::vector<ShaderResource>& resources,
+                                                std::vector<vk::PushConstantRange>& push_constant_ranges)
+{
+    for (auto* shader_module: shader_modules) {
+        for (const auto& shader_resource: shader_module->get_resources()) {
+            if (shader_resource.type == ShaderResourceType::PushConstant) {
+                // 每个阶段只有一个推送常量块，偏移与大小相同的阶段共用一个范围
+                auto stage = static_cast<vk::ShaderStageFlags>(canonicalize_stage_flags(shader_resource.stages));
+                auto it    = std::find_if(push_constant_ranges.begin(), push_constant_ranges.end(),
+                                          [&shader_resource](const vk::PushConstantRange& range) {
+                                              return range.offset == shader_resource.offset &&
+                                                     range.size == shader_resource.size;
+                                          });
+                if (it != push_constant_ranges.end()) {
+                    it->stageFlags |= stage;
+                } else {
+                    push_constant_ranges.emplace_back(stage, shader_resource.offset, shader_resource.size);
+                }
+                continue;
+            }
+
+            // 输入输出只在各自阶段有意义，不跨阶段合并
+            bool per_stage = shader_resource.type == ShaderResourceType::Input ||
+                             shader_resource.type == ShaderResourceType::Output;
+
+            auto it = std::find_if(resources.begin(), resources.end(),
+                                   [&shader_resource, per_stage](const ShaderResource& resource) {
+                                       return resource.type == shader_resource.type &&
+                                              resource.name == shader_resource.name &&
+                                              (!per_stage || resource.stages == shader_resource.stages);
+                                   });
+            if (it != resources.end()) {
+                it->stages |= shader_resource.stages;
+            } else {
+                resources.push_back(shader_resource);
+            }
+        }
+    }
+
+    // 键与创建顺序无关
+    std::sort(push_constant_ranges.begin(), push_constant_ranges.end(),
+              [](const vk::PushConstantRange& lhs, const vk::PushConstantRange& rhs) {
+                  return std::tie(lhs.offset, lhs.size) < std::tie(rhs.offset, rhs.size);
+              });
+}
+
+vk_pipeline_layout::vk_pipeline_layout(vk_device& device,
+                                       std::vector<ShaderResource>&& resources,
+                                       std::vector<vk_descriptor_set_layout*>&& descriptor_set_layouts,
+                                       std::vector<vk::PushConstantRange>&& push_constant_ranges) :
+    vk_unit{nullptr, &device},
+    resources{std::move(resources)},
+    descriptor_set_layouts{std::move(descriptor_set_layouts)},
+    push_constant_ranges{std::move(push_constant_ranges)}
+{
+    std::vector<VkDescriptorSetLayout> set_layout_handles;
+    for (auto* descriptor_set_layout: this->descriptor_set_layouts) {
+        set_layout_handles.push_back(descriptor_set_layout->get_handle());
+    }
+
+    VkPipelineLayoutCreateInfo create_info{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+    create_info.setLayoutCount         = to_u32(set_layout_handles.size());
+    create_info.pSetLayouts            = set_layout_handles.data();
+    create_info.pushConstantRangeCount = to_u32(this->push_constant_ranges.size());
+    create_info.pPushConstantRanges    = reinterpret_cast<const VkPushConstantRange*>(this->push_constant_ranges.data());
+
+    VkPipelineLayout pipeline_layout{VK_NULL_HANDLE};
+    auto result = vkCreatePipelineLayout(device.handle(), &create_info, nullptr, &pipeline_layout);
+    if (result != VK_SUCCESS) {
+        throw VulkanException{vk::Result(result), "创建管线布局失败"};
+    }
+
+    set_handle(pipeline_layout);
+}
+
+vk_pipeline_layout::~vk_pipeline_layout()
+{
+    if (handle()) {
+        device().handle().destroyPipelineLayout(handle());
+    }
+}
+
+const std::vector<ShaderResource>& vk_pipeline_layout::get_resources() const
+{
+    return resources;
+}
+
+bool vk_pipeline_layout::has_descriptor_set_layout(uint32_t set_index) const
+{
+    return set_index < descriptor_set_layouts.size();
+}
+
+vk_descriptor_set_layout& vk_pipeline_layout::get_descriptor_set_layout(uint32_t set_index) const
+{
+    if (!has_descriptor_set_layout(set_index)) {
+        throw std::runtime_error("管线布局中没有 set " + std::to_string(set_index));
+    }
+
+    return *descriptor_set_layouts[set_index];
+}
+
+const std::vector<vk::PushConstantRange>& vk_pipeline_layout::get_push_constant_ranges() const
+{
+    return push_constant_ranges;
+}
+
+vk::ShaderStageFlags vk_pipeline_layout::get_push_constant_range_stage(uint32_t size, uint32_t offset) const
+{
+    vk::ShaderStageFlags stages;
+
+    for (const auto& range: push_constant_ranges) {
+        bool overlaps = offset < range.offset + range.size && range.offset < offset + size;
+        if (!overlaps) {
+            continue;
+        }
+
+        bool contains = range.offset <= offset && offset + size <= range.offset + range.size;
+        if (!contains) {
+            return {};
+        }
+
+        stages |= range.stageFlags;
+    }
+
+    return stages;
+}
+
+void SpecializationConstantState::reset()
+{
+    specialization_constant_state.clear();
+}
+
+void SpecializationConstantState::set_constant(uint32_t constant_id, const std::vector<uint8_t>& data)
+{
+    specialization_constant_state[constant_id] = data;
+}
+
+void SpecializationConstantState::set_specialization_constant_state(
+    const std::map<uint32_t, std::vector<uint8_t>>& state)
+{
+    specialization_constant_state = state;
+}
+
+const std::map<uint32_t, std::vector<uint8_t>>& SpecializationConstantState::get_specialization_constant_state() const
+{
+    return specialization_constant_state;
+}
+
+namespace {
+vk::Pipeline create_compute_pipeline(vk_device& device,
+                                     const ShaderModule& shader_module,
+                                     vk::PipelineLayout pipeline_layout,
+                                     const VkSpecializationInfo* specialization_info,
+                                     vk::PipelineCache pipeline_cache)
+{
+    assert(shader_module.get_stage() == VK_SHADER_STAGE_COMPUTE_BIT && "计算管线需要计算着色器");
+
+    // 着色器模块只在创建管线时使用
+    vk::ShaderModuleCreateInfo module_create_info({}, shader_module.get_binary());
+    vk::ShaderModule           module = device.handle().createShaderModule(module_create_info);
+
+    vk::PipelineShaderStageCreateInfo stage_create_info({}, vk::ShaderStageFlagBits::eCompute, module,
+                                                        shader_module.get_entry_point().c_str(),
+                                                        reinterpret_cast<const vk::SpecializationInfo*>(
+                                                            specialization_info));
+
+    vk::ComputePipelineCreateInfo create_info({}, stage_create_info, pipeline_layout);
+
+    auto result = device.handle().createComputePipeline(pipeline_cache, create_info);
+
+    device.handle().destroyShaderModule(module);
+
+    if (result.result != vk::Result::eSuccess) {
+        throw VulkanException{result.result, "创建计算管线失败"};
+    }
+
+    return result.value;
+}
+}        // namespace
+
+vk_compute_pipeline::vk_compute_pipeline(vk_device& device,
+                                         const ShaderModule& shader_module,
+                                         vk::PipelineLayout pipeline_layout,
+                                         vk::PipelineCache pipeline_cache) :
+    vk_unit{nullptr, &device}, pipeline_layout{pipeline_layout}
+{
+    set_handle(create_compute_pipeline(device, shader_module, pipeline_layout, nullptr, pipeline_cache));
+}
+
+vk_compute_pipeline::vk_compute_pipeline(vk_device& device,
+                                         const ShaderModule& shader_module,
+                                         const vk_pipeline_layout& pipeline_layout,
+                                         const SpecializationConstantState& specialization_constant_state,
+                                         vk::PipelineCache pipeline_cache) :
+    vk_unit{nullptr, &device}, pipeline_layout{pipeline_layout.handle()}
+{
+    std::vector<VkSpecializationMapEntry> entries;
+    std::vector<uint8_t>                  data;
+
+    auto specialization_info = make_specialization_info(shader_module, specialization_constant_state, entries, data);
+
+    set_handle(create_compute_pipeline(device, shader_module, this->pipeline_layout,
+                                       entries.empty() ? nullptr : &specialization_info, pipeline_cache));
+}
+
+vk_compute_pipeline::vk_compute_pipeline(vk_compute_pipeline&& other) :
+    vk_unit{std::move(other)},
+    pipeline_layout{std::exchange(other.pipeline_layout, {})}
+{
+}
+
+vk_compute_pipeline::~vk_compute_pipeline()
+{
+    if (handle()) {
+        device().handle().destroyPipeline(handle());
+    }
+}
+
+vk::PipelineLayout vk_compute_pipeline::get_layout() const
+{
+    return pipeline_layout;
+}
+
+VkSpecializationInfo vk_compute_pipeline::make_specialization_info(const ShaderModule& shader_module,
+                                                                   const SpecializationConstantState& state,
+                                                                   std::vector<VkSpecializationMapEntry>& entries,
+                                                                   std::vector<uint8_t>& data)
+{
+    entries.clear();
+    data.clear();
+
+    const auto& resources = shader_module.get_resources();
+
+    for (const auto& [constant_id, bytes]: state.get_specialization_constant_state()) {
+        auto it = std::find_if(resources.begin(), resources.end(),
+                               [constant_id = constant_id](const ShaderResource& resource) {
+                                   return resource.type == ShaderResourceType::SpecializationConstant &&
+                                          resource.constant_id == constant_id;
+                               });
+        if (it == resources.end()) {
+            // 未被着色器声明的常量不影响该阶段
+            continue;
+        }
+
+        if (bytes.size() != it->size) {
+            throw std::runtime_error(fmt::format("特化常量 {} (id {}) 的大小为 {} 字节，着色器需要 {} 字节",
+                                                 it->name, constant_id, bytes.size(), it->size));
+        }
+
+        entries.push_back({constant_id, to_u32(data.size()), bytes.size()});
+        data.insert(data.end(), bytes.begin(), bytes.end());
+    }
+
+    VkSpecializationInfo specialization_info{};
+    specialization_info.mapEntryCount = to_u32(entries.size());
+    specialization_info.pMapEntries   = entries.data();
+    specialization_info.dataSize      = data.size();
+    specialization_info.pData         = data.data();
+
+    return specialization_info;
+}
@@ -0,0 +1,150 @@
+﻿/**
+ * @File Pipeline.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#pragma once
+
+#include "VkCommon.hpp"
+#include "VkUnit.hpp"
+
+#include <cstring>
+
+class ShaderModule;
+class vk_descriptor_set_layout;
+struct ShaderResource;
+
+/**
+ * @brief 由着色器反射生成的管线布局：同名资源合并各阶段的 stage 标志，
+ *        按 set 创建描述符集布局，推送常量范围按 (offset, size) 相同的阶段合并。
+ *        通过 vk_device::request_pipeline_layout 获取，描述符集布局与推送常量相同的着色器组合共用一个布局
+ */
+class vk_pipeline_layout : public vk_unit<vk::PipelineLayout>
+{
+public:
+    vk_pipeline_layout(vk_device& device,
+                       std::vector<ShaderResource>&& resources,
+                       std::vector<vk_descriptor_set_layout*>&& descriptor_set_layouts,
+                       std::vector<vk::PushConstantRange>&& push_constant_ranges);
+
+    ~vk_pipeline_layout() override;
+
+    vk_pipeline_layout(const vk_pipeline_layout&) = delete;
+    vk_pipeline_layout(vk_pipeline_layout&&) = delete;
+
+    vk_pipeline_layout& operator=(const vk_pipeline_layout&) = delete;
+    vk_pipeline_layout& operator=(vk_pipeline_layout&&) = delete;
+
+    /**
+     * @brief 合并各阶段的反射结果，推送常量的阶段标志按 canonicalize_stage_flags 规范化
+     */
+    static void merge_shader_resources(const std::vector<ShaderModule*>& shader_modules,
+                                       std::vector<ShaderResource>& resources,
+                                       std::vector<vk::PushConstantRange>& push_constant_ranges);
+
+    /**
+     * @brief 首个请求该布局的着色器组合的反射结果
+     */
+    const std::vector<ShaderResource>& get_resources() const;
+
+    bool has_descriptor_set_layout(uint32_t set_index) const;
+
+    vk_descriptor_set_layout& get_descriptor_set_layout(uint32_t set_index) const;
+
+    const std::vector<vk::PushConstantRange>& get_push_constant_ranges() const;
+
+    /**
+     * @brief 推送 [offset, offset + size) 时 vkCmdPushConstants 需要的阶段。
+     *        与该区间重叠的每个范围都必须完整包含它，否则返回空标志
+     */
+    vk::ShaderStageFlags get_push_constant_range_stage(uint32_t size, uint32_t offset = 0) const;
+
+private:
+    std::vector<ShaderResource> resources;
+
+    // 归设备的布局缓存所有
+    std::vector<vk_descriptor_set_layout*> descriptor_set_layouts;
+
+    std::vector<vk::PushConstantRange> push_constant_ranges;
+};
+
+/**
+ * @brief 特化常量状态：constant_id -> 原始字节。同一份 SPIR-V 通过不同的特化常量
+ *        生成不同的管线变体，状态参与管线键的哈希
+ */
+class SpecializationConstantState
+{
+public:
+    void reset();
+
+    template<typename T>
+    void set_constant(uint32_t constant_id, const T& data);
+
+    void set_constant(uint32_t constant_id, const std::vector<uint8_t>& data);
+
+    void set_specialization_constant_state(const std::map<uint32_t, std::vector<uint8_t>>& state);
+
+    const std::map<uint32_t, std::vector<uint8_t>>& get_specialization_constant_state() const;
+
+private:
+    // 按 constant_id 排序，保证相同的状态得到相同的哈希
+    std::map<uint32_t, std::vector<uint8_t>> specialization_constant_state;
+};
+
+template<typename T>
+inline void SpecializationConstantState::set_constant(uint32_t constant_id, const T& data)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "特化常量必须是可平凡复制的类型");
+
+    std::vector<uint8_t> bytes(sizeof(T));
+    std::memcpy(bytes.data(), &data, sizeof(T));
+
+    set_constant(constant_id, bytes);
+}
+
+template<>
+inline void SpecializationConstantState::set_constant<bool>(uint32_t constant_id, const bool& data)
+{
+    // SPIR-V 的布尔特化常量以 VkBool32 传递
+    set_constant(constant_id, static_cast<VkBool32>(data));
+}
+
+class vk_compute_pipeline : public vk_unit<vk::Pipeline>
+{
+public:
+    vk_compute_pipeline(vk_device& device,
+                        const ShaderModule& shader_module,
+                        vk::PipelineLayout pipeline_layout,
+                        vk::PipelineCache pipeline_cache = nullptr);
+
+    vk_compute_pipeline(vk_device& device,
+                        const ShaderModule& shader_module,
+                        const vk_pipeline_layout& pipeline_layout,
+                        const SpecializationConstantState& specialization_constant_state,
+                        vk::PipelineCache pipeline_cache = nullptr);
+
+    vk_compute_pipeline(vk_compute_pipeline&& other);
+
+    ~vk_compute_pipeline() override;
+
+    vk_compute_pipeline(const vk_compute_pipeline&) = delete;
+
+    vk_compute_pipeline& operator=(const vk_compute_pipeline&) = delete;
+    vk_compute_pipeline& operator=(vk_compute_pipeline&&) = delete;
+
+    vk::PipelineLayout get_layout() const;
+
+    /**
+     * @brief 根据模块反射出的特化常量构建映射条目与数据块，状态中 id 未被着色器声明的常量会被忽略，
+     *        大小不匹配时抛出异常。返回的 VkSpecializationInfo 引用 entries 与 data
+     */
+    static VkSpecializationInfo make_specialization_info(const ShaderModule& shader_module,
+                                                         const SpecializationConstantState& state,
+                                                         std::vector<VkSpecializationMapEntry>& entries,
+                                                         std::vector<uint8_t>& data);
+
+private:
+    vk::PipelineLayout pipeline_layout;
+};
@@ -0,0 +1,387 @@
+﻿/**
+ * @File Profiler.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "Profiler.hpp"
+#include "VkCommon.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+
+constexpr const char* FRAME_SCOPE_NAME = "Frame";
+
+template<class T>
+double percentile(const std::vector<T>& sorted_samples, double p)
+{
+    if (sorted_samples.empty()) {
+        return 0.0;
+    }
+
+    auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted_samples.size())));
+    rank = std::clamp<size_t>(rank, 1, sorted_samples.size());
+    return static_cast<double>(sorted_samples[rank - 1]);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+ProfileEventBuffer::ProfileEventBuffer(uint32_t thread_id) :
+    events{std::make_unique<ProfileEvent[]>(CAPACITY)},
+    thread_id{thread_id}
+{
+}
+
+bool ProfileEventBuffer::push(const ProfileEvent& event)
+{
+    uint64_t head = write_pos.load(std::memory_order_relaxed);
+    if (head - read_pos.load(std::memory_order_acquire) >= CAPACITY) {
+        // 消费者跟不上（例如没有调用 end_frame），丢弃而不是阻塞
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    events[head & (CAPACITY - 1)] = event;
+    write_pos.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool ProfileEventBuffer::is_empty() const
+{
+    return read_pos.load(std::memory_order_acquire) == write_pos.load(std::memory_order_acquire);
+}
+
+uint32_t ProfileEventBuffer::get_thread_id() const
+{
+    return thread_id;
+}
+
+uint64_t ProfileEventBuffer::take_dropped_count()
+{
+    return dropped.exchange(0, std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+FrameProfiler& FrameProfiler::get()
+{
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+ProfileEventBuffer& FrameProfiler::get_thread_buffer()
+{
+    struct ThreadBufferHolder
+    {
+        std::shared_ptr<ProfileEventBuffer> buffer;
+
+        ~ThreadBufferHolder()
+        {
+            if (buffer) {
+                buffer->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+    thread_local ThreadBufferHolder holder;
+
+    if (!holder.buffer) {
+        std::lock_guard<std::mutex> lock{registry_mutex};
+        holder.buffer = std::make_shared<ProfileEventBuffer>(next_thread_id++);
+        thread_buffers.push_back(holder.buffer);
+    }
+
+    return *holder.buffer;
+}
+
+void FrameProfiler::end_frame()
+{
+    const uint64_t frame_end_ns = now_ns();
+
+    std::vector<std::shared_ptr<ProfileEventBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock{registry_mutex};
+        buffers = thread_buffers;
+    }
+
+    // 先按名字指针聚合，避免每个事件都构造 std::string
+    struct FrameTotal
+    {
+        uint64_t ns{0};
+        uint32_t calls{0};
+    };
+    std::unordered_map<const char*, FrameTotal> frame_totals;
+
+    bool     capturing = capture_frames_left > 0;
+    uint64_t dropped   = 0;
+
+    for (auto& buffer: buffers) {
+        buffer->drain([&](const ProfileEvent& event) {
+            auto& total = frame_totals[event.name];
+            total.ns += event.end_ns - event.start_ns;
+            total.calls += 1;
+
+            if (capturing) {
+                captured_events.push_back({event, buffer->get_thread_id()});
+            }
+        });
+        dropped += buffer->take_dropped_count();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{registry_mutex};
+        thread_buffers.erase(std::remove_if(thread_buffers.begin(), thread_buffers.end(),
+                                            [](const std::shared_ptr<ProfileEventBuffer>& buffer) {
+                                                // 先判断 retired 再检查是否读空，保证退出前写入的事件已被收集
+                                                return buffer->retired.load(std::memory_order_acquire)
+                                                       && buffer->is_empty();
+                                            }),
+                             thread_buffers.end());
+    }
+
+    if (dropped > 0) {
+        LOGW("Profiler dropped {} events in frame {}", dropped, frame_index.load());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{stats_mutex};
+
+        auto record = [this](const std::string& name, uint64_t ns, uint32_t calls) {
+            auto& history = histories[name];
+            history.frame_ns.push_back(ns);
+            history.frame_calls.push_back(calls);
+            while (history.frame_ns.size() > history_size) {
+                history.frame_ns.pop_front();
+                history.frame_calls.pop_front();
+            }
+        };
+
+        // 不同翻译单元中相同的字面量可能是不同指针，这里按字符串合并
+        std::unordered_map<std::string, FrameTotal> merged;
+        for (auto& total: frame_totals) {
+            auto& m = merged[total.first];
+            m.ns += total.second.ns;
+            m.calls += total.second.calls;
+        }
+        for (auto& total: merged) {
+            record(total.first, total.second.ns, total.second.calls);
+        }
+
+        if (frame_start_ns != 0) {
+            record(FRAME_SCOPE_NAME, frame_end_ns - frame_start_ns, 1);
+        }
+    }
+
+    if (capturing) {
+        if (frame_start_ns != 0) {
+            captured_events.push_back({ProfileEvent{FRAME_SCOPE_NAME, frame_start_ns, frame_end_ns, 0}, 0});
+        }
+
+        if (--capture_frames_left == 0) {
+            write_capture();
+        }
+    }
+
+    frame_start_ns = frame_end_ns;
+    ++frame_index;
+}
+
+void FrameProfiler::begin_capture(const std::string& path, uint32_t frame_count)
+{
+    if (capture_frames_left > 0) {
+        LOGW("Profiler capture already in progress, ignoring request for {}", path);
+        return;
+    }
+
+    capture_path        = path;
+    capture_frames_left = std::max(frame_count, 1u);
+    captured_events.clear();
+
+    LOGI("Profiler capturing {} frames to {}", capture_frames_left, capture_path);
+}
+
+bool FrameProfiler::is_capturing() const
+{
+    return capture_frames_left > 0;
+}
+
+void FrameProfiler::write_capture()
+{
+    std::ofstream file{capture_path, std::ios::out | std::ios::trunc};
+    if (!file.is_open()) {
+        LOGE("Failed to open profiler capture file {}", capture_path);
+        captured_events.clear();
+        return;
+    }
+
+    // Chrome trace event format, 时间单位为微秒
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    for (size_t i = 0; i < captured_events.size(); ++i) {
+        const auto& e = captured_events[i];
+        file << fmt::format("{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}{}\n",
+                            e.event.name, e.thread_id,
+                            static_cast<double>(e.event.start_ns) * 1e-3,
+                            static_cast<double>(e.event.end_ns - e.event.start_ns) * 1e-3,
+                            i + 1 < captured_events.size() ? "," : "");
+    }
+    file << "]}\n";
+
+    LOGI("Profiler wrote {} events to {}", captured_events.size(), capture_path);
+
+    captured_events.clear();
+    captured_events.shrink_to_fit();
+}
+
+void FrameProfiler::set_history_size(size_t frames)
+{
+    std::lock_guard<std::mutex> lock{stats_mutex};
+    history_size = std::max<size_t>(frames, 1);
+}
+
+std::vector<ProfileScopeStats> FrameProfiler::get_summary() const
+{
+    std::vector<ProfileScopeStats> summary;
+
+    std::lock_guard<std::mutex> lock{stats_mutex};
+    summary.reserve(histories.size());
+
+    std::vector<uint64_t> samples;
+    for (auto& it: histories) {
+        const auto& history = it.second;
+        if (history.frame_ns.empty()) {
+            continue;
+        }
+
+        samples.assign(history.frame_ns.begin(), history.frame_ns.end());
+        std::sort(samples.begin(), samples.end());
+
+        uint64_t total_ns    = 0;
+        uint64_t total_calls = 0;
+        for (size_t i = 0; i < samples.size(); ++i) {
+            total_ns += samples[i];
+            total_calls += history.frame_calls[i];
+        }
+
+        ProfileScopeStats stats;
+        stats.name            = it.first;
+        stats.sample_count    = samples.size();
+        stats.mean_ms         = static_cast<double>(total_ns) * 1e-6 / static_cast<double>(samples.size());
+        stats.p95_ms          = percentile(samples, 0.95) * 1e-6;
+        stats.p99_ms          = percentile(samples, 0.99) * 1e-6;
+        stats.max_ms          = static_cast<double>(samples.back()) * 1e-6;
+        stats.calls_per_frame = static_cast<uint32_t>(total_calls / samples.size());
+
+        summary.push_back(std::move(stats));
+    }
+
+    std::sort(summary.begin(), summary.end(),
+              [](const ProfileScopeStats& a, const ProfileScopeStats& b) { return a.mean_ms > b.mean_ms; });
+
+    return summary;
+}
+
+void FrameProfiler::record_counter(const std::string& scope, const std::string& counter, double value)
+{
+    std::lock_guard<std::mutex> lock{stats_mutex};
+
+    auto& history = counter_histories[{scope, counter}];
+    history.push_back(value);
+    while (history.size() > history_size) {
+        history.pop_front();
+    }
+}
+
+std::vector<ProfileCounterStats> FrameProfiler::get_counter_summary() const
+{
+    std::vector<ProfileCounterStats> summary;
+
+    std::lock_guard<std::mutex> lock{stats_mutex};
+    summary.reserve(counter_histories.size());
+
+    std::vector<double> samples;
+    for (auto& it: counter_histories) {
+        const auto& history = it.second;
+        if (history.empty()) {
+            continue;
+        }
+
+        samples.assign(history.begin(), history.end());
+        std::sort(samples.begin(), samples.end());
+
+        double total = 0.0;
+        for (auto v: samples) {
+            total += v;
+        }
+
+        ProfileCounterStats stats;
+        stats.scope        = it.first.first;
+        stats.counter      = it.first.second;
+        stats.sample_count = samples.size();
+        stats.mean         = total / static_cast<double>(samples.size());
+        stats.p95          = percentile(samples, 0.95);
+        stats.p99          = percentile(samples, 0.99);
+        stats.last         = history.back();
+
+        summary.push_back(std::move(stats));
+    }
+
+    return summary;
+}
+
+std::string FrameProfiler::get_summary_string() const
+{
+    std::string result = fmt::format("# frame {}\n# scope mean_ms p95_ms p99_ms max_ms calls samples\n",
+                                     get_frame_index());
+    for (auto& stats: get_summary()) {
+        result += fmt::format("{} {:.4f} {:.4f} {:.4f} {:.4f} {} {}\n",
+                              stats.name, stats.mean_ms, stats.p95_ms, stats.p99_ms, stats.max_ms,
+                              stats.calls_per_frame, stats.sample_count);
+    }
+
+    auto counters = get_counter_summary();
+    if (!counters.empty()) {
+        result += "# counter scope name mean p95 p99 last samples\n";
+        for (auto& stats: counters) {
+            result += fmt::format("counter {} \"{}\" {:.4f} {:.4f} {:.4f} {:.4f} {}\n",
+                                  stats.scope, stats.counter, stats.mean, stats.p95, stats.p99, stats.last,
+                                  stats.sample_count);
+        }
+    }
+    return result;
+}
+
+void FrameProfiler::log_summary() const
+{
+    LOGI("{:<40} {:>10} {:>10} {:>10} {:>6}", "Scope", "mean(ms)", "p95(ms)", "p99(ms)", "calls");
+    for (auto& stats: get_summary()) {
+        LOGI("{:<40} {:>10.4f} {:>10.4f} {:>10.4f} {:>6}",
+             stats.name, stats.mean_ms, stats.p95_ms, stats.p99_ms, stats.calls_per_frame);
+    }
+
+    for (auto& stats: get_counter_summary()) {
+        LOGI("  [{}] {:<36} mean {:.2f} p95 {:.2f} p99 {:.2f}",
+             stats.scope, stats.counter, stats.mean, stats.p95, stats.p99);
+    }
+}
+
+bool FrameProfiler::write_summary(const std::string& path) const
+{
+    std::ofstream file{path, std::ios::out | std::ios::trunc};
+    if (!file.is_open()) {
+        LOGE("Failed to open profiler summary file {}", path);
+        return false;
+    }
+
+    file << get_summary_string();
+    return true;
+}
+
+uint64_t FrameProfiler::get_frame_index() const
+{
+    return frame_index.load();
+}
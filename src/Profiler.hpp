@@ -0,0 +1,235 @@
+﻿/**
+ * @File Profiler.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief CPU 帧分析器：作用域计时、每线程无锁事件缓冲、trace 抓取与滚动统计
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 编译期开关：未定义 VK_ENABLE_PROFILER 时所有宏展开为空，不产生任何开销
+#ifdef VK_ENABLE_PROFILER
+#   define PROFILE_CONCAT_IMPL(a, b) a##b
+#   define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#   define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__){name}
+#   define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#   define PROFILE_FRAME() FrameProfiler::get().end_frame()
+#else
+#   define PROFILE_SCOPE(name)
+#   define PROFILE_FUNCTION()
+#   define PROFILE_FRAME()
+#endif
+
+/**
+ * @brief 单个作用域事件，name 必须是静态生命周期的字符串（字面量或 __FUNCTION__）
+ */
+struct ProfileEvent
+{
+    const char* name{nullptr};
+    uint64_t    start_ns{0};
+    uint64_t    end_ns{0};
+    uint32_t    depth{0};
+};
+
+/**
+ * @brief 单生产者/单消费者环形缓冲，写入方为所属线程，读取方为 end_frame 的调用线程
+ */
+class ProfileEventBuffer
+{
+public:
+    static constexpr uint32_t CAPACITY = 1u << 14;
+
+    explicit ProfileEventBuffer(uint32_t thread_id);
+
+    bool push(const ProfileEvent& event);
+
+    template<class Func>
+    void drain(Func&& func)
+    {
+        uint64_t tail = read_pos.load(std::memory_order_relaxed);
+        uint64_t head = write_pos.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            func(events[tail & (CAPACITY - 1)]);
+        }
+        read_pos.store(tail, std::memory_order_release);
+    }
+
+    bool is_empty() const;
+
+    uint32_t get_thread_id() const;
+
+    uint64_t take_dropped_count();
+
+    uint32_t depth{0};
+
+    // 所属线程退出后置位，下一次 end_frame 读完剩余事件后从注册表中移除
+    std::atomic<bool> retired{false};
+
+private:
+    std::unique_ptr<ProfileEvent[]> events;
+    std::atomic<uint64_t>           write_pos{0};
+    std::atomic<uint64_t>           read_pos{0};
+    std::atomic<uint64_t>           dropped{0};
+    uint32_t                        thread_id{0};
+};
+
+/**
+ * @brief 某个作用域在滚动窗口内的统计结果，时间单位为毫秒
+ */
+struct ProfileScopeStats
+{
+    std::string name;
+    double      mean_ms{0.0};
+    double      p95_ms{0.0};
+    double      p99_ms{0.0};
+    double      max_ms{0.0};
+    uint32_t    calls_per_frame{0};
+    size_t      sample_count{0};
+};
+
+/**
+ * @brief 挂在作用域上的硬件/驱动计数器统计（见 vk_counter_session）
+ */
+struct ProfileCounterStats
+{
+    std::string scope;
+    std::string counter;
+    double      mean{0.0};
+    double      p95{0.0};
+    double      p99{0.0};
+    double      last{0.0};
+    size_t      sample_count{0};
+};
+
+class FrameProfiler
+{
+public:
+    static FrameProfiler& get();
+
+    static uint64_t now_ns()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler(FrameProfiler&&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(FrameProfiler&&) = delete;
+
+    /**
+     * @brief 当前线程的事件缓冲，首次调用时注册（仅此处加锁）
+     */
+    ProfileEventBuffer& get_thread_buffer();
+
+    /**
+     * @brief 帧边界：收集所有线程的事件，更新滚动统计，必要时写出 trace
+     */
+    void end_frame();
+
+    /**
+     * @brief 抓取接下来 frame_count 帧的全部事件，结束后写出 Chrome trace (chrome://tracing / Perfetto) 格式文件
+     */
+    void begin_capture(const std::string& path, uint32_t frame_count = 60);
+
+    bool is_capturing() const;
+
+    /**
+     * @brief 滚动窗口大小（帧数）
+     */
+    void set_history_size(size_t frames);
+
+    /**
+     * @brief 记录一个作用域上的计数器采样，与 CPU 计时使用相同的滚动窗口
+     */
+    void record_counter(const std::string& scope, const std::string& counter, double value);
+
+    std::vector<ProfileScopeStats> get_summary() const;
+
+    std::vector<ProfileCounterStats> get_counter_summary() const;
+
+    /**
+     * @brief 以 "name mean p95 p99 max calls" 一行一个作用域的文本格式输出，便于脚本解析
+     */
+    std::string get_summary_string() const;
+
+    void log_summary() const;
+
+    bool write_summary(const std::string& path) const;
+
+    uint64_t get_frame_index() const;
+
+private:
+    FrameProfiler() = default;
+
+    struct ScopeHistory
+    {
+        std::deque<uint64_t> frame_ns;
+        std::deque<uint32_t> frame_calls;
+    };
+
+    struct CapturedEvent
+    {
+        ProfileEvent event;
+        uint32_t     thread_id;
+    };
+
+    void write_capture();
+
+    mutable std::mutex                               registry_mutex;
+    std::vector<std::shared_ptr<ProfileEventBuffer>> thread_buffers;
+    uint32_t                                         next_thread_id{0};
+
+    mutable std::mutex                            stats_mutex;
+    std::unordered_map<std::string, ScopeHistory> histories;
+    std::map<std::pair<std::string, std::string>, std::deque<double>> counter_histories;
+    size_t                                        history_size{240};
+    std::atomic<uint64_t>                         frame_index{0};
+    uint64_t                                      frame_start_ns{0};
+
+    std::string                capture_path;
+    uint32_t                   capture_frames_left{0};
+    std::vector<CapturedEvent> captured_events;
+};
+
+/**
+ * @brief RAII 作用域计时
+ */
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name) :
+        buffer{FrameProfiler::get().get_thread_buffer()},
+        name{name},
+        start_ns{FrameProfiler::now_ns()}
+    {
+        ++buffer.depth;
+    }
+
+    ~ProfileScope()
+    {
+        --buffer.depth;
+        buffer.push(ProfileEvent{name, start_ns, FrameProfiler::now_ns(), buffer.depth});
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope(ProfileScope&&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+    ProfileScope& operator=(ProfileScope&&) = delete;
+
+private:
+    ProfileEventBuffer& buffer;
+    const char* name;
+    uint64_t start_ns;
+};
@@ -10,13 +10,29 @@
 #include "PhysicalDevice.hpp"
 #include "CommandBufferPool.hpp"
 #include "ImageView.hpp"
+#include "Profiler.hpp"
 
 vk_render_context::vk_render_context(vk_device& device, vk::SurfaceKHR surface, const vk::Extent2D& extent,
                                      vk::PresentModeKHR present_mode,
                                      const std::vector<vk::PresentModeKHR>& present_mode_priority_list,
                                      const std::vector<vk::SurfaceFormatKHR>& surface_format_priority_list)
-    : device{device}, queue{device.get_suitable_graphics_queue()}, surface_extent{extent}
+    : device{device},
+      queue{device.get_suitable_graphics_queue()},
+      compute_queue{device.get_suitable_compute_queue()},
+      surface_extent{extent}
 {
+    if (device.is_enabled(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+        vk::SemaphoreTypeCreateInfo type_info{vk::SemaphoreType::eTimeline, 0};
+        vk::SemaphoreCreateInfo create_info{};
+        create_info.pNext = &type_info;
+
+        compute_timeline = device.handle().createSemaphore(create_info);
+    }
+
+    if (has_async_compute()) {
+        LOGI("异步计算队列: family {} index {}", compute_queue.get_family_index(), compute_queue.get_index());
+    }
+
     if (surface) {
         vk::SurfaceCapabilitiesKHR surface_properties = device.get_gpu().handle().getSurfaceCapabilitiesKHR(surface);
 
@@ -31,6 +47,13 @@ vk_render_context::vk_render_context(vk_device& device, vk::SurfaceKHR surface,
     }
 }
 
+vk_render_context::~vk_render_context()
+{
+    if (compute_timeline) {
+        device.handle().destroySemaphore(compute_timeline);
+    }
+}
+
 void vk_render_context::prepare(size_t thread_count, vk_render_target::CreateFunc create_render_target_func)
 {
     device.handle().waitIdle();
@@ -53,7 +76,8 @@ void vk_render_context::prepare(size_t thread_count, vk_render_target::CreateFun
                                     vk::Extent3D{surface_extent.width, surface_extent.height, 1},
                                     DEFAULT_VK_FORMAT,        // We can use any format here that we like
                                     vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
-                                    VMA_MEMORY_USAGE_GPU_ONLY};
+                                    VMA_MEMORY_USAGE_GPU_ONLY, vk::SampleCountFlagBits::e1, 1, 1,
+                                    vk::ImageTiling::eOptimal, {}, 0, nullptr, MemoryCategory::RenderTarget};
 
         auto render_target = create_render_target_func(std::move(color_image));
         frames.emplace_back(std::make_unique<vk_render_frame>(device, std::move(render_target), thread_count));
@@ -222,6 +246,8 @@ void vk_render_context::submit(const std::vector<vk_command_buffer*>& command_bu
 
 void vk_render_context::begin_frame()
 {
+    PROFILE_SCOPE("vk_render_context::begin_frame");
+
     // Only handle surface changes if a swapchain exists
     if (swapchain) {
         handle_surface_changes();
@@ -238,6 +264,7 @@ void vk_render_context::begin_frame()
     if (swapchain) {
         vk::Result result;
         try {
+            PROFILE_SCOPE("vk_render_context::acquire");
             std::tie(result, active_frame_index) = swapchain->acquire(acquired_semaphore);
         }
         catch (vk::OutOfDateKHRError& /*err*/) {
@@ -268,6 +295,8 @@ void vk_render_context::begin_frame()
 vk::Semaphore vk_render_context::submit(const vk_queue& queue, const std::vector<vk_command_buffer*>& command_buffers,
                                         vk::Semaphore wait_semaphore, vk::PipelineStageFlags wait_pipeline_stage)
 {
+    PROFILE_SCOPE("vk_render_context::submit");
+
     std::vector<vk::CommandBuffer> cmd_buf_handles(command_buffers.size(), nullptr);
     std::transform(command_buffers.begin(), command_buffers.end(), cmd_buf_handles.begin(),
                    [](const vk_command_buffer* cmd_buf) { return cmd_buf->handle(); });
@@ -276,36 +305,93 @@ vk::Semaphore vk_render_context::submit(const vk_queue& queue, const std::vector
 
     vk::Semaphore signal_semaphore = frame.request_semaphore();
 
-    vk::SubmitInfo submit_info(nullptr, nullptr, cmd_buf_handles, signal_semaphore);
+    std::vector<SemaphoreSubmit> wait_semaphores;
+
     if (wait_semaphore) {
-        submit_info.setWaitSemaphores(wait_semaphore);
-        submit_info.pWaitDstStageMask = &wait_pipeline_stage;
+        wait_semaphores.push_back({wait_semaphore, 0, to_stage_flags2(wait_pipeline_stage)});
     }
 
-    vk::Fence fence = frame.request_fence();
+    // 等待此前提交到异步计算队列的工作
+    for (const auto& dependency: consume_compute_dependencies()) {
+        wait_semaphores.push_back({dependency.semaphore, dependency.value, to_stage_flags2(dependency.stage)});
+    }
 
-    queue.get_handle().submit(submit_info, fence);
+    // 同一队列上此前入队的工作（如共用队列时的剔除计算）在这里一起提交
+    auto& batcher = device.get_submit_batcher(queue);
+    batcher.enqueue(cmd_buf_handles, wait_semaphores, {{signal_semaphore}});
+    batcher.flush(frame.request_fence());
 
     return signal_semaphore;
 }
 
 void vk_render_context::submit(const vk_queue& queue, const std::vector<vk_command_buffer*>& command_buffers)
 {
+    PROFILE_SCOPE("vk_render_context::submit");
+
     std::vector<vk::CommandBuffer> cmd_buf_handles(command_buffers.size(), nullptr);
     std::transform(command_buffers.begin(), command_buffers.end(), cmd_buf_handles.begin(),
                    [](const vk_command_buffer* cmd_buf) { return cmd_buf->handle(); });
 
     auto& frame = get_active_frame();
 
-    vk::SubmitInfo submit_info(nullptr, nullptr, cmd_buf_handles);
+    auto& batcher = device.get_submit_batcher(queue);
+    batcher.enqueue(cmd_buf_handles);
+    batcher.flush(frame.request_fence());
+}
+
+void vk_render_context::submit_compute(vk_render_frame& frame,
+                                       const std::vector<vk_command_buffer*>& command_buffers,
+                                       vk::PipelineStageFlags graphics_wait_stage)
+{
+    PROFILE_SCOPE("vk_render_context::submit_compute");
+
+    std::vector<vk::CommandBuffer> cmd_buf_handles(command_buffers.size(), nullptr);
+    std::transform(command_buffers.begin(), command_buffers.end(), cmd_buf_handles.begin(),
+                   [](const vk_command_buffer* cmd_buf) { return cmd_buf->handle(); });
+
+    QueueDependency dependency{};
+    dependency.stage = graphics_wait_stage;
+
+    if (compute_timeline) {
+        dependency.semaphore = compute_timeline;
+        dependency.value     = ++compute_timeline_value;
+        dependency.timeline  = true;
+    } else {
+        // 二值信号量由帧持有，在帧重置时回收
+        dependency.semaphore = frame.request_semaphore();
+    }
+
+    auto& batcher = device.get_submit_batcher(compute_queue);
+    batcher.enqueue(cmd_buf_handles, {}, {{dependency.semaphore, dependency.value}});
+
+    // 独立的计算队列立即提交；与图形共用队列时留到图形提交一起刷新，帧栅栏随之覆盖这批工作
+    if (has_async_compute()) {
+        batcher.flush(frame.request_fence());
+    }
+
+    pending_compute_dependencies.push_back(dependency);
+}
 
-    vk::Fence fence = frame.request_fence();
+std::vector<QueueDependency> vk_render_context::consume_compute_dependencies()
+{
+    std::vector<QueueDependency> dependencies;
+    dependencies.swap(pending_compute_dependencies);
+    return dependencies;
+}
 
-    queue.get_handle().submit(submit_info, fence);
+const vk_queue& vk_render_context::get_compute_queue() const
+{
+    return compute_queue;
+}
+
+bool vk_render_context::has_async_compute() const
+{
+    return compute_queue.get_handle() != queue.get_handle();
 }
 
 void vk_render_context::wait_frame()
 {
+    PROFILE_SCOPE("vk_render_context::wait_frame");
     get_active_frame().reset();
 }
 
@@ -319,6 +405,7 @@ void vk_render_context::end_frame(vk::Semaphore semaphore)
 
         vk::Result result;
         try {
+            PROFILE_SCOPE("vk_render_context::present");
             result = queue.present(present_info);
         }
         catch (vk::OutOfDateKHRError& /*err*/) {
@@ -17,6 +17,17 @@
 
 class vk_device;
 
+/**
+ * @brief 图形提交需要等待的跨队列依赖，时间线信号量使用 value，二值信号量时 value 为 0
+ */
+struct QueueDependency
+{
+    vk::Semaphore semaphore;
+    uint64_t value{0};
+    vk::PipelineStageFlags stage;
+    bool timeline{false};
+};
+
 class vk_render_context
 {
 public:
@@ -33,7 +44,7 @@ public:
                          {vk::Format::eR8G8B8A8Srgb, vk::ColorSpaceKHR::eSrgbNonlinear}, {vk::Format::eB8G8R8A8Srgb, vk::ColorSpaceKHR::eSrgbNonlinear}});
     // @formatter:on
 
-    virtual ~vk_render_context() = default;
+    virtual ~vk_render_context();
 
     vk_render_context(const vk_render_context&) = delete;
     vk_render_context(vk_render_context&&) = delete;
@@ -73,6 +84,28 @@ public:
 
     void submit(const vk_queue& queue, const std::vector<vk_command_buffer*>& command_buffers);
 
+    /**
+     * @brief 将命令缓冲区提交到异步计算队列，并登记一个由下一次图形提交等待的依赖；
+     *        没有独立的计算队列时只入队，与下一次图形提交合并为一次 vkQueueSubmit2
+     * @param frame 提供围栏（及无时间线信号量时的二值信号量）的帧
+     * @param graphics_wait_stage 图形提交中需要等待计算结果的阶段
+     */
+    void submit_compute(vk_render_frame& frame,
+                        const std::vector<vk_command_buffer*>& command_buffers,
+                        vk::PipelineStageFlags graphics_wait_stage);
+
+    /**
+     * @brief 取出尚未被图形提交等待的计算依赖
+     */
+    std::vector<QueueDependency> consume_compute_dependencies();
+
+    const vk_queue& get_compute_queue() const;
+
+    /**
+     * @brief 计算队列与图形队列是否为不同的队列
+     */
+    bool has_async_compute() const;
+
     virtual void wait_frame();
 
     void end_frame(vk::Semaphore semaphore);
@@ -111,6 +144,14 @@ private:
 
     const vk_queue& queue;
 
+    const vk_queue& compute_queue;
+
+    vk::Semaphore compute_timeline;
+
+    uint64_t compute_timeline_value{0};
+
+    std::vector<QueueDependency> pending_compute_dependencies;
+
     std::unique_ptr<vk_swapchain> swapchain;
 
     swapchain_desc swapchain_properties;
@@ -11,6 +11,7 @@
 #include "RenderTarget.hpp"
 #include "ImageView.hpp"
 #include "ResourceCaching.hpp"
+#include "Profiler.hpp"
 
 vk_render_frame::vk_render_frame(vk_device& device, std::unique_ptr<vk_render_target>&& render_target,
                                  size_t thread_count) :
@@ -55,7 +56,12 @@ void vk_render_frame::update_render_target(std::unique_ptr<vk_render_target>&& r
 
 void vk_render_frame::reset()
 {
-    VK_CHECK(fence_pool.wait());
+    PROFILE_SCOPE("vk_render_frame::reset");
+
+    {
+        PROFILE_SCOPE("vk_render_frame::wait_fences");
+        VK_CHECK(fence_pool.wait());
+    }
 
     fence_pool.reset();
 
@@ -95,12 +101,13 @@ vk_render_frame::get_command_pools(const vk_queue& queue, vk_command_buffer::res
         }
     }
 
+    // 每个队列族、每个线程各一个池，计算队列的命令缓冲区与图形队列的互不干扰
     std::vector<std::unique_ptr<vk_command_pool>> queue_command_pools;
 
-//    for (size_t i = 0; i < thread_count; i++) {
-//        queue_command_pools.push_back(
-//            std::make_unique<vk_command_pool>(device, queue.get_family_index(), this, i, reset_mode));
-//    }
+    for (size_t i = 0; i < thread_count; i++) {
+        queue_command_pools.push_back(
+            std::make_unique<vk_command_pool>(device, queue.get_family_index(), reset_mode));
+    }
 
     auto res_ins_it = command_pools.emplace(queue.get_family_index(), std::move(queue_command_pools));
 
@@ -184,12 +191,45 @@ vk_render_frame::request_command_buffer(const vk_queue& queue, vk_command_buffer
     assert(thread_index < thread_count && "Thread index is out of bounds");
 
     auto& command_pools = get_command_pools(queue, reset_mode);
-    auto command_pool_it = std::find_if(command_pools.begin(), command_pools.end(),
-                                        [&thread_index](std::unique_ptr<vk_command_pool>& cmd_pool) {
-                                            return 0 == thread_index;
-                                        });
-    
-    return (*command_pool_it)->request_command_buffer(vk::CommandBufferLevel(level));
+    assert(thread_index < command_pools.size());
+
+    return command_pools[thread_index]->request_command_buffer(vk::CommandBufferLevel(level));
+}
+
+bool vk_render_frame::extract_dynamic_offsets(const vk_descriptor_set_layout& descriptor_set_layout,
+                                              const BindingMap<VkDescriptorBufferInfo>& buffer_infos,
+                                              BindingMap<VkDescriptorBufferInfo>& static_buffer_infos,
+                                              std::vector<uint32_t>& dynamic_offsets)
+{
+    dynamic_offsets.clear();
+
+    const auto& layout_bindings = descriptor_set_layout.get_bindings();
+    bool has_dynamic = std::any_of(layout_bindings.begin(), layout_bindings.end(),
+                                   [](const VkDescriptorSetLayoutBinding& binding) {
+                                       return binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+                                              binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+                                   });
+    if (!has_dynamic) {
+        return false;
+    }
+
+    // BindingMap 按绑定号、数组下标有序，正是 vkCmdBindDescriptorSets 要求的动态偏移顺序
+    static_buffer_infos = buffer_infos;
+    for (auto& [binding_index, elements]: static_buffer_infos) {
+        auto layout_binding = descriptor_set_layout.get_layout_binding(binding_index);
+        if (!layout_binding ||
+            (layout_binding->descriptorType != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC &&
+             layout_binding->descriptorType != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)) {
+            continue;
+        }
+
+        for (auto& element_it: elements) {
+            dynamic_offsets.push_back(to_u32(element_it.second.offset));
+            element_it.second.offset = 0;
+        }
+    }
+
+    return true;
 }
 
 VkDescriptorSet vk_render_frame::request_descriptor_set(const vk_descriptor_set_layout& descriptor_set_layout,
@@ -197,6 +237,31 @@ VkDescriptorSet vk_render_frame::request_descriptor_set(const vk_descriptor_set_
                                                         const BindingMap<VkDescriptorImageInfo>& image_infos,
                                                         bool update_after_bind, size_t thread_index)
 {
+    std::vector<uint32_t> dynamic_offsets;
+
+    auto descriptor_set = request_descriptor_set(descriptor_set_layout, buffer_infos, image_infos, dynamic_offsets,
+                                                 update_after_bind, thread_index);
+
+    assert(dynamic_offsets.empty() && "Layout has dynamic bindings, request the descriptor set with dynamic offsets");
+
+    return descriptor_set;
+}
+
+VkDescriptorSet vk_render_frame::request_descriptor_set(const vk_descriptor_set_layout& descriptor_set_layout,
+                                                        const BindingMap<VkDescriptorBufferInfo>& requested_buffer_infos,
+                                                        const BindingMap<VkDescriptorImageInfo>& image_infos,
+                                                        std::vector<uint32_t>& dynamic_offsets,
+                                                        bool update_after_bind, size_t thread_index)
+{
+    PROFILE_SCOPE("vk_render_frame::request_descriptor_set");
+
+    BindingMap<VkDescriptorBufferInfo> static_buffer_infos;
+
+    const auto& buffer_infos = extract_dynamic_offsets(descriptor_set_layout, requested_buffer_infos,
+                                                       static_buffer_infos, dynamic_offsets)
+                               ? static_buffer_infos
+                               : requested_buffer_infos;
+
     assert(thread_index < thread_count && "Thread index is out of bounds");
     assert(thread_index < descriptor_pools.size());
 
@@ -232,6 +297,79 @@ void vk_render_frame::update_descriptor_sets(size_t thread_index)
     }
 }
 
+void vk_render_frame::remap_descriptor_resources(const std::unordered_map<VkBuffer, VkBuffer>& buffers,
+                                                 const std::unordered_map<VkImageView, VkImageView>& image_views)
+{
+    if (buffers.empty() && image_views.empty()) {
+        return;
+    }
+
+    for (auto& desc_sets_per_thread: descriptor_sets) {
+        auto& thread_descriptor_sets = *desc_sets_per_thread;
+
+        std::vector<std::size_t> stale_keys;
+        for (auto& [key, descriptor_set]: thread_descriptor_sets) {
+            auto buffer_infos = descriptor_set.get_buffer_infos();
+            auto image_infos  = descriptor_set.get_image_infos();
+            bool changed      = false;
+
+            for (auto& binding_it: buffer_infos) {
+                for (auto& element_it: binding_it.second) {
+                    auto it = buffers.find(element_it.second.buffer);
+                    if (it != buffers.end()) {
+                        element_it.second.buffer = it->second;
+                        changed = true;
+                    }
+                }
+            }
+
+            for (auto& binding_it: image_infos) {
+                for (auto& element_it: binding_it.second) {
+                    auto it = image_views.find(element_it.second.imageView);
+                    if (it != image_views.end()) {
+                        element_it.second.imageView = it->second;
+                        changed = true;
+                    }
+                }
+            }
+
+            if (changed) {
+                descriptor_set.reset(buffer_infos, image_infos);
+                descriptor_set.update();
+                stale_keys.push_back(key);
+            }
+        }
+
+        // 缓存键由描述符内容哈希而来，内容变化后需要重新插入。
+        // 先取出全部过期的节点再插入，避免新键与尚未处理的旧键冲突
+        using DescriptorSetNode = std::unordered_map<std::size_t, vk_descriptor_set>::node_type;
+
+        std::vector<DescriptorSetNode> stale_nodes;
+        stale_nodes.reserve(stale_keys.size());
+        for (auto key: stale_keys) {
+            stale_nodes.push_back(thread_descriptor_sets.extract(key));
+        }
+
+        for (auto& node: stale_nodes) {
+            auto& descriptor_set = node.mapped();
+
+            std::size_t hash{0U};
+            hash_param(hash, descriptor_set.get_layout(), descriptor_set.get_pool(),
+                       descriptor_set.get_buffer_infos(), descriptor_set.get_image_infos());
+
+            node.key() = hash;
+
+            // 新内容与已有条目（例如整理后已按新缓冲区请求过的集合）相同时保留已有条目。
+            // 丢弃的对象只是缓存记录：缓存不会向外交出它的引用，其 VkDescriptorSet 由描述符池持有，
+            // 已交给调用方的句柄在池重置前仍然有效
+            auto result = thread_descriptor_sets.insert(std::move(node));
+            if (!result.inserted) {
+                LOGD("整理后的描述符集与已缓存的集合内容相同，保留已缓存的集合");
+            }
+        }
+    }
+}
+
 void vk_render_frame::clear_descriptors()
 {
     for (auto& desc_sets_per_thread: descriptor_sets) {
@@ -258,6 +396,8 @@ void vk_render_frame::set_descriptor_management_strategy(DescriptorManagementStr
 vk_buffer_allocation
 vk_render_frame::allocate_buffer(const VkBufferUsageFlags usage, const VkDeviceSize size, size_t thread_index)
 {
+    PROFILE_SCOPE("vk_render_frame::allocate_buffer");
+
     assert(thread_index < thread_count && "Thread index is out of bounds");
 
     // Find a pool for this usage
@@ -81,7 +81,7 @@ public:
 
     /**
     * @brief 从池中请求命令缓冲区，请求的帧应该是活动状态
-    * @param queue 用于提交命令缓冲区的队列
+    * @param queue 用于提交命令缓冲区的队列，每个队列族（如图形与异步计算）使用各自的池
     * @param reset_mode 用于指示如何使用命令缓冲区，也可能用于池重新创建时设置相应标志
     * @param level 命令缓冲区的等级，primary 或 secondary
     * @param thread_index 指示命令缓冲区池的线程索引
@@ -101,6 +101,19 @@ public:
                                            bool update_after_bind,
                                            size_t thread_index = 0);
 
+    /**
+     * @brief 同上，但布局中的动态 uniform / storage 缓冲区绑定的 offset 不参与描述符集的哈希，
+     *        而是按绑定顺序写入 dynamic_offsets，绑定描述符集时传入。
+     *        这样同一缓冲区内不同偏移的数据（如 vk_buffer_allocation::get_offset()）共用一个描述符集，
+     *        此时 range 应为单次绑定可见的大小，不能是 VK_WHOLE_SIZE
+     */
+    VkDescriptorSet request_descriptor_set(const vk_descriptor_set_layout& descriptor_set_layout,
+                                           const BindingMap<VkDescriptorBufferInfo>& buffer_infos,
+                                           const BindingMap<VkDescriptorImageInfo>& image_infos,
+                                           std::vector<uint32_t>& dynamic_offsets,
+                                           bool update_after_bind,
+                                           size_t thread_index = 0);
+
     void clear_descriptors();
 
     /**
@@ -127,6 +140,14 @@ public:
      */
     void update_descriptor_sets(size_t thread_index = 0);
 
+    /**
+     * @brief 资源句柄被替换后（如碎片整理）修正缓存中引用旧句柄的描述符集，并按新的内容重新计算缓存键
+     * @param buffers 旧缓冲区句柄到新句柄的映射
+     * @param image_views 旧图像视图句柄到新句柄的映射
+     */
+    void remap_descriptor_resources(const std::unordered_map<VkBuffer, VkBuffer>& buffers,
+                                    const std::unordered_map<VkImageView, VkImageView>& image_views);
+
 private:
     vk_device& device;
 
@@ -152,6 +173,11 @@ private:
 
     std::map<VkBufferUsageFlags, std::vector<std::pair<vk_buffer_pool, vk_buffer_block*>>> buffer_pools;
 
+    static bool extract_dynamic_offsets(const vk_descriptor_set_layout& descriptor_set_layout,
+                                        const BindingMap<VkDescriptorBufferInfo>& buffer_infos,
+                                        BindingMap<VkDescriptorBufferInfo>& static_buffer_infos,
+                                        std::vector<uint32_t>& dynamic_offsets);
+
     static std::vector<uint32_t> collect_bindings_to_update(const vk_descriptor_set_layout& descriptor_set_layout,
                                                             const BindingMap<VkDescriptorBufferInfo>& buffer_infos,
                                                             const BindingMap<VkDescriptorImageInfo>& image_infos);
@@ -0,0 +1,366 @@
+﻿/**
+ * @File RenderQueue.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "RenderQueue.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+namespace {
+constexpr uint32_t RADIX_BITS   = 8;
+constexpr uint32_t RADIX_SIZE   = 1u << RADIX_BITS;
+constexpr uint32_t RADIX_PASSES = 64 / RADIX_BITS;
+
+// 少于这个数量时单线程排序
+constexpr size_t PARALLEL_THRESHOLD = 1 << 16;
+
+inline uint32_t get_digit(uint64_t key, uint32_t pass)
+{
+    return static_cast<uint32_t>(key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1);
+}
+}        // namespace
+
+namespace render_key {
+uint32_t quantize_depth(float normalized_depth, DepthOrder order)
+{
+    constexpr uint32_t max_bucket = (1u << DEPTH_BITS) - 1;
+
+    float    depth  = std::clamp(normalized_depth, 0.0f, 1.0f);
+    uint32_t bucket = static_cast<uint32_t>(depth * static_cast<float>(max_bucket) + 0.5f);
+
+    return order == DepthOrder::FrontToBack ? bucket : max_bucket - bucket;
+}
+
+uint64_t make(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth_bucket)
+{
+    auto field = [](uint32_t value, uint32_t shift, uint32_t bits) {
+        return (static_cast<uint64_t>(value) & ((uint64_t{1} << bits) - 1)) << shift;
+    };
+
+    return field(pass, PASS_SHIFT, PASS_BITS) | field(pipeline, PIPELINE_SHIFT, PIPELINE_BITS) |
+           field(material, MATERIAL_SHIFT, MATERIAL_BITS) | field(mesh, MESH_SHIFT, MESH_BITS) |
+           field(depth_bucket, DEPTH_SHIFT, DEPTH_BITS);
+}
+}        // namespace render_key
+
+vk_render_queue::vk_render_queue(uint32_t worker_count) :
+    worker_count{worker_count}
+{
+    if (this->worker_count == 0) {
+        uint32_t hardware = std::thread::hardware_concurrency();
+        this->worker_count = hardware > 1 ? hardware - 1 : 0;
+    }
+}
+
+vk_render_queue::~vk_render_queue()
+{
+    {
+        std::lock_guard<std::mutex> lock{job_mutex};
+        stopping = true;
+    }
+    job_start.notify_all();
+
+    for (auto& worker: workers) {
+        worker.join();
+    }
+}
+
+void vk_render_queue::reserve(size_t count)
+{
+    entries.reserve(count);
+    scratch.reserve(count);
+}
+
+void vk_render_queue::push(uint64_t key, uint32_t payload)
+{
+    entries.push_back({key, payload});
+}
+
+void vk_render_queue::sort()
+{
+    PROFILE_SCOPE("vk_render_queue::sort");
+
+    if (entries.size() < PARALLEL_THRESHOLD) {
+        radix_sort(1);
+        return;
+    }
+
+    start_workers();
+    radix_sort(get_thread_count());
+}
+
+void vk_render_queue::sort_single_threaded()
+{
+    radix_sort(1);
+}
+
+void vk_render_queue::clear()
+{
+    entries.clear();
+}
+
+bool vk_render_queue::empty() const
+{
+    return entries.empty();
+}
+
+size_t vk_render_queue::size() const
+{
+    return entries.size();
+}
+
+const std::vector<RenderQueueEntry>& vk_render_queue::get_entries() const
+{
+    return entries;
+}
+
+uint32_t vk_render_queue::get_thread_count() const
+{
+    return worker_count + 1;
+}
+
+void vk_render_queue::start_workers()
+{
+    if (workers.size() == worker_count) {
+        return;
+    }
+
+    workers.reserve(worker_count);
+    for (auto i = static_cast<uint32_t>(workers.size()); i < worker_count; ++i) {
+        workers.emplace_back(&vk_render_queue::worker_loop, this, i + 1);
+    }
+}
+
+void vk_render_queue::radix_sort(uint32_t thread_count)
+{
+    const size_t count = entries.size();
+    if (count < 2) {
+        return;
+    }
+
+    scratch.resize(count);
+    histograms.assign(static_cast<size_t>(thread_count) * RADIX_PASSES * RADIX_SIZE, 0);
+    offsets.resize(static_cast<size_t>(thread_count) * RADIX_SIZE);
+
+    const size_t chunk = (count + thread_count - 1) / thread_count;
+
+    auto chunk_range = [&](uint32_t thread) {
+        size_t begin = std::min(count, thread * chunk);
+        return std::make_pair(begin, std::min(count, begin + chunk));
+    };
+
+    auto thread_histogram = [&](uint32_t thread, uint32_t pass) {
+        return &histograms[(static_cast<size_t>(thread) * RADIX_PASSES + pass) * RADIX_SIZE];
+    };
+
+    auto run = [&](const std::function<void(uint32_t)>& job) {
+        if (thread_count == 1) {
+            job(0);
+        } else {
+            run_parallel(job);
+        }
+    };
+
+    // 一次读取统计所有趟的直方图，用于判断哪些趟可以跳过；第一趟实际执行的排序也直接使用它
+    run([&](uint32_t thread) {
+        auto [begin, end] = chunk_range(thread);
+
+        uint32_t* histogram = thread_histogram(thread, 0);
+        for (size_t i = begin; i < end; ++i) {
+            uint64_t key = entries[i].key;
+            for (uint32_t pass = 0; pass < RADIX_PASSES; ++pass) {
+                ++histogram[pass * RADIX_SIZE + get_digit(key, pass)];
+            }
+        }
+    });
+
+    RenderQueueEntry* src = entries.data();
+    RenderQueueEntry* dst = scratch.data();
+
+    bool first_pass = true;
+    for (uint32_t pass = 0; pass < RADIX_PASSES; ++pass) {
+        bool skip = false;
+        for (uint32_t digit = 0; digit < RADIX_SIZE && !skip; ++digit) {
+            size_t total = 0;
+            for (uint32_t thread = 0; thread < thread_count; ++thread) {
+                total += thread_histogram(thread, pass)[digit];
+            }
+            skip = total == count;
+        }
+        if (skip) {
+            continue;
+        }
+
+        // 之前的趟改变了元素顺序，各线程区间的直方图需要重新统计
+        if (!first_pass) {
+            run([&](uint32_t thread) {
+                auto [begin, end] = chunk_range(thread);
+
+                uint32_t* histogram = thread_histogram(thread, pass);
+                std::fill(histogram, histogram + RADIX_SIZE, 0);
+                for (size_t i = begin; i < end; ++i) {
+                    ++histogram[get_digit(src[i].key, pass)];
+                }
+            });
+        }
+        first_pass = false;
+
+        // 同一桶内按线程顺序排列，保证排序稳定
+        uint32_t running = 0;
+        for (uint32_t digit = 0; digit < RADIX_SIZE; ++digit) {
+            for (uint32_t thread = 0; thread < thread_count; ++thread) {
+                offsets[thread * RADIX_SIZE + digit] = running;
+                running += thread_histogram(thread, pass)[digit];
+            }
+        }
+
+        run([&](uint32_t thread) {
+            auto [begin, end] = chunk_range(thread);
+
+            uint32_t* offset = &offsets[thread * RADIX_SIZE];
+            for (size_t i = begin; i < end; ++i) {
+                dst[offset[get_digit(src[i].key, pass)]++] = src[i];
+            }
+        });
+
+        std::swap(src, dst);
+    }
+
+    if (src != entries.data()) {
+        entries.swap(scratch);
+    }
+}
+
+void vk_render_queue::run_parallel(const std::function<void(uint32_t)>& parallel_job)
+{
+    {
+        std::lock_guard<std::mutex> lock{job_mutex};
+        job         = &parallel_job;
+        job_pending = static_cast<uint32_t>(workers.size());
+        ++job_generation;
+    }
+    job_start.notify_all();
+
+    parallel_job(0);
+
+    std::unique_lock<std::mutex> lock{job_mutex};
+    job_done.wait(lock, [this] { return job_pending == 0; });
+    job = nullptr;
+}
+
+void vk_render_queue::worker_loop(uint32_t thread_index)
+{
+    uint64_t seen_generation = 0;
+
+    while (true) {
+        const std::function<void(uint32_t)>* current_job;
+        {
+            std::unique_lock<std::mutex> lock{job_mutex};
+            job_start.wait(lock, [this, seen_generation] { return stopping || job_generation != seen_generation; });
+            if (stopping) {
+                return;
+            }
+            seen_generation = job_generation;
+            current_job     = job;
+        }
+
+        (*current_job)(thread_index);
+
+        {
+            std::lock_guard<std::mutex> lock{job_mutex};
+            --job_pending;
+        }
+        job_done.notify_one();
+    }
+}
+
+void run_render_queue_benchmark(size_t draw_count, uint32_t worker_count)
+{
+    using clock = std::chrono::high_resolution_clock;
+
+    // 典型场景的状态分布：少量 pass 与管线，较多材质与网格
+    std::mt19937                            rng{42};
+    std::uniform_int_distribution<uint32_t> pass{0, 3};
+    std::uniform_int_distribution<uint32_t> pipeline{0, 31};
+    std::uniform_int_distribution<uint32_t> material{0, 1023};
+    std::uniform_int_distribution<uint32_t> mesh{0, 4095};
+    std::uniform_real_distribution<float>   depth{0.0f, 1.0f};
+
+    std::vector<uint64_t> keys(draw_count);
+    for (auto& key: keys) {
+        key = render_key::make(pass(rng), pipeline(rng), material(rng), mesh(rng),
+                               render_key::quantize_depth(depth(rng)));
+    }
+
+    vk_render_queue queue{worker_count};
+    queue.reserve(draw_count);
+
+    auto fill = [&] {
+        queue.clear();
+        for (uint32_t i = 0; i < keys.size(); ++i) {
+            queue.push(keys[i], i);
+        }
+    };
+
+    // pass、管线或材质任一变化即计为一次切换
+    auto count_state_changes = [](const std::vector<RenderQueueEntry>& entries) {
+        const uint64_t state_mask = ~((uint64_t{1} << render_key::MATERIAL_SHIFT) - 1);
+
+        size_t changes = 0;
+        for (size_t i = 1; i < entries.size(); ++i) {
+            changes += ((entries[i - 1].key ^ entries[i].key) & state_mask) != 0;
+        }
+        return changes;
+    };
+
+    fill();
+    size_t changes_before = count_state_changes(queue.get_entries());
+
+    constexpr int ITERATIONS = 10;
+
+    std::vector<RenderQueueEntry> sorted;
+
+    auto measure = [&](const char* name, auto&& sort) {
+        fill();
+        sort();        // 预热
+
+        double ns = 0.0;
+        for (int i = 0; i < ITERATIONS; ++i) {
+            fill();
+            auto start = clock::now();
+            sort();
+            ns += std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        }
+        ns /= ITERATIONS;
+
+        std::printf("  %-22s %10.3f ms  %7.3f ns/draw  %8.1f Mdraws/s\n",
+                    name, ns * 1e-6, ns / static_cast<double>(draw_count),
+                    static_cast<double>(draw_count) / ns * 1e3);
+    };
+
+    std::printf("Render queue sort benchmark: %zu draws, %u threads\n", draw_count, queue.get_thread_count());
+
+    measure("std::stable_sort", [&] {
+        sorted = queue.get_entries();
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [](const RenderQueueEntry& a, const RenderQueueEntry& b) { return a.key < b.key; });
+    });
+    measure("radix", [&] { queue.sort_single_threaded(); });
+    measure("radix threaded", [&] { queue.sort(); });
+
+    const auto& entries = queue.get_entries();
+    bool matches = std::equal(entries.begin(), entries.end(), sorted.begin(),
+                              [](const RenderQueueEntry& a, const RenderQueueEntry& b) {
+                                  return a.key == b.key && a.payload == b.payload;
+                              });
+
+    std::printf("  state changes: %zu unsorted -> %zu sorted, result %s\n", changes_before,
+                count_state_changes(entries), matches ? "matches std::stable_sort" : "MISMATCH");
+}
@@ -0,0 +1,151 @@
+﻿/**
+ * @File RenderQueue.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 按 64 位排序键组织绘制，多线程 LSD 基数排序
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 排序键从高位到低位依次为：pass(4) | 管线(12) | 材质(16) | 网格(16) | 深度桶(16)。
+ *        状态切换代价越高的字段位置越高，深度放在最后，相同状态的绘制按深度排列
+ */
+namespace render_key {
+constexpr uint32_t PASS_BITS     = 4;
+constexpr uint32_t PIPELINE_BITS = 12;
+constexpr uint32_t MATERIAL_BITS = 16;
+constexpr uint32_t MESH_BITS     = 16;
+constexpr uint32_t DEPTH_BITS    = 16;
+
+constexpr uint32_t DEPTH_SHIFT    = 0;
+constexpr uint32_t MESH_SHIFT     = DEPTH_SHIFT + DEPTH_BITS;
+constexpr uint32_t MATERIAL_SHIFT = MESH_SHIFT + MESH_BITS;
+constexpr uint32_t PIPELINE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+constexpr uint32_t PASS_SHIFT     = PIPELINE_SHIFT + PIPELINE_BITS;
+
+static_assert(PASS_SHIFT + PASS_BITS == 64, "排序键必须正好 64 位");
+
+enum class DepthOrder
+{
+    FrontToBack,        // 不透明物体，利于 early-Z
+    BackToFront,        // 半透明物体
+};
+
+/**
+ * @brief 把 [0, 1] 的归一化视空间深度量化为深度桶，超出范围的值被截断
+ */
+uint32_t quantize_depth(float normalized_depth, DepthOrder order = DepthOrder::FrontToBack);
+
+/**
+ * @brief 各字段超出位宽的部分被截掉，调用方需保证 id 紧凑
+ */
+uint64_t make(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth_bucket);
+
+inline uint32_t get_field(uint64_t key, uint32_t shift, uint32_t bits)
+{
+    return static_cast<uint32_t>((key >> shift) & ((uint64_t{1} << bits) - 1));
+}
+
+inline uint32_t get_pass(uint64_t key) { return get_field(key, PASS_SHIFT, PASS_BITS); }
+inline uint32_t get_pipeline(uint64_t key) { return get_field(key, PIPELINE_SHIFT, PIPELINE_BITS); }
+inline uint32_t get_material(uint64_t key) { return get_field(key, MATERIAL_SHIFT, MATERIAL_BITS); }
+inline uint32_t get_mesh(uint64_t key) { return get_field(key, MESH_SHIFT, MESH_BITS); }
+inline uint32_t get_depth(uint64_t key) { return get_field(key, DEPTH_SHIFT, DEPTH_BITS); }
+}        // namespace render_key
+
+struct RenderQueueEntry
+{
+    uint64_t key;
+    uint32_t payload;        // 调用方数据的下标
+};
+
+/**
+ * @brief 绘制队列：push() 排序键与负载下标 -> sort() -> 按 get_entries() 的顺序录制
+ *
+ * 排序为稳定的 LSD 基数排序，每趟 8 位：
+ * - 先一次读取统计全部 8 趟的直方图，所有键在某一位段上相同时跳过该趟（通常 pass 与管线字段如此）
+ * - 每趟按线程切分输入，各线程统计自己区间的直方图，前缀和按 (桶, 线程) 的顺序计算偏移，再并行分散写入
+ * - 数量较少时线程同步的开销大于收益，退化为单线程
+ */
+class vk_render_queue
+{
+public:
+    /**
+     * @param worker_count 额外的工作线程数，0 表示 hardware_concurrency - 1。
+     *                     工作线程在第一次达到多线程阈值的 sort() 时才创建，小队列不占用线程
+     */
+    explicit vk_render_queue(uint32_t worker_count = 0);
+
+    ~vk_render_queue();
+
+    vk_render_queue(const vk_render_queue&) = delete;
+    vk_render_queue(vk_render_queue&&) = delete;
+
+    vk_render_queue& operator=(const vk_render_queue&) = delete;
+    vk_render_queue& operator=(vk_render_queue&&) = delete;
+
+    void reserve(size_t count);
+
+    void push(uint64_t key, uint32_t payload);
+
+    /**
+     * @brief 多线程基数排序，键相同的条目保持提交顺序
+     */
+    void sort();
+
+    void sort_single_threaded();
+
+    void clear();
+
+    bool empty() const;
+
+    size_t size() const;
+
+    const std::vector<RenderQueueEntry>& get_entries() const;
+
+    uint32_t get_thread_count() const;
+
+private:
+    void radix_sort(uint32_t thread_count);
+
+    void start_workers();
+
+    /**
+     * @brief 在调用线程与全部工作线程上执行 job(thread_index)，全部完成后返回
+     */
+    void run_parallel(const std::function<void(uint32_t)>& job);
+
+    void worker_loop(uint32_t thread_index);
+
+    std::vector<RenderQueueEntry> entries;
+    std::vector<RenderQueueEntry> scratch;
+
+    // [线程][趟][桶]
+    std::vector<uint32_t> histograms;
+    std::vector<uint32_t> offsets;
+
+    uint32_t                                 worker_count{0};
+    std::vector<std::thread>                 workers;
+    std::mutex                               job_mutex;
+    std::condition_variable                  job_start;
+    std::condition_variable                  job_done;
+    uint64_t                                 job_generation{0};
+    uint32_t                                 job_pending{0};
+    bool                                     stopping{false};
+    const std::function<void(uint32_t)>*     job{nullptr};
+};
+
+/**
+ * @brief 排序基准：随机状态与深度的绘制，比较 std::sort 与单线程 / 多线程基数排序，
+ *        并统计排序前后的管线与材质切换次数
+ */
+void run_render_queue_benchmark(size_t draw_count = 1000000, uint32_t worker_count = 0);
@@ -21,7 +21,8 @@ const vk_render_target::CreateFunc vk_render_target::DEFAULT_CREATE_FUNC = [](vk
     vk::Format depth_format = get_suitable_depth_format(swapchain_image.device().get_gpu().handle());
     vk_image depth_image{swapchain_image.device(), swapchain_image.get_extent(), depth_format,
                          vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eTransientAttachment,
-                         VMA_MEMORY_USAGE_GPU_ONLY};
+                         VMA_MEMORY_USAGE_GPU_ONLY, vk::SampleCountFlagBits::e1, 1, 1, vk::ImageTiling::eOptimal, {},
+                         0, nullptr, MemoryCategory::RenderTarget};
 
     std::vector<vk_image> images;
     images.push_back(std::move(swapchain_image));
@@ -134,4 +135,36 @@ void vk_render_target::set_layout(uint32_t attachment, vk::ImageLayout layout)
 vk::ImageLayout vk_render_target::get_layout(uint32_t attachment) const
 {
     return attachments[attachment].initial_layout;
+}
+
+int32_t vk_render_target::get_depth_attachment() const
+{
+    for (size_t i = 0; i < attachments.size(); ++i) {
+        if (is_depth_format(attachments[i].format)) {
+            return static_cast<int32_t>(i);
+        }
+    }
+
+    return -1;
+}
+
+RenderingFormats vk_render_target::get_rendering_formats() const
+{
+    RenderingFormats formats;
+
+    for (auto attachment: output_attachments) {
+        formats.color_formats.push_back(attachments[attachment].format);
+    }
+
+    auto depth_attachment = get_depth_attachment();
+    if (depth_attachment >= 0) {
+        auto format = attachments[depth_attachment].format;
+
+        formats.depth_format = format;
+        if (is_depth_stencil_format(format)) {
+            formats.stencil_format = format;
+        }
+    }
+
+    return formats;
 }
\ No newline at end of file
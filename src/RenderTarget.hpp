@@ -25,6 +25,24 @@ struct rt_attachment
     vk::ImageLayout         initial_layout = vk::ImageLayout::eUndefined;
 };
 
+/**
+ * @brief 动态渲染时管线需要的附件格式，对应 VkPipelineRenderingCreateInfo
+ */
+struct RenderingFormats
+{
+    std::vector<vk::Format> color_formats;
+    vk::Format              depth_format   = vk::Format::eUndefined;
+    vk::Format              stencil_format = vk::Format::eUndefined;
+
+    /**
+     * @brief 返回的结构引用 color_formats，使用期间 RenderingFormats 需保持有效
+     */
+    vk::PipelineRenderingCreateInfo get_create_info() const
+    {
+        return vk::PipelineRenderingCreateInfo{0, color_formats, depth_format, stencil_format};
+    }
+};
+
 class vk_render_target
 {
 public:
@@ -71,6 +89,16 @@ public:
     vk::ImageLayout get_layout(uint32_t attachment) const;
     // @formatter:on
 
+    /**
+     * @brief 深度附件的下标，没有时返回 -1
+     */
+    int32_t get_depth_attachment() const;
+
+    /**
+     * @brief 输出附件作为颜色附件、第一张深度图像作为深度（模板）附件时的格式
+     */
+    RenderingFormats get_rendering_formats() const;
+
 private:
     const vk_device& device;
     vk::Extent2D               extent;
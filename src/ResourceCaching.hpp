@@ -21,6 +21,7 @@
 #include "DescriptorSet.hpp"
 #include "DescriptorSetLayout.hpp"
 #include "ImageView.hpp"
+#include "Pipeline.hpp"
 #include "RenderTarget.hpp"
 #include "ShaderModule.hpp"
 //
@@ -30,6 +31,7 @@
 //#include "resource_record.h"
 
 #include "Helpers.hpp"
+#include "Profiler.hpp"
 #include "RenderTarget.hpp"
 
 namespace std {
@@ -98,19 +100,19 @@ struct hash<vk_descriptor_pool>
     }
 };
 
-//template <>
-//struct hash<PipelineLayout>
-//{
-//	std::size_t operator()(const PipelineLayout &pipeline_layout) const
-//	{
-//		std::size_t result = 0;
-//
-//		hash_combine(result, pipeline_layout.get_handle());
-//
-//		return result;
-//	}
-//};
-//
+template<>
+struct hash<vk_pipeline_layout>
+{
+    std::size_t operator()(const vk_pipeline_layout& pipeline_layout) const
+    {
+        std::size_t result = 0;
+
+        hash_combine(result, static_cast<VkPipelineLayout>(pipeline_layout.handle()));
+
+        return result;
+    }
+};
+
 //template <>
 //struct hash<RenderPass>
 //{
@@ -184,25 +186,23 @@ struct hash<rt_attachment>
 //	}
 //};
 //
-//template <>
-//struct hash<SpecializationConstantState>
-//{
-//	std::size_t operator()(const SpecializationConstantState &specialization_constant_state) const
-//	{
-//		std::size_t result = 0;
-//
-//		for (auto constants : specialization_constant_state.get_specialization_constant_state())
-//		{
-//			hash_combine(result, constants.first);
-//			for (const auto data : constants.second)
-//			{
-//				hash_combine(result, data);
-//			}
-//		}
-//
-//		return result;
-//	}
-//};
+template<>
+struct hash<SpecializationConstantState>
+{
+    std::size_t operator()(const SpecializationConstantState& specialization_constant_state) const
+    {
+        std::size_t result = 0;
+
+        for (const auto& constants: specialization_constant_state.get_specialization_constant_state()) {
+            hash_combine(result, constants.first);
+            for (const auto data: constants.second) {
+                hash_combine(result, data);
+            }
+        }
+
+        return result;
+    }
+};
 
 template<>
 struct hash<ShaderResource>
@@ -724,6 +724,8 @@ T& request_resource(vk_device& device, std::unordered_map<std::size_t, T>& resou
     }
 
     // If we do not have it already, create and cache it
+    PROFILE_SCOPE("request_resource::build");
+
     const char* res_type = typeid(T).name();
     size_t res_id = resources.size();
 
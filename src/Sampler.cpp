@@ -8,6 +8,7 @@
 #include "Sampler.hpp"
 #include "Debug.hpp"
 #include "Device.hpp"
+#include "Helpers.hpp"
 
 vk_sampler::vk_sampler(vk_device& device, const vk::SamplerCreateInfo& info) :
     vk_unit{device.handle().createSampler(info), &device} {}
@@ -15,6 +16,39 @@ vk_sampler::vk_sampler(vk_device& device, const vk::SamplerCreateInfo& info) :
 vk_sampler::vk_sampler(vk_sampler&& other) :
     vk_unit(std::move(other)) {}
 
+std::size_t vk_sampler::compute_key(const vk::SamplerCreateInfo& info)
+{
+    std::size_t key = 0;
+    hash_combine(key, static_cast<VkSamplerCreateFlags>(info.flags));
+    hash_combine(key, static_cast<uint32_t>(info.magFilter));
+    hash_combine(key, static_cast<uint32_t>(info.minFilter));
+    hash_combine(key, static_cast<uint32_t>(info.mipmapMode));
+    hash_combine(key, static_cast<uint32_t>(info.addressModeU));
+    hash_combine(key, static_cast<uint32_t>(info.addressModeV));
+    hash_combine(key, static_cast<uint32_t>(info.addressModeW));
+    hash_combine(key, info.mipLodBias);
+    hash_combine(key, info.anisotropyEnable);
+    hash_combine(key, info.maxAnisotropy);
+    hash_combine(key, info.compareEnable);
+    hash_combine(key, static_cast<uint32_t>(info.compareOp));
+    hash_combine(key, info.minLod);
+    hash_combine(key, info.maxLod);
+    hash_combine(key, static_cast<uint32_t>(info.borderColor));
+    hash_combine(key, info.unnormalizedCoordinates);
+
+    for (auto* next = static_cast<const vk::BaseInStructure*>(info.pNext); next != nullptr; next = next->pNext) {
+        if (next->sType != vk::StructureType::eSamplerReductionModeCreateInfo) {
+            throw std::runtime_error(fmt::format("采样器缓存不支持 pNext 结构 {}", vk::to_string(next->sType)));
+        }
+
+        auto* reduction = reinterpret_cast<const vk::SamplerReductionModeCreateInfo*>(next);
+        hash_combine(key, static_cast<uint32_t>(next->sType));
+        hash_combine(key, static_cast<uint32_t>(reduction->reductionMode));
+    }
+
+    return key;
+}
+
 vk_sampler::~vk_sampler()
 {
     if (handle()) {
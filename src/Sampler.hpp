@@ -16,6 +16,11 @@ public:
     vk_sampler(vk_device &device, const vk::SamplerCreateInfo &info);
     vk_sampler(vk_sampler &&sampler);
 
+    /**
+     * @brief 由完整的 SamplerCreateInfo 计算缓存键，pNext 只支持 SamplerReductionModeCreateInfo
+     */
+    static std::size_t compute_key(const vk::SamplerCreateInfo &info);
+
     ~vk_sampler();
 
     vk_sampler(const vk_sampler &) = delete;
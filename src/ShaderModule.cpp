@@ -8,8 +8,9 @@
 #include "ShaderModule.hpp"
 #include "Device.hpp"
 #include "ShaderUtils.hpp"
+#include "Profiler.hpp"
 
-inline std::vector<std::string> precompile_shader(const std::string& source)
+inline std::vector<std::string> precompile_shader(const std::string& source, std::vector<std::string>& includes)
 {
     std::vector<std::string> final_file;
 
@@ -24,7 +25,11 @@ inline std::vector<std::string> precompile_shader(const std::string& source)
                 include_path = include_path.substr(0, last_quote);
             }
 
-            auto include_file = precompile_shader(read_shader(include_path));
+            if (std::find(includes.begin(), includes.end(), include_path) == includes.end()) {
+                includes.push_back(include_path);
+            }
+
+            auto include_file = precompile_shader(read_shader(include_path), includes);
             for (auto& include_file_line: include_file) {
                 final_file.push_back(include_file_line);
             }
@@ -68,27 +73,46 @@ ShaderModule::ShaderModule(vk_device& device, VkShaderStageFlagBits stage, const
         throw VulkanException{vk::Result::eErrorInitializationFailed};
     }
 
+    PROFILE_SCOPE("ShaderModule::create");
+
+    // 源文件与其 #include 的文件都是热重载需要监视的依赖
+    if (!glsl_source.get_filename().empty()) {
+        dependencies.push_back(glsl_source.get_filename());
+    }
+
     // Precompile source into the final spirv bytecode
-    auto glsl_final_source = precompile_shader(source);
+    auto glsl_final_source = [this, &source]() {
+        PROFILE_SCOPE("ShaderModule::precompile");
+        return precompile_shader(source, dependencies);
+    }();
+
+    // 反射与 id 基于未优化的二进制：优化可能剥离名称，且 id 不应随优化级别变化
+    std::vector<uint32_t> unoptimized_spirv;
 
     // Compile the GLSL source
-    GLSLCompiler glsl_compiler;
-    if (!glsl_compiler.compile_to_spirv(stage, convert_to_bytes(glsl_final_source), entry_point, shader_variant, spirv,
-                                        info_log)) {
-        LOGE("Shader compilation failed for shader \"{}\"", glsl_source.get_filename());
-        LOGE("{}", info_log);
-        throw VulkanException{vk::Result::eErrorInitializationFailed};
+    {
+        PROFILE_SCOPE("ShaderModule::compile");
+        GLSLCompiler glsl_compiler;
+        if (!glsl_compiler.compile_to_spirv(stage, convert_to_bytes(glsl_final_source), entry_point, shader_variant,
+                                            spirv, info_log, &unoptimized_spirv)) {
+            LOGE("Shader compilation failed for shader \"{}\"", glsl_source.get_filename());
+            LOGE("{}", info_log);
+            throw VulkanException{vk::Result::eErrorInitializationFailed};
+        }
     }
 
-    SPIRVReflection spirv_reflection;
-    if (!spirv_reflection.reflect_shader_resources(stage, spirv, resources, shader_variant)) {
-        throw VulkanException{vk::Result::eErrorInitializationFailed};
+    {
+        PROFILE_SCOPE("ShaderModule::reflect");
+        SPIRVReflection spirv_reflection;
+        if (!spirv_reflection.reflect_shader_resources(stage, unoptimized_spirv, resources, shader_variant)) {
+            throw VulkanException{vk::Result::eErrorInitializationFailed};
+        }
     }
 
     // Generate a unique id, determined by source and variant
     std::hash<std::string> hasher{};
-    id = hasher(std::string{reinterpret_cast<const char*>(spirv.data()),
-                            reinterpret_cast<const char*>(spirv.data() + spirv.size())});
+    id = hasher(std::string{reinterpret_cast<const char*>(unoptimized_spirv.data()),
+                            reinterpret_cast<const char*>(unoptimized_spirv.data() + unoptimized_spirv.size())});
 }
 
 ShaderModule::ShaderModule(ShaderModule&& other) noexcept :
@@ -99,7 +123,8 @@ ShaderModule::ShaderModule(ShaderModule&& other) noexcept :
     debug_name{other.debug_name},
     spirv{other.spirv},
     resources{other.resources},
-    info_log{other.info_log}
+    info_log{other.info_log},
+    dependencies{other.dependencies}
 {
     other.stage = {};
 }
@@ -134,6 +159,11 @@ const std::vector<uint32_t>& ShaderModule::get_binary() const
     return spirv;
 }
 
+const std::vector<std::string>& ShaderModule::get_dependencies() const
+{
+    return dependencies;
+}
+
 void ShaderModule::set_resource_mode(const std::string& resource_name, const ShaderResourceMode& resource_mode)
 {
     auto it = std::find_if(resources.begin(), resources.end(),
@@ -213,6 +243,13 @@ void ShaderVariant::set_runtime_array_sizes(const std::unordered_map<std::string
     this->runtime_array_sizes = sizes;
 }
 
+void ShaderVariant::add_dynamic_resource(const std::string& resource_name)
+{
+    dynamic_resources.insert(resource_name);
+
+    update_id();
+}
+
 const std::string& ShaderVariant::get_preamble() const
 {
     return preamble;
@@ -228,18 +265,30 @@ const std::unordered_map<std::string, size_t>& ShaderVariant::get_runtime_array_
     return runtime_array_sizes;
 }
 
+const std::set<std::string>& ShaderVariant::get_dynamic_resources() const
+{
+    return dynamic_resources;
+}
+
 void ShaderVariant::clear()
 {
     preamble.clear();
     processes.clear();
     runtime_array_sizes.clear();
+    dynamic_resources.clear();
     update_id();
 }
 
 void ShaderVariant::update_id()
 {
+    // 动态描述符改变描述符集布局，因此也参与变体 id
+    std::string key = preamble;
+    for (const auto& resource_name: dynamic_resources) {
+        key.append("#dynamic " + resource_name + "\n");
+    }
+
     std::hash<std::string> hasher{};
-    id = hasher(preamble);
+    id = hasher(key);
 }
 
 ShaderSource::ShaderSource(const std::string& filename) :
@@ -260,6 +309,18 @@ const std::string& ShaderSource::get_filename() const
     return filename;
 }
 
+bool ShaderSource::reload()
+{
+    if (filename.empty()) {
+        return false;
+    }
+
+    auto previous_id = id;
+    set_source(read_shader(filename));
+
+    return id != previous_id;
+}
+
 void ShaderSource::set_source(const std::string& source_)
 {
     source = source_;
@@ -10,6 +10,8 @@
 #include "VkCommon.hpp"
 #include "Helpers.hpp"
 
+#include <set>
+
 class vk_device;
 
 enum class ShaderResourceType
@@ -97,12 +99,19 @@ public:
 
     void set_runtime_array_sizes(const std::unordered_map<std::string, size_t>& sizes);
 
+    /**
+     * @brief 反射时把同名的 uniform / storage 缓冲区标记为动态描述符，绑定时通过动态偏移选择数据
+     */
+    void add_dynamic_resource(const std::string& resource_name);
+
     const std::string& get_preamble() const;
 
     const std::vector<std::string>& get_processes() const;
 
     const std::unordered_map<std::string, size_t>& get_runtime_array_sizes() const;
 
+    const std::set<std::string>& get_dynamic_resources() const;
+
     void clear();
 
 private:
@@ -114,6 +123,8 @@ private:
 
     std::unordered_map<std::string, size_t> runtime_array_sizes;
 
+    std::set<std::string> dynamic_resources;
+
     void update_id();
 };
 
@@ -130,6 +141,11 @@ public:
 
     void set_source(const std::string& source);
 
+    /**
+     * @brief 从文件重新读取源码，内容变化时返回 true；没有文件名的内嵌源码始终返回 false
+     */
+    bool reload();
+
     const std::string& get_source() const;
 
 private:
@@ -169,6 +185,11 @@ public:
 
     const std::vector<uint32_t>& get_binary() const;
 
+    /**
+     * @brief 编译时读取的文件：源文件（若有）以及递归展开的 #include 文件
+     */
+    const std::vector<std::string>& get_dependencies() const;
+
     inline const std::string& get_debug_name() const
     {
         return debug_name;
@@ -202,4 +223,6 @@ private:
     std::vector<ShaderResource> resources;
 
     std::string info_log;
+
+    std::vector<std::string> dependencies;
 };
\ No newline at end of file
@@ -0,0 +1,404 @@
+﻿/**
+ * @File ShaderReloader.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "ShaderReloader.hpp"
+#include "Device.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <tuple>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// 编辑器保存时往往产生多个事件，收到第一个事件后再等待这么久合并为一批
+constexpr int DEBOUNCE_MS = 50;
+
+// 检查停止标志的间隔
+constexpr int POLL_INTERVAL_MS = 100;
+
+using InterfaceKey = std::tuple<uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+                                uint32_t, uint32_t, uint32_t, uint32_t>;
+
+std::vector<InterfaceKey> collect_interface(const ShaderModule& shader_module)
+{
+    std::vector<InterfaceKey> keys;
+
+    for (const auto& resource: shader_module.get_resources()) {
+        // 片段着色器的输入由上一阶段决定，输出不影响管线布局
+        if (resource.type == ShaderResourceType::Output) {
+            continue;
+        }
+        if (resource.type == ShaderResourceType::Input && shader_module.get_stage() != VK_SHADER_STAGE_VERTEX_BIT) {
+            continue;
+        }
+
+        keys.emplace_back(static_cast<uint32_t>(resource.type), static_cast<uint32_t>(resource.mode), resource.set,
+                          resource.binding, resource.location, resource.input_attachment_index, resource.vec_size,
+                          resource.columns, resource.array_size, resource.offset, resource.size,
+                          resource.constant_id);
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    return keys;
+}
+}        // namespace
+
+vk_shader_reloader::vk_shader_reloader(vk_device& device, uint32_t frames_in_flight) :
+    device{device},
+    frames_in_flight{frames_in_flight}
+{
+#ifdef __linux__
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        throw std::runtime_error(fmt::format("inotify_init1 失败: {}", std::strerror(errno)));
+    }
+#else
+    LOGW("当前平台没有 inotify，着色器热重载以轮询文件修改时间的方式工作");
+#endif
+
+    watcher = std::thread(&vk_shader_reloader::watch_loop, this);
+}
+
+vk_shader_reloader::~vk_shader_reloader()
+{
+    stopping = true;
+    if (watcher.joinable()) {
+        watcher.join();
+    }
+
+#ifdef __linux__
+    if (inotify_fd >= 0) {
+        close(inotify_fd);
+    }
+#endif
+
+    for (auto& reload: pending) {
+        vkDestroyPipeline(device.handle(), reload.pipeline, nullptr);
+    }
+    pending.clear();
+
+    for (auto& object: retired) {
+        object.destroy();
+    }
+    retired.clear();
+}
+
+void vk_shader_reloader::add_program(const std::vector<ShaderStageDesc>& stages,
+                                     const std::vector<const ShaderModule*>& modules,
+                                     ShaderPipelineBuilder build,
+                                     ShaderReloadCallback on_reload)
+{
+    assert(stages.size() == modules.size());
+
+    Program program;
+    program.stages          = stages;
+    program.initial_modules = modules;
+    program.build           = std::move(build);
+    program.on_reload       = std::move(on_reload);
+    program.latest_modules.resize(stages.size());
+
+    for (size_t i = 0; i < stages.size(); ++i) {
+        std::set<std::string> dependencies;
+        for (const auto& dependency: modules[i]->get_dependencies()) {
+            dependencies.insert(normalize_path(dependency));
+        }
+
+        program.sources.push_back(stages[i].filename.empty() ? ShaderSource{} : ShaderSource{stages[i].filename});
+        program.dependencies.push_back(std::move(dependencies));
+    }
+
+    std::lock_guard<std::mutex> lock{mutex};
+
+    for (const auto& dependencies: program.dependencies) {
+        for (const auto& dependency: dependencies) {
+            watch_file(dependency);
+        }
+    }
+
+    programs.push_back(std::move(program));
+}
+
+void vk_shader_reloader::update()
+{
+    ++frame_number;
+
+    std::vector<PendingReload>        ready;
+    std::vector<ShaderReloadCallback> callbacks;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        ready.swap(pending);
+        for (const auto& reload: ready) {
+            callbacks.push_back(programs[reload.program].on_reload);
+        }
+    }
+
+    for (size_t i = 0; i < ready.size(); ++i) {
+        PROFILE_SCOPE("vk_shader_reloader::apply");
+        callbacks[i](ready[i].pipeline);
+    }
+
+    while (!retired.empty() && retired.front().frame + frames_in_flight <= frame_number) {
+        retired.front().destroy();
+        retired.pop_front();
+    }
+}
+
+void vk_shader_reloader::defer_destroy(std::function<void()>&& destroy)
+{
+    retired.push_back({frame_number, std::move(destroy)});
+}
+
+bool vk_shader_reloader::is_interface_compatible(const ShaderModule& lhs, const ShaderModule& rhs)
+{
+    return lhs.get_stage() == rhs.get_stage() && collect_interface(lhs) == collect_interface(rhs);
+}
+
+std::string vk_shader_reloader::normalize_path(const std::string& path)
+{
+    std::error_code error;
+    auto            absolute = std::filesystem::absolute(path, error);
+
+    return error ? path : absolute.lexically_normal().string();
+}
+
+void vk_shader_reloader::watch_loop()
+{
+    while (!stopping) {
+        auto changed_files = wait_for_changes();
+        if (!changed_files.empty()) {
+            rebuild(changed_files);
+        }
+    }
+}
+
+std::set<std::string> vk_shader_reloader::wait_for_changes()
+{
+    std::set<std::string> changed_files;
+
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+
+    int timeout = POLL_INTERVAL_MS;
+    while (!stopping) {
+        pollfd descriptor{inotify_fd, POLLIN, 0};
+        int    ready = poll(&descriptor, 1, timeout);
+        if (ready <= 0) {
+            // 已收到事件且去抖时间内没有新事件，这一批结束
+            if (!changed_files.empty()) {
+                break;
+            }
+            continue;
+        }
+
+        ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock{mutex};
+        for (char* ptr = buffer; ptr < buffer + length;) {
+            auto* event = reinterpret_cast<inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            auto it = watch_directories.find(event->wd);
+            if (it == watch_directories.end() || event->len == 0) {
+                continue;
+            }
+
+            changed_files.insert(normalize_path(it->second + "/" + event->name));
+        }
+
+        timeout = DEBOUNCE_MS;
+    }
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS * 5));
+
+    std::lock_guard<std::mutex> lock{mutex};
+    for (auto& [path, write_time]: write_times) {
+        std::error_code error;
+        auto            current = std::filesystem::last_write_time(path, error);
+        if (!error && current != write_time) {
+            write_time = current;
+            changed_files.insert(path);
+        }
+    }
+#endif
+
+    return changed_files;
+}
+
+void vk_shader_reloader::rebuild(const std::set<std::string>& changed_files)
+{
+    PROFILE_SCOPE("vk_shader_reloader::rebuild");
+
+    struct StageJob
+    {
+        size_t          program;
+        size_t          stage;
+        ShaderStageDesc desc;
+        ShaderSource    source;
+        bool            include_changed;
+    };
+
+    // 在锁内挑出受影响的阶段，编译在锁外进行，避免阻塞主线程的 update()
+    std::vector<StageJob> jobs;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (size_t p = 0; p < programs.size(); ++p) {
+            const auto& program = programs[p];
+            for (size_t s = 0; s < program.stages.size(); ++s) {
+                if (program.stages[s].filename.empty()) {
+                    continue;
+                }
+
+                const auto& dependencies = program.dependencies[s];
+                auto        main_file    = normalize_path(program.stages[s].filename);
+
+                bool affected        = false;
+                bool include_changed = false;
+                for (const auto& file: changed_files) {
+                    if (dependencies.count(file) != 0) {
+                        affected = true;
+                        include_changed |= file != main_file;
+                    }
+                }
+
+                if (affected) {
+                    jobs.push_back({p, s, program.stages[s], program.sources[s], include_changed});
+                }
+            }
+        }
+    }
+
+    // 每个程序本次新编译的模块，未变化的阶段为空
+    std::unordered_map<size_t, std::vector<std::unique_ptr<ShaderModule>>> compiled;
+
+    for (auto& job: jobs) {
+        try {
+            // 只保存而内容未变时不重新编译
+            bool source_changed = job.source.reload();
+            if (!source_changed && !job.include_changed) {
+                continue;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+
+            auto shader_module = std::make_unique<ShaderModule>(device, job.desc.stage, job.source,
+                                                                job.desc.entry_point, job.desc.variant);
+
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+            LOGI("重新编译着色器 {}: {:.1f} ms", job.desc.filename, elapsed.count());
+
+            std::set<std::string> dependencies;
+            for (const auto& dependency: shader_module->get_dependencies()) {
+                dependencies.insert(normalize_path(dependency));
+            }
+
+            std::lock_guard<std::mutex> lock{mutex};
+
+            auto& program = programs[job.program];
+            program.sources[job.stage] = job.source;
+
+            // #include 可能增减，新的依赖也需要监视
+            for (const auto& dependency: dependencies) {
+                watch_file(dependency);
+            }
+            program.dependencies[job.stage] = std::move(dependencies);
+
+            auto& modules = compiled[job.program];
+            modules.resize(program.stages.size());
+            modules[job.stage] = std::move(shader_module);
+        } catch (const std::exception& e) {
+            LOGE("重新编译着色器 {} 失败，继续使用旧版本: {}", job.desc.filename, e.what());
+        }
+    }
+
+    // 管线同样在监视线程上创建，帧边界只交换句柄
+    for (auto& [program_index, modules]: compiled) {
+        ShaderPipelineBuilder            build;
+        std::vector<const ShaderModule*> current(modules.size());
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            const auto& program = programs[program_index];
+
+            build = program.build;
+            for (size_t s = 0; s < modules.size(); ++s) {
+                if (modules[s]) {
+                    current[s] = modules[s].get();
+                } else if (program.latest_modules[s]) {
+                    current[s] = program.latest_modules[s].get();
+                } else {
+                    current[s] = program.initial_modules[s];
+                }
+            }
+        }
+
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        try {
+            PROFILE_SCOPE("vk_shader_reloader::build_pipeline");
+
+            auto start = std::chrono::steady_clock::now();
+            pipeline   = build(current);
+
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+            LOGI("重新创建管线: {:.1f} ms", elapsed.count());
+        } catch (const std::exception& e) {
+            LOGE("重新创建管线失败，继续使用旧版本: {}", e.what());
+        }
+
+        if (pipeline == VK_NULL_HANDLE) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock{mutex};
+
+        auto& program = programs[program_index];
+        for (size_t s = 0; s < modules.size(); ++s) {
+            if (modules[s]) {
+                program.latest_modules[s] = std::move(modules[s]);
+            }
+        }
+
+        pending.push_back({program_index, pipeline});
+    }
+}
+
+void vk_shader_reloader::watch_file(const std::string& path)
+{
+#ifdef __linux__
+    // 监视所在目录而不是文件本身：编辑器常以“写临时文件再重命名”的方式保存，文件级监视会丢失
+    auto directory = std::filesystem::path(path).parent_path().string();
+
+    for (const auto& [wd, watched]: watch_directories) {
+        if (watched == directory) {
+            return;
+        }
+    }
+
+    int wd = inotify_add_watch(inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (wd < 0) {
+        LOGW("无法监视目录 {}: {}", directory, std::strerror(errno));
+        return;
+    }
+
+    watch_directories[wd] = directory;
+#else
+    if (write_times.count(path) == 0) {
+        std::error_code error;
+        write_times[path] = std::filesystem::last_write_time(path, error);
+    }
+#endif
+}
@@ -0,0 +1,154 @@
+﻿/**
+ * @File ShaderReloader.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 着色器热重载：监视源文件及其 #include 依赖，后台重新编译着色器与管线，在帧边界替换
+ */
+
+#pragma once
+
+#include "VkCommon.hpp"
+#include "ShaderModule.hpp"
+
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+
+class vk_device;
+
+/**
+ * @brief 程序中的一个着色器阶段，filename 为空的内嵌源码不参与热重载
+ */
+struct ShaderStageDesc
+{
+    VkShaderStageFlagBits stage{VK_SHADER_STAGE_VERTEX_BIT};
+    std::string           filename;
+    std::string           entry_point{"main"};
+    ShaderVariant         variant;
+};
+
+/**
+ * @brief 在监视线程上调用，用各阶段的最新模块创建管线。modules 与注册时的阶段一一对应，
+ *        未受文件变化影响的阶段为上一次成功重载的模块或注册时的模块。
+ *        只能访问创建后不再变化的状态（设备、管线布局、渲染通道等）；返回 VK_NULL_HANDLE 或抛出异常表示失败，
+ *        失败时沿用旧管线
+ */
+using ShaderPipelineBuilder = std::function<VkPipeline(const std::vector<const ShaderModule*>& modules)>;
+
+/**
+ * @brief 在 update() 中调用，pipeline 为已创建好的新管线，由回调接管其所有权
+ */
+using ShaderReloadCallback = std::function<void(VkPipeline pipeline)>;
+
+/**
+ * @brief Linux 上使用 inotify 监视依赖文件所在目录，其他平台退化为轮询修改时间。
+ *        文件变化后在后台线程重新编译受影响的阶段并创建新管线，update() 只把完成的管线交给回调；
+ *        回调替换下来的旧对象通过 defer_destroy() 延迟到 frames_in_flight 帧之后销毁
+ */
+class vk_shader_reloader
+{
+public:
+    vk_shader_reloader(vk_device& device, uint32_t frames_in_flight);
+
+    /**
+     * @brief 停止监视线程，销毁尚未交出的管线并立即执行所有延迟销毁，调用前设备需要空闲
+     */
+    ~vk_shader_reloader();
+
+    vk_shader_reloader(const vk_shader_reloader&) = delete;
+    vk_shader_reloader(vk_shader_reloader&&) = delete;
+
+    vk_shader_reloader& operator=(const vk_shader_reloader&) = delete;
+    vk_shader_reloader& operator=(vk_shader_reloader&&) = delete;
+
+    /**
+     * @brief 注册一组阶段，modules 为当前已编译的模块，用于确定初始的依赖文件，
+     *        并在只有部分阶段变化时交给 build；这些模块需要在热重载器销毁前保持有效
+     */
+    void add_program(const std::vector<ShaderStageDesc>& stages,
+                     const std::vector<const ShaderModule*>& modules,
+                     ShaderPipelineBuilder build,
+                     ShaderReloadCallback on_reload);
+
+    /**
+     * @brief 每帧在 in-flight 栅栏等待之后调用：交出已创建的新管线，销毁已退役的对象
+     */
+    void update();
+
+    void defer_destroy(std::function<void()>&& destroy);
+
+    /**
+     * @brief 两个模块的描述符、推送常量与特化常量接口（以及顶点输入）是否一致，
+     *        一致时新模块可以沿用旧的管线布局与描述符集
+     */
+    static bool is_interface_compatible(const ShaderModule& lhs, const ShaderModule& rhs);
+
+private:
+    struct Program
+    {
+        std::vector<ShaderStageDesc>       stages;
+        std::vector<ShaderSource>          sources;
+        std::vector<std::set<std::string>> dependencies;        // 每个阶段规范化后的依赖路径
+        std::vector<const ShaderModule*>   initial_modules;
+        ShaderPipelineBuilder              build;
+        ShaderReloadCallback               on_reload;
+
+        // 上一次成功创建管线所用的模块，只在监视线程中读写（程序列表本身仍受 mutex 保护）
+        std::vector<std::unique_ptr<ShaderModule>> latest_modules;
+    };
+
+    struct PendingReload
+    {
+        size_t     program;
+        VkPipeline pipeline;
+    };
+
+    struct RetiredObject
+    {
+        uint64_t              frame;
+        std::function<void()> destroy;
+    };
+
+    static std::string normalize_path(const std::string& path);
+
+    void watch_loop();
+
+    /**
+     * @brief 阻塞等待一批文件变化（带去抖），返回规范化后的路径；停止时返回空集合
+     */
+    std::set<std::string> wait_for_changes();
+
+    void rebuild(const std::set<std::string>& changed_files);
+
+    // 调用方需持有 mutex
+    void watch_file(const std::string& path);
+
+    vk_device& device;
+
+    uint32_t frames_in_flight;
+
+    uint64_t frame_number{0};
+
+    std::mutex                 mutex;
+    std::vector<Program>       programs;
+    std::vector<PendingReload> pending;
+
+    // 只在主线程访问
+    std::deque<RetiredObject> retired;
+
+#ifdef __linux__
+    int inotify_fd{-1};
+
+    std::unordered_map<int, std::string> watch_directories;
+#else
+    std::unordered_map<std::string, std::filesystem::file_time_type> write_times;
+#endif
+
+    std::atomic<bool> stopping{false};
+
+    std::thread watcher;
+};
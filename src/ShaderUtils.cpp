@@ -14,8 +14,15 @@ VKBP_DISABLE_WARNINGS()
 #include <glslang/Include/ShHandle.h>
 #include <glslang/OSDependent/osinclude.h>
 #include <glslang/Public/ResourceLimits.h>
+#ifdef VK_ENABLE_SPIRV_OPT
+#include <spirv-tools/optimizer.hpp>
+#endif
 VKBP_ENABLE_WARNINGS()
 
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+
 namespace {
 template<ShaderResourceType T>
 inline void read_shader_resource(const spirv_cross::Compiler& compiler,
@@ -125,6 +132,13 @@ inline void read_resource_size(const spirv_cross::Compiler& compiler,
     shader_resource.size = to_u32(compiler.get_declared_struct_size_runtime_array(spirv_type, array_size));
 }
 
+inline void read_resource_mode(ShaderResource& shader_resource, const ShaderVariant& variant)
+{
+    shader_resource.mode = variant.get_dynamic_resources().count(shader_resource.name) != 0
+                           ? ShaderResourceMode::Dynamic
+                           : ShaderResourceMode::Static;
+}
+
 inline void read_resource_size(const spirv_cross::Compiler& compiler,
                                const spirv_cross::SPIRConstant& constant,
                                ShaderResource& shader_resource,
@@ -322,6 +336,8 @@ inline void read_shader_resource<ShaderResourceType::BufferUniform>(const spirv_
         shader_resource.stages = stage;
         shader_resource.name   = resource.name;
 
+        read_resource_mode(shader_resource, variant);
+
         read_resource_size(compiler, resource, shader_resource, variant);
         read_resource_array_size(compiler, resource, shader_resource, variant);
         read_resource_decoration<spv::DecorationDescriptorSet>(compiler, resource, shader_resource, variant);
@@ -340,11 +356,13 @@ inline void read_shader_resource<ShaderResourceType::BufferStorage>(const spirv_
     auto storage_resources = compiler.get_shader_resources().storage_buffers;
 
     for (auto& resource: storage_resources) {
-        ShaderResource shader_resource;
+        ShaderResource shader_resource{};
         shader_resource.type   = ShaderResourceType::BufferStorage;
         shader_resource.stages = stage;
         shader_resource.name   = resource.name;
 
+        read_resource_mode(shader_resource, variant);
+
         read_resource_size(compiler, resource, shader_resource, variant);
         read_resource_array_size(compiler, resource, shader_resource, variant);
         read_resource_decoration<spv::DecorationNonReadable>(compiler, resource, shader_resource, variant);
@@ -492,9 +510,58 @@ inline EShLanguage FindShaderLanguage(VkShaderStageFlagBits stage)
 }
 }        // namespace
 
+namespace {
+std::mutex             statistics_mutex;
+SpirvCompileStatistics statistics;
+
+/**
+ * @brief 在 glslang 输出之后运行 SPIRV-Tools 优化；失败时保留原始二进制
+ */
+void optimize_spirv(const std::vector<std::uint32_t>& input, std::vector<std::uint32_t>& output,
+                    SpirvOptimizationLevel level, bool strip_debug_info, std::string& info_log)
+{
+#ifdef VK_ENABLE_SPIRV_OPT
+    spvtools::Optimizer optimizer(SPV_ENV_UNIVERSAL_1_6);
+    optimizer.SetMessageConsumer([&info_log](spv_message_level_t, const char*, const spv_position_t& position,
+                                             const char* message) {
+        info_log += fmt::format("spirv-opt: {} (word {})\n", message, position.index);
+    });
+
+    if (level == SpirvOptimizationLevel::Performance) {
+        optimizer.RegisterPerformancePasses();
+    } else if (level == SpirvOptimizationLevel::Size) {
+        optimizer.RegisterSizePasses();
+    }
+
+    if (strip_debug_info) {
+        optimizer.RegisterPass(spvtools::CreateStripDebugInfoPass());
+        optimizer.RegisterPass(spvtools::CreateStripNonSemanticInfoPass());
+    }
+
+    if (!optimizer.Run(input.data(), input.size(), &output)) {
+        LOGW("SPIR-V 优化失败，使用未优化的二进制");
+        output = input;
+    }
+#else
+    (void) level;
+    (void) strip_debug_info;
+    (void) info_log;
+    output = input;
+#endif
+}
+}        // namespace
+
 glslang::EShTargetLanguage        GLSLCompiler::env_target_language         = glslang::EShTargetLanguage::EShTargetNone;
 glslang::EShTargetLanguageVersion GLSLCompiler::env_target_language_version = static_cast<glslang::EShTargetLanguageVersion>(0);
 
+#ifdef NDEBUG
+SpirvOptimizationLevel GLSLCompiler::optimization_level = SpirvOptimizationLevel::Performance;
+bool                   GLSLCompiler::strip_debug_info   = true;
+#else
+SpirvOptimizationLevel GLSLCompiler::optimization_level = SpirvOptimizationLevel::None;
+bool                   GLSLCompiler::strip_debug_info   = false;
+#endif
+
 void GLSLCompiler::set_target_environment(glslang::EShTargetLanguage target_language,
                                           glslang::EShTargetLanguageVersion target_language_version)
 {
@@ -508,13 +575,59 @@ void GLSLCompiler::reset_target_environment()
     GLSLCompiler::env_target_language_version = static_cast<glslang::EShTargetLanguageVersion>(0);
 }
 
+void GLSLCompiler::set_optimization(SpirvOptimizationLevel level, bool strip_debug_info)
+{
+#ifndef VK_ENABLE_SPIRV_OPT
+    if (level != SpirvOptimizationLevel::None || strip_debug_info) {
+        LOGW("未启用 VK_ENABLE_SPIRV_OPT，SPIR-V 优化与调试信息剥离不会生效");
+    }
+#endif
+
+    GLSLCompiler::optimization_level = level;
+    GLSLCompiler::strip_debug_info   = strip_debug_info;
+}
+
+SpirvOptimizationLevel GLSLCompiler::get_optimization_level()
+{
+    return GLSLCompiler::optimization_level;
+}
+
+bool GLSLCompiler::get_strip_debug_info()
+{
+    return GLSLCompiler::strip_debug_info;
+}
+
+SpirvCompileStatistics GLSLCompiler::get_statistics()
+{
+    std::lock_guard<std::mutex> lock{statistics_mutex};
+    return statistics;
+}
+
+void GLSLCompiler::log_statistics()
+{
+    auto stats = get_statistics();
+    if (stats.module_count == 0) {
+        return;
+    }
+
+    LOGI("SPIR-V: {} 个模块，{} -> {} 字节 ({:.1f}%)，编译 {:.2f} ms，优化 {:.2f} ms",
+         stats.module_count, stats.unoptimized_bytes, stats.optimized_bytes,
+         100.0 * static_cast<double>(stats.optimized_bytes) / static_cast<double>(stats.unoptimized_bytes),
+         stats.compile_ms, stats.optimize_ms);
+}
+
 bool GLSLCompiler::compile_to_spirv(VkShaderStageFlagBits stage,
                                     const std::vector<uint8_t>& glsl_source,
                                     const std::string& entry_point,
                                     const ShaderVariant& shader_variant,
                                     std::vector<std::uint32_t>& spirv,
-                                    std::string& info_log)
+                                    std::string& info_log,
+                                    std::vector<std::uint32_t>* unoptimized_spirv)
 {
+    using clock = std::chrono::steady_clock;
+
+    auto compile_start = clock::now();
+
     // Initialize glslang library.
     glslang::InitializeProcess();
 
@@ -571,12 +684,110 @@ bool GLSLCompiler::compile_to_spirv(VkShaderStageFlagBits stage,
 
     spv::SpvBuildLogger logger;
 
-    glslang::GlslangToSpv(*intermediate, spirv, &logger);
+    // 未优化的二进制保留名称等调试信息，反射与模块 id 都基于它，因此与优化级别无关
+    std::vector<std::uint32_t> unoptimized;
+    glslang::GlslangToSpv(*intermediate, unoptimized, &logger);
 
     info_log += logger.getAllMessages() + "\n";
 
+    auto optimize_start = clock::now();
+
+    if (optimization_level != SpirvOptimizationLevel::None || strip_debug_info) {
+        optimize_spirv(unoptimized, spirv, optimization_level, strip_debug_info, info_log);
+    } else {
+        spirv = unoptimized;
+    }
+
+    auto optimize_end = clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock{statistics_mutex};
+        statistics.module_count += 1;
+        statistics.unoptimized_bytes += unoptimized.size() * sizeof(std::uint32_t);
+        statistics.optimized_bytes += spirv.size() * sizeof(std::uint32_t);
+        statistics.compile_ms += std::chrono::duration<double, std::milli>(optimize_start - compile_start).count();
+        statistics.optimize_ms += std::chrono::duration<double, std::milli>(optimize_end - optimize_start).count();
+    }
+
+    if (unoptimized_spirv) {
+        *unoptimized_spirv = std::move(unoptimized);
+    }
+
     // Shutdown glslang library.
     glslang::FinalizeProcess();
 
     return true;
-}
\ No newline at end of file
+}
+
+void run_spirv_optimization_benchmark(const std::vector<std::pair<VkShaderStageFlagBits, std::string>>& sources,
+                                      uint32_t iterations)
+{
+    using clock = std::chrono::steady_clock;
+
+    struct Config
+    {
+        const char*            name;
+        SpirvOptimizationLevel level;
+        bool                   strip;
+    };
+
+    const Config configs[] = {
+        {"none", SpirvOptimizationLevel::None, false},
+        {"none + strip", SpirvOptimizationLevel::None, true},
+        {"performance", SpirvOptimizationLevel::Performance, false},
+        {"performance + strip", SpirvOptimizationLevel::Performance, true},
+        {"size + strip", SpirvOptimizationLevel::Size, true},
+    };
+
+    // 提前返回时同样恢复之前的设置，避免进程中后续的编译沿用基准的优化级别
+    struct OptimizationRestorer
+    {
+        SpirvOptimizationLevel level;
+        bool                   strip;
+
+        ~OptimizationRestorer()
+        {
+            GLSLCompiler::set_optimization(level, strip);
+        }
+    } restorer{GLSLCompiler::get_optimization_level(), GLSLCompiler::get_strip_debug_info()};
+
+    std::printf("SPIR-V optimization benchmark: %zu shaders, %u iterations\n", sources.size(), iterations);
+#ifndef VK_ENABLE_SPIRV_OPT
+    std::printf("  (VK_ENABLE_SPIRV_OPT is off, every configuration emits the unoptimized binary)\n");
+#endif
+
+    for (const auto& config: configs) {
+        GLSLCompiler::set_optimization(config.level, config.strip);
+
+        size_t unoptimized_bytes = 0;
+        size_t optimized_bytes   = 0;
+        double total_ms          = 0.0;
+
+        for (const auto& [stage, source]: sources) {
+            std::vector<uint8_t> bytes(source.begin(), source.end());
+
+            for (uint32_t i = 0; i < iterations; ++i) {
+                std::vector<std::uint32_t> spirv;
+                std::vector<std::uint32_t> unoptimized;
+                std::string                info_log;
+
+                auto start = clock::now();
+                if (!GLSLCompiler{}.compile_to_spirv(stage, bytes, "main", ShaderVariant{}, spirv, info_log,
+                                                     &unoptimized)) {
+                    std::printf("  compile failed: %s\n", info_log.c_str());
+                    return;
+                }
+                total_ms += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+                if (i == 0) {
+                    unoptimized_bytes += unoptimized.size() * sizeof(std::uint32_t);
+                    optimized_bytes += spirv.size() * sizeof(std::uint32_t);
+                }
+            }
+        }
+
+        std::printf("  %-20s %8zu -> %8zu bytes (%5.1f%%)  %8.2f ms/iteration\n", config.name, unoptimized_bytes,
+                    optimized_bytes, 100.0 * static_cast<double>(optimized_bytes) / static_cast<double>(unoptimized_bytes),
+                    total_ms / iterations);
+    }
+}
@@ -37,12 +37,38 @@ private:
                                         const ShaderVariant& variant);
 };
 
+/**
+ * @brief 编译后的 SPIR-V 优化级别，需要开启 CMake 选项 VK_ENABLE_SPIRV_OPT 并找到 SPIRV-Tools-opt，
+ *        否则优化与剥离都不生效
+ */
+enum class SpirvOptimizationLevel
+{
+    None,
+    Performance,
+    Size
+};
+
+/**
+ * @brief 累计的编译统计，用于比较优化前后的模块大小与耗时
+ */
+struct SpirvCompileStatistics
+{
+    uint32_t module_count{0};
+    size_t   unoptimized_bytes{0};
+    size_t   optimized_bytes{0};
+    double   compile_ms{0.0};
+    double   optimize_ms{0.0};
+};
+
 class GLSLCompiler
 {
 private:
     static glslang::EShTargetLanguage        env_target_language;
     static glslang::EShTargetLanguageVersion env_target_language_version;
 
+    static SpirvOptimizationLevel optimization_level;
+    static bool                   strip_debug_info;
+
 public:
     static void set_target_environment(glslang::EShTargetLanguage        target_language,
                                        glslang::EShTargetLanguageVersion target_language_version);
@@ -52,10 +78,35 @@ public:
      */
     static void reset_target_environment();
 
+    /**
+     * @brief 设置之后所有编译使用的优化级别，默认 Release 为 Performance 并剥离调试信息，Debug 不优化
+     */
+    static void set_optimization(SpirvOptimizationLevel level, bool strip_debug_info);
+
+    static SpirvOptimizationLevel get_optimization_level();
+
+    static bool get_strip_debug_info();
+
+    static SpirvCompileStatistics get_statistics();
+
+    static void log_statistics();
+
+    /**
+     * @param spirv 最终交给驱动的（可能已优化的）二进制
+     * @param unoptimized_spirv 非空时写入未优化、保留名称的二进制，用于反射与计算稳定的模块 id；
+     *        未启用优化时与 spirv 相同
+     */
     bool compile_to_spirv(VkShaderStageFlagBits       stage,
                           const std::vector<uint8_t> &glsl_source,
                           const std::string &         entry_point,
                           const ShaderVariant &       shader_variant,
                           std::vector<std::uint32_t> &spirv,
-                          std::string &               info_log);
+                          std::string &               info_log,
+                          std::vector<std::uint32_t> *unoptimized_spirv = nullptr);
 };
+
+/**
+ * @brief 以各优化级别编译给定的着色器，输出 SPIR-V 大小与编译耗时对比
+ */
+void run_spirv_optimization_benchmark(const std::vector<std::pair<VkShaderStageFlagBits, std::string>>& sources,
+                                      uint32_t iterations);
@@ -0,0 +1,154 @@
+﻿/**
+ * @File SubmitBatcher.cpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 
+ */
+
+#include "SubmitBatcher.hpp"
+#include "Device.hpp"
+#include "Queue.hpp"
+#include "Profiler.hpp"
+
+vk_submit_batcher::vk_submit_batcher(vk_device& device, const vk_queue& queue) :
+    device{device},
+    queue{queue},
+    use_submit2{device.is_enabled(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)}
+{
+}
+
+vk_submit_batcher::~vk_submit_batcher()
+{
+    if (!pending.empty()) {
+        LOGW("队列 (family {} index {}) 仍有 {} 批工作未提交，将被丢弃",
+             queue.get_family_index(), queue.get_index(), pending.size());
+    }
+}
+
+void vk_submit_batcher::enqueue(const std::vector<vk::CommandBuffer>& command_buffers,
+                                const std::vector<SemaphoreSubmit>& wait_semaphores,
+                                const std::vector<SemaphoreSubmit>& signal_semaphores)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    ++statistics.enqueued;
+
+    // 前一批没有发出信号且这一批没有等待时，两批之间没有同步边界，可以合并为一个 SubmitInfo
+    if (!pending.empty() && pending.back().signal_semaphores.empty() && wait_semaphores.empty()) {
+        auto& batch = pending.back();
+        batch.command_buffers.insert(batch.command_buffers.end(), command_buffers.begin(), command_buffers.end());
+        batch.signal_semaphores = signal_semaphores;
+        return;
+    }
+
+    pending.push_back({command_buffers, wait_semaphores, signal_semaphores});
+}
+
+void vk_submit_batcher::flush(vk::Fence fence)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (pending.empty() && !fence) {
+        return;
+    }
+
+    PROFILE_SCOPE("vk_submit_batcher::flush");
+
+    if (use_submit2) {
+        submit2(fence);
+    } else {
+        submit_legacy(fence);
+    }
+
+    ++statistics.queue_submits;
+    statistics.submit_infos += to_u32(pending.size());
+
+    pending.clear();
+}
+
+bool vk_submit_batcher::empty() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    return pending.empty();
+}
+
+const vk_queue& vk_submit_batcher::get_queue() const
+{
+    return queue;
+}
+
+SubmitStatistics vk_submit_batcher::end_frame()
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    return std::exchange(statistics, {});
+}
+
+void vk_submit_batcher::submit2(vk::Fence fence)
+{
+    std::vector<std::vector<vk::CommandBufferSubmitInfo>> command_buffer_infos(pending.size());
+    std::vector<std::vector<vk::SemaphoreSubmitInfo>>     wait_infos(pending.size());
+    std::vector<std::vector<vk::SemaphoreSubmitInfo>>     signal_infos(pending.size());
+    std::vector<vk::SubmitInfo2>                          submit_infos(pending.size());
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        const auto& batch = pending[i];
+
+        for (auto command_buffer: batch.command_buffers) {
+            command_buffer_infos[i].emplace_back(command_buffer);
+        }
+        for (const auto& wait: batch.wait_semaphores) {
+            wait_infos[i].emplace_back(wait.semaphore, wait.value, wait.stage);
+        }
+        for (const auto& signal: batch.signal_semaphores) {
+            signal_infos[i].emplace_back(signal.semaphore, signal.value, signal.stage);
+        }
+
+        submit_infos[i].setWaitSemaphoreInfos(wait_infos[i]);
+        submit_infos[i].setCommandBufferInfos(command_buffer_infos[i]);
+        submit_infos[i].setSignalSemaphoreInfos(signal_infos[i]);
+    }
+
+    queue.get_handle().submit2KHR(submit_infos, fence);
+}
+
+void vk_submit_batcher::submit_legacy(vk::Fence fence)
+{
+    std::vector<std::vector<vk::Semaphore>>          wait_semaphores(pending.size());
+    std::vector<std::vector<vk::PipelineStageFlags>> wait_stages(pending.size());
+    std::vector<std::vector<uint64_t>>               wait_values(pending.size());
+    std::vector<std::vector<vk::Semaphore>>          signal_semaphores(pending.size());
+    std::vector<std::vector<uint64_t>>               signal_values(pending.size());
+    std::vector<vk::TimelineSemaphoreSubmitInfo>     timeline_infos(pending.size());
+    std::vector<vk::SubmitInfo>                      submit_infos(pending.size());
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        const auto& batch = pending[i];
+
+        bool timeline = false;
+        for (const auto& wait: batch.wait_semaphores) {
+            // 旧接口只有 32 位阶段掩码，synchronization2 独有的阶段位在这里被丢弃
+            wait_semaphores[i].push_back(wait.semaphore);
+            wait_stages[i].emplace_back(static_cast<VkPipelineStageFlags>(static_cast<VkPipelineStageFlags2>(wait.stage)));
+            wait_values[i].push_back(wait.value);
+            timeline |= wait.value != 0;
+        }
+        for (const auto& signal: batch.signal_semaphores) {
+            signal_semaphores[i].push_back(signal.semaphore);
+            signal_values[i].push_back(signal.value);
+            timeline |= signal.value != 0;
+        }
+
+        submit_infos[i] = vk::SubmitInfo(wait_semaphores[i], wait_stages[i], batch.command_buffers, signal_semaphores[i]);
+
+        // 二值信号量的值会被忽略，但值数组的长度需与信号量数量一致
+        if (timeline) {
+            timeline_infos[i].setWaitSemaphoreValues(wait_values[i]);
+            timeline_infos[i].setSignalSemaphoreValues(signal_values[i]);
+            submit_infos[i].pNext = &timeline_infos[i];
+        }
+    }
+
+    queue.get_handle().submit(submit_infos, fence);
+}
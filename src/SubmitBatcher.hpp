@@ -0,0 +1,111 @@
+﻿/**
+ * @File SubmitBatcher.hpp
+ * @Author dfnzhc (https://github.com/dfnzhc)
+ * @Date 2026/10/18
+ * @Brief 队列提交合并：一帧内入队的工作在刷新点以一次 vkQueueSubmit2 提交
+ */
+
+#pragma once
+
+#include "VkCommon.hpp"
+
+#include <mutex>
+
+class vk_device;
+
+class vk_queue;
+
+/**
+ * @brief 提交时等待或发出的信号量，二值信号量时 value 被忽略
+ */
+struct SemaphoreSubmit
+{
+    vk::Semaphore           semaphore;
+    uint64_t                value{0};
+    vk::PipelineStageFlags2 stage{vk::PipelineStageFlagBits2::eAllCommands};
+};
+
+inline vk::PipelineStageFlags2 to_stage_flags2(vk::PipelineStageFlags stage)
+{
+    // 旧阶段位在 synchronization2 中保持相同的数值
+    return vk::PipelineStageFlags2(static_cast<VkPipelineStageFlags2>(static_cast<VkPipelineStageFlags>(stage)));
+}
+
+/**
+ * @brief 一帧内的提交统计，saved 为合并后省下的 vkQueueSubmit 调用次数
+ */
+struct SubmitStatistics
+{
+    uint32_t enqueued{0};
+    uint32_t submit_infos{0};
+    uint32_t queue_submits{0};
+
+    uint32_t saved() const { return enqueued > queue_submits ? enqueued - queue_submits : 0; }
+};
+
+/**
+ * @brief 单个队列的提交合并器。enqueue() 只记录工作，flush() 在刷新点一次性提交全部待提交的工作；
+ *        相邻且中间没有信号量边界的批次合并进同一个 SubmitInfo。
+ *        设备开启 VK_KHR_synchronization2 时使用 vkQueueSubmit2，否则退化为一次 vkQueueSubmit 携带多个 SubmitInfo
+ */
+class vk_submit_batcher
+{
+public:
+    vk_submit_batcher(vk_device& device, const vk_queue& queue);
+
+    /**
+     * @brief 丢弃尚未提交的工作，调用前需要先 flush()
+     */
+    ~vk_submit_batcher();
+
+    vk_submit_batcher(const vk_submit_batcher&) = delete;
+    vk_submit_batcher(vk_submit_batcher&&) = delete;
+
+    vk_submit_batcher& operator=(const vk_submit_batcher&) = delete;
+    vk_submit_batcher& operator=(vk_submit_batcher&&) = delete;
+
+    /**
+     * @brief 按提交顺序记录一批工作，命令缓冲区需已结束录制且在 flush() 之前保持有效
+     */
+    void enqueue(const std::vector<vk::CommandBuffer>& command_buffers,
+                 const std::vector<SemaphoreSubmit>& wait_semaphores = {},
+                 const std::vector<SemaphoreSubmit>& signal_semaphores = {});
+
+    /**
+     * @brief 提交所有待提交的工作，fence 在全部工作完成后发出；没有工作且 fence 为空时什么都不做
+     */
+    void flush(vk::Fence fence = nullptr);
+
+    bool empty() const;
+
+    const vk_queue& get_queue() const;
+
+    /**
+     * @brief 返回并清零本帧的统计
+     */
+    SubmitStatistics end_frame();
+
+private:
+    struct Batch
+    {
+        std::vector<vk::CommandBuffer> command_buffers;
+        std::vector<SemaphoreSubmit>   wait_semaphores;
+        std::vector<SemaphoreSubmit>   signal_semaphores;
+    };
+
+    void submit2(vk::Fence fence);
+
+    void submit_legacy(vk::Fence fence);
+
+    vk_device& device;
+
+    const vk_queue& queue;
+
+    bool use_submit2{false};
+
+    mutable std::mutex mutex;
+
+    std::vector<Batch> pending;
+
+    SubmitStatistics statistics;
+};
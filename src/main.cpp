@@ -4,6 +4,7 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/hash.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -23,12 +24,29 @@
 #include "FencePool.hpp"
 #include "CommandBuffer.hpp"
 #include "CommandBufferPool.hpp"
+#include "CommandRecorder.hpp"
 #include "RenderContext.hpp"
 #include "Renderpass.hpp"
 #include "Framebuffer.hpp"
 #include "Sampler.hpp"
 #include "VkUtils.hpp"
 #include "Commands.hpp"
+#include "Profiler.hpp"
+#include "PerformanceQuery.hpp"
+#include "Defragmenter.hpp"
+#include "GeometryArena.hpp"
+#include "GpuCulling.hpp"
+#include "DrawBatcher.hpp"
+#include "RenderQueue.hpp"
+#include "ClusteredLighting.hpp"
+#include "FrustumCuller.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshletRenderer.hpp"
+#include "ShaderModule.hpp"
+#include "ShaderUtils.hpp"
+#include "Pipeline.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "ShaderReloader.hpp"
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
@@ -37,6 +55,7 @@
 #include <GLFW/glfw3.h>
 
 #include <iostream>
+#include <filesystem>
 #include <fstream>
 #include <stdexcept>
 #include <algorithm>
@@ -45,7 +64,9 @@
 #include <cstring>
 #include <cstdlib>
 #include <cstdint>
+#include <cstdio>
 #include <limits>
+#include <random>
 #include <array>
 #include <optional>
 #include <set>
@@ -59,6 +80,25 @@ const std::string TEXTURE_PATH = "../data/viking_room.png";
 
 const int MAX_FRAMES_IN_FLIGHT = 2;
 
+// 非空时场景着色器从该目录读取，并在文件修改后热重载
+std::string shaderDirectory;
+
+// 使用 VK_KHR_dynamic_rendering，不创建 VkRenderPass 与 VkFramebuffer
+bool dynamicRendering = false;
+
+// 非 0 时运行光源数量扫描基准，每个光源数量测量这么多帧
+uint32_t lightBenchmarkFrames = 0;
+
+// 场景投影的近、远平面，分簇光照与绘制排序的深度归一化也以此为范围
+const float SCENE_NEAR_PLANE = 0.1f;
+const float SCENE_FAR_PLANE  = 10.0f;
+
+// 默认场景中的点光源数量
+const uint32_t DEFAULT_LIGHT_COUNT = 256;
+
+// CPU 实例化路径在模型周围摆放 N x N 个副本，由绘制合并器合并为实例化绘制
+const uint32_t INSTANCE_GRID_SIZE = 5;
+
 const std::vector<const char*> validationLayers = {
     "VK_LAYER_KHRONOS_validation"
 };
@@ -141,11 +181,150 @@ template<> struct hash<Vertex>
 
 struct UniformBufferObject
 {
-    alignas(16) glm::mat4 model;
     alignas(16) glm::mat4 view;
     alignas(16) glm::mat4 proj;
 };
 
+/**
+ * @brief 逐绘制的小块数据走推送常量，不占用缓冲区分配与描述符更新；布局与 SCENE_VERTEX_SHADER 中的块一致。
+ *        model 为整个场景共用的变换，逐实例的摆放与反量化由 set 2 中的 InstanceData 提供
+ */
+struct DrawPushConstants
+{
+    glm::mat4 model{1.0f};
+    uint32_t  material{0};
+    uint32_t  padding[3]{};
+};
+
+/**
+ * @brief 图形管线中除着色器外的状态
+ */
+struct GraphicsPipelineState
+{
+    VkPipelineLayout layout     = VK_NULL_HANDLE;
+    VkRenderPass     renderPass = VK_NULL_HANDLE;
+    RenderingFormats renderingFormats;        // 只在动态渲染时使用
+};
+
+const char* SCENE_VERTEX_SHADER = R"(
+#version 450
+
+layout(set = 0, binding = 0) uniform UniformBufferObject
+{
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+layout(push_constant) uniform DrawPushConstants
+{
+    mat4 model;
+    uint material;
+    uint padding[3];
+} draw;
+
+// 逐实例数据，布局与 DrawBatcher.hpp 中的 InstanceData 一致
+struct InstanceData
+{
+    mat4 model;
+    vec4 params;
+};
+
+layout(std430, set = 2, binding = 0) readonly buffer Instances
+{
+    InstanceData instances[];
+};
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec2 inTexCoord;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec3 fragViewPosition;
+
+void main()
+{
+    vec4 viewPosition = ubo.view * draw.model * instances[gl_InstanceIndex].model * vec4(inPosition, 1.0);
+
+    gl_Position      = ubo.proj * viewPosition;
+    fragColor        = inColor;
+    fragTexCoord     = inTexCoord;
+    fragViewPosition = viewPosition.xyz;
+}
+)";
+
+const char* SCENE_FRAGMENT_SHADER = R"(
+#version 450
+
+layout(set = 0, binding = 1) uniform sampler2D texSampler;
+
+// 分簇光照，布局与 ClusteredLighting.hpp 一致
+layout(set = 1, binding = 0) uniform ClusterParams
+{
+    uvec4 grid;
+    vec4  screen;
+    vec4  depth;
+    vec4  ambient;
+} clusters;
+
+struct Light
+{
+    vec4 position_radius;
+    vec4 color_intensity;
+};
+
+layout(set = 1, binding = 1) readonly buffer Lights
+{
+    Light lights[];
+};
+
+layout(set = 1, binding = 2) readonly buffer ClusterCells
+{
+    uvec2 cells[];
+};
+
+layout(set = 1, binding = 3) readonly buffer LightIndices
+{
+    uint light_indices[];
+};
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) in vec3 fragViewPosition;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    vec4 albedo = texture(texSampler, fragTexCoord);
+
+    // 顶点没有法线，用视空间位置的屏幕导数求面法线，并让它朝向相机
+    vec3 normal = normalize(cross(dFdx(fragViewPosition), dFdy(fragViewPosition)));
+    if (dot(normal, fragViewPosition) > 0.0) {
+        normal = -normal;
+    }
+
+    uvec2 tile  = min(uvec2(gl_FragCoord.xy * clusters.screen.xy), clusters.grid.xy - 1u);
+    float slice = log(-fragViewPosition.z) * clusters.depth.x - clusters.depth.y;
+    uint  z     = uint(clamp(slice, 0.0, float(clusters.grid.z - 1u)));
+    uvec2 cell  = cells[(z * clusters.grid.y + tile.y) * clusters.grid.x + tile.x];
+
+    vec3 lighting = clusters.ambient.rgb;
+    for (uint i = 0; i < cell.y; ++i) {
+        Light light = lights[light_indices[cell.x + i]];
+
+        vec3  toLight     = light.position_radius.xyz - fragViewPosition;
+        float dist        = length(toLight);
+        float attenuation = clamp(1.0 - dist / light.position_radius.w, 0.0, 1.0);
+        float nDotL       = max(dot(normal, toLight / max(dist, 1e-4)), 0.0);
+
+        lighting += light.color_intensity.rgb * light.color_intensity.w * attenuation * attenuation * nDotL;
+    }
+
+    outColor = vec4(albedo.rgb * lighting, albedo.a);
+}
+)";
+
 class HelloTriangleApplication
 {
 public:
@@ -153,6 +332,7 @@ public:
     {
         initWindow();
         initVulkan();
+        GLSLCompiler::log_statistics();
         mainLoop();
         cleanup();
     }
@@ -166,7 +346,6 @@ private:
     std::unique_ptr<vk_physical_device> physicalDevice;
     std::unique_ptr<vk_device>          device;
 
-    VkQueue graphicsQueue;
     VkQueue presentQueue;
 
     VkFormat   swapChainImageFormat;
@@ -175,27 +354,62 @@ private:
     std::vector<vk_framebuffer>        framebuffers;
     std::unique_ptr<vk_render_context> render_context;
 
-    VkRenderPass renderPass;
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+
+    // 布局由着色器反射生成，归设备的布局缓存所有
+    std::unique_ptr<ShaderModule>       vertexShader;
+    std::unique_ptr<ShaderModule>       fragmentShader;
+    vk_pipeline_layout*                 graphicsPipelineLayout = nullptr;
+    VkDescriptorSetLayout               descriptorSetLayout;
+    VkPipelineLayout                    pipelineLayout;
+    VkShaderStageFlags                  drawConstantStages = 0;
+    DrawPushConstants                   drawConstants;
+    VkPipeline                          graphicsPipeline;
 
-    VkDescriptorSetLayout descriptorSetLayout;
-    VkPipelineLayout      pipelineLayout;
-    VkPipeline            graphicsPipeline;
+    // 创建图形管线所需的其余状态，初始化后不再变化，热重载在监视线程上据此创建新管线
+    GraphicsPipelineState               graphicsPipelineState;
+    std::unique_ptr<vk_shader_reloader> shaderReloader;
 
     VkCommandPool commandPool;
 
     std::unique_ptr<vk_image>      textureImage1;
-    std::unique_ptr<vk_image_view> textureImageView1;
-    std::unique_ptr<vk_sampler>    textureSampler1;
+    vk_image_view*                 textureImageView1 = nullptr;
+    vk_sampler*                    textureSampler1   = nullptr;
 
     std::vector<Vertex>   vertices;
     std::vector<uint32_t> indices;
 
-    std::unique_ptr<vk_buffer> vertexBuffer1;
-    std::unique_ptr<vk_buffer> indexBuffer1;
-    std::vector<std::unique_ptr<vk_buffer>> uniformBuffers1;
+    std::unique_ptr<vk_geometry_arena> geometryArena;
+    GeometryRange                      modelGeometry;
+    std::vector<MeshLod>               modelLods;
+    uint32_t                           currentLod = 0;
+    glm::vec4                          modelBoundingSphere{0.0f};
+    std::unique_ptr<vk_gpu_culler>     gpuCuller;
+    glm::mat4                          cullMatrix{1.0f};
+    glm::mat4                          dequantizeMatrix{1.0f};
+    vk_draw_batcher                    drawBatcher;
+    std::vector<glm::vec3>             instanceOffsets;
+    VkDescriptorSet                    instanceDescriptorSet = VK_NULL_HANDLE;
+    std::unique_ptr<FrustumCuller>     cpuCuller;
+    std::vector<uint32_t>              visibleObjects;
+    bool                               gpuDriven = true;
+    std::unique_ptr<vk_meshlet_renderer> meshletRenderer;
+    glm::vec3                          cameraModelPosition{0.0f};
+    bool                               meshletCulling = false;
+    bool                               asyncCulling = false;
+    std::unique_ptr<vk_buffer>         uniformBuffer;
+    std::vector<vk_buffer_allocation>  uniformSlices;
+    glm::mat4                          viewMatrix{1.0f};
+    glm::mat4                          projMatrix{1.0f};
+
+    // 光源数据每帧从帧的缓冲区池分配，描述符集（set 1）也由帧提供
+    std::unique_ptr<vk_clustered_lighting> clusteredLighting;
+    std::vector<PointLight>                lights;
+    VkDescriptorSet                        lightDescriptorSet = VK_NULL_HANDLE;
+    double                                 lightClusteringMs  = 0.0;
 
     VkDescriptorPool             descriptorPool;
-    std::vector<VkDescriptorSet> descriptorSets;
+    VkDescriptorSet              descriptorSet;
 
     std::vector<VkCommandBuffer> commandBuffers;
 
@@ -204,6 +418,10 @@ private:
     std::vector<VkFence>     inFlightFences;
     uint32_t                 currentFrame = 0;
 
+    std::vector<std::unique_ptr<vk_counter_session>> counterSessions;
+
+    std::unique_ptr<vk_defragmenter> defragmenter;
+
     bool framebufferResized = false;
 
     void initWindow()
@@ -230,6 +448,53 @@ private:
         if (key == GLFW_KEY_ESCAPE) {
             glfwSetWindowShouldClose(window, 1);
         }
+
+        // F2: 抓取接下来 120 帧的 trace；F3: 输出滚动统计
+        if (key == GLFW_KEY_F2 && action == GLFW_PRESS) {
+            FrameProfiler::get().begin_capture("profile_trace.json", 120);
+        }
+        if (key == GLFW_KEY_F3 && action == GLFW_PRESS) {
+            FrameProfiler::get().log_summary();
+            FrameProfiler::get().write_summary("profile_summary.txt");
+        }
+
+        // F4: 输出显存预算与分类统计
+        if (key == GLFW_KEY_F4 && action == GLFW_PRESS) {
+            auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+            app->device->get_memory_telemetry().log_summary();
+            app->device->get_memory_telemetry().write_json("memory_stats.json");
+        }
+
+        // F5: 开始增量显存碎片整理，之后每帧执行一个 pass
+        if (key == GLFW_KEY_F5 && action == GLFW_PRESS) {
+            auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+            app->defragmenter->begin();
+        }
+
+        // F6: 在 GPU 剔除与 CPU 自动实例化两条绘制路径之间切换
+        if (key == GLFW_KEY_F6 && action == GLFW_PRESS) {
+            auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+            app->gpuDriven = !app->gpuDriven;
+            LOGI("绘制路径: {}", app->gpuDriven ? "GPU 剔除" : "CPU 实例化合并");
+        }
+
+        // F7: GPU 剔除路径下在整网格剔除与 meshlet 剔除之间切换
+        if (key == GLFW_KEY_F7 && action == GLFW_PRESS) {
+            auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+            app->meshletCulling = !app->meshletCulling;
+            LOGI("GPU 剔除粒度: {}", app->meshletCulling ? "meshlet" : "实例");
+        }
+
+        // F8: 实例剔除提交到异步计算队列，图形提交通过信号量等待其结果
+        if (key == GLFW_KEY_F8 && action == GLFW_PRESS) {
+            auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+            if (!app->render_context->has_async_compute()) {
+                LOGW("设备没有可与图形并行的计算队列");
+                return;
+            }
+            app->asyncCulling = !app->asyncCulling;
+            LOGI("GPU 剔除队列: {}", app->asyncCulling ? "异步计算" : "图形");
+        }
     }
 
     void initVulkan()
@@ -239,28 +504,43 @@ private:
         pickPhysicalDevice();
         createLogicalDevice();
         createSwapChain();
-        createRenderPass();
-        createDescriptorSetLayout();
+        if (!dynamicRendering) {
+            createRenderPass();
+        }
+        createPipelineLayout();
         createGraphicsPipeline();
         createCommandPool();
-        createFramebuffers();
+        if (!dynamicRendering) {
+            createFramebuffers();
+        }
         createTextureImage();
         createTextureSampler();
         loadModel();
-        createVertexBuffer();
-        createIndexBuffer();
+        createGeometryBuffers();
+        createLights(DEFAULT_LIGHT_COUNT);
         createUniformBuffers();
         createDescriptorPool();
         createDescriptorSets();
         createCommandBuffers();
         createSyncObjects();
+        createCounterSessions();
+        createDefragmenter();
+        createShaderReloader();
     }
 
     void mainLoop()
     {
+        if (lightBenchmarkFrames > 0) {
+            runLightBenchmark();
+            vkDeviceWaitIdle(device->handle());
+            return;
+        }
+
         while (!glfwWindowShouldClose(window)) {
             glfwPollEvents();
             drawFrame();
+            defragmenter->update();
+            PROFILE_FRAME();
         }
 
         vkDeviceWaitIdle(device->handle());
@@ -280,25 +560,28 @@ private:
         cleanupSwapChain();
         render_context.reset();
 
+        shaderReloader.reset();
         vkDestroyPipeline(device->handle(), graphicsPipeline, nullptr);
-        vkDestroyPipelineLayout(device->handle(), pipelineLayout, nullptr);
         vkDestroyRenderPass(device->handle(), renderPass, nullptr);
 
 
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            uniformBuffers1[i].reset();
-        }
+        uniformSlices.clear();
+        uniformBuffer.reset();
 
         vkDestroyDescriptorPool(device->handle(), descriptorPool, nullptr);
 
-        textureSampler1.reset();
-        textureImageView1.reset();
+        textureSampler1   = nullptr;
+        textureImageView1 = nullptr;
         textureImage1.reset();
 
-        vkDestroyDescriptorSetLayout(device->handle(), descriptorSetLayout, nullptr);
+        fragmentShader.reset();
+        vertexShader.reset();
 
-        vertexBuffer1.reset();
-        indexBuffer1.reset();
+        clusteredLighting.reset();
+        gpuCuller.reset();
+        meshletRenderer.reset();
+        cpuCuller.reset();
+        geometryArena.reset();
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
             vkDestroySemaphore(device->handle(), renderFinishedSemaphores[i], nullptr);
@@ -308,6 +591,8 @@ private:
 
         vkDestroyCommandPool(device->handle(), commandPool, nullptr);
 
+        counterSessions.clear();
+        defragmenter.reset();
         device.reset();
 
         vkDestroySurfaceKHR(instance->handle(), surface, nullptr);
@@ -333,7 +618,9 @@ private:
 
         render_context->handle_surface_changes();
         swapChainExtent = render_context->get_surface_extent();
-        createFramebuffers();
+        if (!dynamicRendering) {
+            createFramebuffers();
+        }
     }
 
     void createInstance()
@@ -407,8 +694,12 @@ private:
 
         device = std::make_unique<vk_device>(*physicalDevice, surface, std::move(debug_utils), ext);
 
-        graphicsQueue = device->get_suitable_graphics_queue().get_handle();
-        presentQueue  = device->get_queue_by_present(0).get_handle();
+        if (dynamicRendering && !device->is_enabled(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)) {
+            LOGW("设备不支持 VK_KHR_dynamic_rendering，使用渲染通道");
+            dynamicRendering = false;
+        }
+
+        presentQueue = device->get_queue_by_present(0).get_handle();
     }
 
     void createSwapChain()
@@ -421,6 +712,13 @@ private:
                                                                    vk::PresentModeKHR::eFifo,
                                                                    vk::PresentModeKHR::eImmediate};
 
+        // 基准需要测量不受垂直同步限制的帧时间
+        if (lightBenchmarkFrames > 0) {
+            present_mode               = vk::PresentModeKHR::eImmediate;
+            present_mode_priority_list = {vk::PresentModeKHR::eImmediate, vk::PresentModeKHR::eMailbox,
+                                          vk::PresentModeKHR::eFifo};
+        }
+
         render_context = std::make_unique<vk_render_context>(*device, surface,
                                                              vk::Extent2D{WIDTH, HEIGHT},
                                                              present_mode, present_mode_priority_list,
@@ -492,40 +790,81 @@ private:
         }
     }
 
-    void createDescriptorSetLayout()
+    static ShaderVariant sceneVertexVariant()
+    {
+        // UBO 以动态偏移区分帧
+        ShaderVariant variant;
+        variant.add_dynamic_resource("UniformBufferObject");
+        return variant;
+    }
+
+    /**
+     * @brief 未指定着色器目录时使用内置源码；否则从文件读取，文件不存在时先导出内置源码以便编辑
+     */
+    static ShaderSource loadSceneShader(const std::string& name, const char* embedded)
+    {
+        ShaderSource source;
+        if (shaderDirectory.empty()) {
+            source.set_source(embedded);
+            return source;
+        }
+
+        auto path = std::filesystem::path(shaderDirectory) / name;
+        if (!std::filesystem::exists(path)) {
+            std::filesystem::create_directories(path.parent_path());
+            std::ofstream file(path);
+            file << embedded;
+            LOGI("导出内置着色器到 {}", path.string());
+        }
+
+        return ShaderSource{path.string()};
+    }
+
+    void createPipelineLayout()
     {
-        VkDescriptorSetLayoutBinding uboLayoutBinding{};
-        uboLayoutBinding.binding            = 0;
-        uboLayoutBinding.descriptorCount    = 1;
-        uboLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        uboLayoutBinding.pImmutableSamplers = nullptr;
-        uboLayoutBinding.stageFlags         = VK_SHADER_STAGE_VERTEX_BIT;
+        // 描述符集布局、推送常量范围都由反射得到
+        auto vertexSource = loadSceneShader("scene.vert", SCENE_VERTEX_SHADER);
+        vertexShader = std::make_unique<ShaderModule>(*device, VK_SHADER_STAGE_VERTEX_BIT, vertexSource, "main",
+                                                      sceneVertexVariant());
 
-        VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-        samplerLayoutBinding.binding            = 1;
-        samplerLayoutBinding.descriptorCount    = 1;
-        samplerLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        samplerLayoutBinding.pImmutableSamplers = nullptr;
-        samplerLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
+        auto fragmentSource = loadSceneShader("scene.frag", SCENE_FRAGMENT_SHADER);
+        fragmentShader = std::make_unique<ShaderModule>(*device, VK_SHADER_STAGE_FRAGMENT_BIT, fragmentSource, "main",
+                                                        ShaderVariant{});
 
-        std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, samplerLayoutBinding};
-        VkDescriptorSetLayoutCreateInfo             layoutInfo{};
-        layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-        layoutInfo.pBindings    = bindings.data();
+        graphicsPipelineLayout = &device->request_pipeline_layout({vertexShader.get(), fragmentShader.get()});
 
-        if (vkCreateDescriptorSetLayout(device->handle(), &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create descriptor set layout!");
+        descriptorSetLayout = graphicsPipelineLayout->get_descriptor_set_layout(0).get_handle();
+        pipelineLayout      = graphicsPipelineLayout->handle();
+
+        drawConstantStages = static_cast<VkShaderStageFlags>(
+            graphicsPipelineLayout->get_push_constant_range_stage(sizeof(DrawPushConstants)));
+        if (drawConstantStages == 0) {
+            throw std::runtime_error("DrawPushConstants 与着色器中的推送常量块不匹配");
         }
     }
 
     void createGraphicsPipeline()
     {
-        auto vertShaderCode = readFile("../data/vert.spv");
-        auto fragShaderCode = readFile("../data/frag.spv");
+        graphicsPipelineState.layout     = pipelineLayout;
+        graphicsPipelineState.renderPass = renderPass;
+
+        // 动态渲染时附件格式由渲染目标给出，所有帧的渲染目标格式相同
+        if (dynamicRendering) {
+            graphicsPipelineState.renderingFormats =
+                render_context->get_render_frames().front()->get_render_target().get_rendering_formats();
+        }
 
-        VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-        VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+        graphicsPipeline = buildGraphicsPipeline(*vertexShader, *fragmentShader, graphicsPipelineState);
+    }
+
+    /**
+     * @brief 只读取 state 与设备，可在热重载的监视线程上调用
+     */
+    VkPipeline buildGraphicsPipeline(const ShaderModule& vertexModule, const ShaderModule& fragmentModule,
+                                     const GraphicsPipelineState& state) const
+    {
+        VkShaderModule vertShaderModule = createShaderModule(vertexModule.get_binary());
+        VkShaderModule fragShaderModule = createShaderModule(fragmentModule.get_binary());
 
         VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
         vertShaderStageInfo.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -544,8 +883,9 @@ private:
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-        auto bindingDescription    = Vertex::getBindingDescription();
-        auto attributeDescriptions = Vertex::getAttributeDescriptions();
+        // 顶点以量化格式存放，着色器仍以 vec3 / vec3 / vec2 读取
+        auto bindingDescription    = QuantizedVertex::get_binding_description();
+        auto attributeDescriptions = QuantizedVertex::get_attribute_descriptions();
 
         vertexInputInfo.vertexBindingDescriptionCount   = 1;
         vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
@@ -610,15 +950,6 @@ private:
         dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
         dynamicState.pDynamicStates    = dynamicStates.data();
 
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-        pipelineLayoutInfo.sType          = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = 1;
-        pipelineLayoutInfo.pSetLayouts    = &descriptorSetLayout;
-
-        if (vkCreatePipelineLayout(device->handle(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create pipeline layout!");
-        }
-
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
         pipelineInfo.stageCount          = 2;
@@ -631,18 +962,91 @@ private:
         pipelineInfo.pDepthStencilState  = &depthStencil;
         pipelineInfo.pColorBlendState    = &colorBlending;
         pipelineInfo.pDynamicState       = &dynamicState;
-        pipelineInfo.layout              = pipelineLayout;
-        pipelineInfo.renderPass          = renderPass;
+        pipelineInfo.layout              = state.layout;
+        pipelineInfo.renderPass          = state.renderPass;
         pipelineInfo.subpass             = 0;
         pipelineInfo.basePipelineHandle  = VK_NULL_HANDLE;
 
-        if (vkCreateGraphicsPipelines(device->handle(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) !=
-            VK_SUCCESS) {
-            throw std::runtime_error("failed to create graphics pipeline!");
+        vk::PipelineRenderingCreateInfo renderingInfo;
+        if (dynamicRendering) {
+            renderingInfo = state.renderingFormats.get_create_info();
+
+            pipelineInfo.pNext      = &renderingInfo;
+            pipelineInfo.renderPass = VK_NULL_HANDLE;
         }
 
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkResult   result   = vkCreateGraphicsPipelines(device->handle(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr,
+                                                        &pipeline);
+
         vkDestroyShaderModule(device->handle(), fragShaderModule, nullptr);
         vkDestroyShaderModule(device->handle(), vertShaderModule, nullptr);
+
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to create graphics pipeline!");
+        }
+
+        return pipeline;
+    }
+
+    void createShaderReloader()
+    {
+        if (shaderDirectory.empty()) {
+            return;
+        }
+
+        shaderReloader = std::make_unique<vk_shader_reloader>(*device, MAX_FRAMES_IN_FLIGHT);
+
+        std::vector<ShaderStageDesc> stages(2);
+        stages[0].stage    = VK_SHADER_STAGE_VERTEX_BIT;
+        stages[0].filename = (std::filesystem::path(shaderDirectory) / "scene.vert").string();
+        stages[0].variant  = sceneVertexVariant();
+        stages[1].stage    = VK_SHADER_STAGE_FRAGMENT_BIT;
+        stages[1].filename = (std::filesystem::path(shaderDirectory) / "scene.frag").string();
+
+        // 状态按值捕获，监视线程不读取主线程会修改的成员
+        shaderReloader->add_program(stages, {vertexShader.get(), fragmentShader.get()},
+                                    [this, state = graphicsPipelineState](const std::vector<const ShaderModule*>& modules) {
+                                        return buildReloadedPipeline(modules, state);
+                                    },
+                                    [this](VkPipeline pipeline) {
+                                        swapGraphicsPipeline(pipeline);
+                                    });
+
+        LOGI("着色器热重载已启用: {}", shaderDirectory);
+    }
+
+    /**
+     * @brief 在监视线程上用新模块创建图形管线；管线布局与描述符集沿用，接口变化只能重启
+     */
+    VkPipeline buildReloadedPipeline(const std::vector<const ShaderModule*>& modules,
+                                     const GraphicsPipelineState& state) const
+    {
+        const ShaderModule* reflected[] = {vertexShader.get(), fragmentShader.get()};
+
+        for (size_t i = 0; i < modules.size(); ++i) {
+            if (!vk_shader_reloader::is_interface_compatible(*reflected[i], *modules[i])) {
+                LOGW("{} 的资源接口发生变化，需要重启才能生效", modules[i]->get_debug_name());
+                return VK_NULL_HANDLE;
+            }
+        }
+
+        return buildGraphicsPipeline(*modules[0], *modules[1], state);
+    }
+
+    /**
+     * @brief 在帧边界换上已创建好的管线，旧管线在所有使用它的帧完成后销毁
+     */
+    void swapGraphicsPipeline(VkPipeline pipeline)
+    {
+        VkPipeline oldPipeline = graphicsPipeline;
+        graphicsPipeline       = pipeline;
+
+        shaderReloader->defer_destroy([device = device->handle(), oldPipeline]() {
+            vkDestroyPipeline(device, oldPipeline, nullptr);
+        });
+
+        LOGI("图形管线已热重载");
     }
 
     void createFramebuffers()
@@ -679,7 +1083,7 @@ private:
         }
 
         vk_buffer stage_buffer{*device, imageSize, vk::BufferUsageFlagBits::eTransferSrc,
-                               VMA_MEMORY_USAGE_CPU_ONLY, 0};
+                               VMA_MEMORY_USAGE_CPU_ONLY, 0, {}, MemoryCategory::Staging};
         stage_buffer.update({pixels, pixels + imageSize});
 
         stbi_image_free(pixels);
@@ -688,11 +1092,14 @@ private:
                                                    vk::Extent3D{static_cast<uint32_t>(texWidth),
                                                                 static_cast<uint32_t>(texHeight), 1},
                                                    vk::Format::eR8G8B8A8Srgb,
+                                                   vk::ImageUsageFlagBits::eTransferSrc |
                                                    vk::ImageUsageFlagBits::eTransferDst |
                                                    vk::ImageUsageFlagBits::eSampled,
-                                                   VMA_MEMORY_USAGE_GPU_ONLY);
+                                                   VMA_MEMORY_USAGE_GPU_ONLY, vk::SampleCountFlagBits::e1, 1, 1,
+                                                   vk::ImageTiling::eOptimal, vk::ImageCreateFlags{}, 0, nullptr,
+                                                   MemoryCategory::Texture);
 
-        textureImageView1 = std::make_unique<vk_image_view>(*textureImage1, vk::ImageViewType::e2D);
+        textureImageView1 = &textureImage1->request_view(vk::ImageViewType::e2D);
 
         auto command_buffer = device->beginSingleTimeCommands();
 
@@ -713,6 +1120,8 @@ private:
                                 textureImageView1->get_subresource_range());
 
         device->endSingleTimeCommands(command_buffer);
+
+        textureImage1->set_steady_layout(vk::ImageLayout::eShaderReadOnlyOptimal);
     }
 
     void createTextureSampler()
@@ -726,7 +1135,7 @@ private:
         sampler_info.compareOp        = vk::CompareOp::eAlways;
         sampler_info.mipmapMode       = vk::SamplerMipmapMode::eLinear;
 
-        textureSampler1 = std::make_unique<vk_sampler>(*device, sampler_info);
+        textureSampler1 = &device->request_sampler(sampler_info);
     }
 
     void loadModel()
@@ -767,43 +1176,220 @@ private:
                 indices.push_back(uniqueVertices[vertex]);
             }
         }
+
+        // OBJ 面序对变换后缓存与顶点读取都不友好，导入时重排
+        auto report = optimize_mesh(vertices, indices, offsetof(Vertex, pos));
+        LOGI("网格优化 ({:.2f} ms): ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, overfetch {:.3f} -> {:.3f}",
+             report.milliseconds, report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr,
+             report.before.overfetch, report.after.overfetch);
     }
 
-    void createVertexBuffer()
+    void createGeometryBuffers()
     {
-        vertexBuffer1 = device->createBuffer(vertices, vk::BufferUsageFlagBits::eVertexBuffer);
+        // 所有静态网格共用 arena 中的大缓冲区，绘制时以 firstIndex / vertexOffset 区分
+        MeshView meshView;
+        meshView.vertices         = vertices.data();
+        meshView.vertex_count     = vertices.size();
+        meshView.vertex_stride    = sizeof(Vertex);
+        meshView.position_offset  = offsetof(Vertex, pos);
+        meshView.color_offset     = offsetof(Vertex, color);
+        meshView.tex_coord_offset = offsetof(Vertex, texCoord);
+
+        // 各级 LOD 的索引首尾相接，共用同一份顶点，切换 LOD 只改变 firstIndex / indexCount
+        auto lodChain = build_lod_chain(indices.data(), indices.size(), &vertices[0].pos.x, vertices.size(),
+                                        sizeof(Vertex));
+        modelLods = lodChain.lods;
+        meshView.indices     = lodChain.indices.data();
+        meshView.index_count = lodChain.indices.size();
+
+        for (size_t i = 0; i < modelLods.size(); ++i) {
+            LOGI("LOD {}: {} 个三角形, 误差 {:.6f}", i, modelLods[i].index_count / 3, modelLods[i].error);
+        }
+
+        auto quantized = quantize_mesh(meshView);
+        dequantizeMatrix = glm::make_mat4(quantized.get_dequantization_matrix().data());
+
+        LOGI("模型量化: 顶点 {} -> {} 字节, 索引 4 -> {} 字节, 最大位置误差 {:.6f}",
+             sizeof(Vertex), sizeof(QuantizedVertex), quantized.get_index_size(), quantized.max_position_error);
+
+        geometryArena = std::make_unique<vk_geometry_arena>(*device, static_cast<uint32_t>(sizeof(QuantizedVertex)),
+                                                            vk_geometry_arena::DEFAULT_VERTEX_PAGE_SIZE,
+                                                            vk_geometry_arena::DEFAULT_INDEX_PAGE_SIZE,
+                                                            quantized.index_type);
+        modelGeometry = geometryArena->allocate(quantized.vertices.data(),
+                                                static_cast<uint32_t>(quantized.vertices.size()),
+                                                quantized.get_index_data(), quantized.get_index_count());
+
+        // meshlet 数据与整网格共用同一个 arena，包围信息以浮点网格空间坐标计算
+        auto meshlets = build_meshlets(indices.data(), indices.size(), &vertices[0].pos.x, vertices.size(),
+                                       sizeof(Vertex));
+        meshletRenderer = std::make_unique<vk_meshlet_renderer>(*device, MAX_FRAMES_IN_FLIGHT);
+        meshletRenderer->set_mesh(*geometryArena, quantized.vertices.data(), meshlets);
+
+        geometryArena->flush();
+
+        // 模型空间包围球：AABB 中心 + 最远顶点距离
+        glm::vec3 minPos{std::numeric_limits<float>::max()};
+        glm::vec3 maxPos{std::numeric_limits<float>::lowest()};
+        for (const auto& vertex: vertices) {
+            minPos = glm::min(minPos, vertex.pos);
+            maxPos = glm::max(maxPos, vertex.pos);
+        }
+
+        glm::vec3 center = (minPos + maxPos) * 0.5f;
+        float     radius = 0.0f;
+        for (const auto& vertex: vertices) {
+            radius = std::max(radius, glm::length(vertex.pos - center));
+        }
+
+        modelBoundingSphere = glm::vec4(center, radius);
+
+        GpuCullInstance instance;
+        instance.bounding_sphere = modelBoundingSphere;
+        instance.index_count     = modelLods[0].index_count;
+        instance.first_index     = modelGeometry.first_index;
+        instance.vertex_offset   = modelGeometry.vertex_offset;
+
+        // 模型矩阵由推送常量提供，实例变换保持单位矩阵，剔除时把模型矩阵并入 cullMatrix；
+        // GPU 路径只绘制中心的一个副本（firstInstance 为 0）
+        gpuCuller = std::make_unique<vk_gpu_culler>(*device, MAX_FRAMES_IN_FLIGHT);
+        gpuCuller->set_queue_families(device->get_suitable_compute_queue().get_family_index(),
+                                      device->get_suitable_graphics_queue().get_family_index());
+        gpuCuller->set_instances({instance});
+
+        // CPU 路径在模型空间中按网格摆放副本，中心的副本位于原点；
+        // 各副本同样以模型空间包围球剔除，cullMatrix 中已包含模型矩阵
+        const float spacing = radius * 2.5f;
+        const float origin  = (static_cast<float>(INSTANCE_GRID_SIZE) - 1.0f) * 0.5f;
+
+        std::vector<BoundingSphere> spheres;
+        instanceOffsets.clear();
+        for (uint32_t y = 0; y < INSTANCE_GRID_SIZE; ++y) {
+            for (uint32_t x = 0; x < INSTANCE_GRID_SIZE; ++x) {
+                glm::vec3 offset{(static_cast<float>(x) - origin) * spacing, (static_cast<float>(y) - origin) * spacing,
+                                 0.0f};
+                instanceOffsets.push_back(offset);
+                spheres.push_back({center.x + offset.x, center.y + offset.y, center.z + offset.z, radius});
+            }
+        }
+
+        cpuCuller = std::make_unique<FrustumCuller>();
+        cpuCuller->build(spheres);
     }
 
-    void createIndexBuffer()
+    /**
+     * @brief 在模型包围球周围随机放置点光源，半径固定，光源越多每个簇中的光源越多
+     */
+    void createLights(uint32_t count)
     {
-        indexBuffer1 = device->createBuffer(indices, vk::BufferUsageFlagBits::eIndexBuffer);
+        if (!clusteredLighting) {
+            ClusterConfig config;
+            config.near_plane = SCENE_NEAR_PLANE;
+            config.far_plane  = SCENE_FAR_PLANE;
+            clusteredLighting = std::make_unique<vk_clustered_lighting>(config);
+        }
+
+        std::mt19937                          rng{7};
+        std::uniform_real_distribution<float> offset{-1.2f, 1.2f};
+        std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+
+        glm::vec3 center = glm::vec3(modelBoundingSphere);
+        float     extent = modelBoundingSphere.w;
+
+        lights.resize(count);
+        for (auto& light: lights) {
+            light.position  = center + extent * glm::vec3(offset(rng), offset(rng), offset(rng));
+            light.radius    = extent * 0.4f;
+            light.color     = glm::vec3(unit(rng), unit(rng), unit(rng));
+            light.intensity = 1.0f;
+        }
+    }
+
+    void updateLightClusters(vk_render_frame& frame)
+    {
+        PROFILE_SCOPE("update_light_clusters");
+
+        auto start = std::chrono::steady_clock::now();
+
+        clusteredLighting->build(lights, viewMatrix, projMatrix, swapChainExtent.width, swapChainExtent.height);
+        if (!clusteredLighting->upload(frame)) {
+            throw std::runtime_error("failed to upload light clusters!");
+        }
+
+        lightDescriptorSet = frame.request_descriptor_set(graphicsPipelineLayout->get_descriptor_set_layout(1),
+                                                          clusteredLighting->get_buffer_infos(), {}, false);
+
+        lightClusteringMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * @brief 光源数量从 16 倍增到 16384，每个数量先预热再测量 lightBenchmarkFrames 帧的平均帧时间
+     */
+    void runLightBenchmark()
+    {
+        constexpr uint32_t WARMUP_FRAMES = 30;
+
+        const auto& config = clusteredLighting->get_config();
+        std::printf("Clustered lighting benchmark: %ux%u, %ux%ux%u clusters, %u frames per step\n",
+                    swapChainExtent.width, swapChainExtent.height, config.tiles_x, config.tiles_y, config.slices,
+                    lightBenchmarkFrames);
+
+        for (uint32_t count = 16; count <= 16384 && !glfwWindowShouldClose(window); count *= 2) {
+            vkDeviceWaitIdle(device->handle());
+            createLights(count);
+
+            for (uint32_t i = 0; i < WARMUP_FRAMES; ++i) {
+                glfwPollEvents();
+                drawFrame();
+            }
+
+            double clusteringMs = 0.0;
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < lightBenchmarkFrames; ++i) {
+                glfwPollEvents();
+                drawFrame();
+                clusteringMs += lightClusteringMs;
+            }
+            vkDeviceWaitIdle(device->handle());
+            double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            const auto& stats = clusteredLighting->get_stats();
+            std::printf("  %6u lights  %8.3f ms/frame  clustering %7.3f ms  %8u indices  max %4u per cluster\n",
+                        count, frameMs / lightBenchmarkFrames, clusteringMs / lightBenchmarkFrames,
+                        stats.light_indices, stats.max_cluster_lights);
+        }
     }
 
     void createUniformBuffers()
     {
-        VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+        // 所有帧的 UBO 放在同一个缓冲区中，按动态偏移选择，整个程序只需要一个描述符集
+        VkDeviceSize alignment = device->get_gpu().properties().limits.minUniformBufferOffsetAlignment;
+        VkDeviceSize stride    = (sizeof(UniformBufferObject) + alignment - 1) & ~(alignment - 1);
 
-        uniformBuffers1.resize(MAX_FRAMES_IN_FLIGHT);
+        uniformBuffer = device->createBuffer(stride * MAX_FRAMES_IN_FLIGHT, nullptr, vk::BufferUsageFlagBits::eUniformBuffer,
+                                             vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                             MemoryCategory::FrameRing);
 
+        uniformSlices.clear();
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            uniformBuffers1[i] = device->createBuffer(bufferSize, nullptr, vk::BufferUsageFlagBits::eUniformBuffer,
-                                                      vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+            uniformSlices.emplace_back(*uniformBuffer, sizeof(UniformBufferObject), stride * i);
         }
     }
 
     void createDescriptorPool()
     {
         std::array<VkDescriptorPoolSize, 2> poolSizes{};
-        poolSizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        poolSizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        poolSizes[0].descriptorCount = 1;
         poolSizes[1].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        poolSizes[1].descriptorCount = 1;
 
         VkDescriptorPoolCreateInfo poolInfo{};
         poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
         poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
         poolInfo.pPoolSizes    = poolSizes.data();
-        poolInfo.maxSets       = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        poolInfo.maxSets       = 1;
 
         if (vkCreateDescriptorPool(device->handle(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
             throw std::runtime_error("failed to create descriptor pool!");
@@ -812,51 +1398,53 @@ private:
 
     void createDescriptorSets()
     {
-        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
-        VkDescriptorSetAllocateInfo        allocInfo{};
+        VkDescriptorSetAllocateInfo allocInfo{};
         allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
         allocInfo.descriptorPool     = descriptorPool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-        allocInfo.pSetLayouts        = layouts.data();
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts        = &descriptorSetLayout;
 
-        descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-        if (vkAllocateDescriptorSets(device->handle(), &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
+        if (vkAllocateDescriptorSets(device->handle(), &allocInfo, &descriptorSet) != VK_SUCCESS) {
             throw std::runtime_error("failed to allocate descriptor sets!");
         }
 
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            VkDescriptorBufferInfo bufferInfo{};
-            bufferInfo.buffer = uniformBuffers1[i]->handle();
-            bufferInfo.offset = 0;
-            bufferInfo.range  = sizeof(UniformBufferObject);
-
-            VkDescriptorImageInfo imageInfo{};
-            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfo.imageView   = textureImageView1->handle();
-            imageInfo.sampler     = textureSampler1->handle();
-
-            std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
-
-            descriptorWrites[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[0].dstSet          = descriptorSets[i];
-            descriptorWrites[0].dstBinding      = 0;
-            descriptorWrites[0].dstArrayElement = 0;
-            descriptorWrites[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            descriptorWrites[0].descriptorCount = 1;
-            descriptorWrites[0].pBufferInfo     = &bufferInfo;
-
-            descriptorWrites[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[1].dstSet          = descriptorSets[i];
-            descriptorWrites[1].dstBinding      = 1;
-            descriptorWrites[1].dstArrayElement = 0;
-            descriptorWrites[1].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptorWrites[1].descriptorCount = 1;
-            descriptorWrites[1].pImageInfo      = &imageInfo;
+        writeDescriptorSets();
+    }
 
-            vkUpdateDescriptorSets(device->handle(), static_cast<uint32_t>(descriptorWrites.size()),
-                                   descriptorWrites.data(), 0,
-                                   nullptr);
-        }
+    void writeDescriptorSets()
+    {
+        // 动态 UBO 的描述符指向缓冲区起点，range 为单帧 UBO 的大小，帧的偏移在绑定时给出
+        VkDescriptorBufferInfo bufferInfo{};
+        bufferInfo.buffer = uniformBuffer->handle();
+        bufferInfo.offset = 0;
+        bufferInfo.range  = sizeof(UniformBufferObject);
+
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView   = textureImageView1->handle();
+        imageInfo.sampler     = textureSampler1->handle();
+
+        std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+
+        descriptorWrites[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[0].dstSet          = descriptorSet;
+        descriptorWrites[0].dstBinding      = 0;
+        descriptorWrites[0].dstArrayElement = 0;
+        descriptorWrites[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        descriptorWrites[0].descriptorCount = 1;
+        descriptorWrites[0].pBufferInfo     = &bufferInfo;
+
+        descriptorWrites[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[1].dstSet          = descriptorSet;
+        descriptorWrites[1].dstBinding      = 1;
+        descriptorWrites[1].dstArrayElement = 0;
+        descriptorWrites[1].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[1].descriptorCount = 1;
+        descriptorWrites[1].pImageInfo      = &imageInfo;
+
+        vkUpdateDescriptorSets(device->handle(), static_cast<uint32_t>(descriptorWrites.size()),
+                               descriptorWrites.data(), 0,
+                               nullptr);
     }
 
     void createCommandBuffers()
@@ -874,6 +1462,64 @@ private:
         }
     }
 
+    /**
+     * @brief 与 createRenderPass 中的附件描述等价：颜色与深度从 undefined 转换并清除，深度内容不保存
+     */
+    void beginDynamicRendering(VkCommandBuffer commandBuffer, const vk_render_target& renderTarget,
+                               const std::array<VkClearValue, 2>& clearValues)
+    {
+        const auto& views      = renderTarget.get_views();
+        const auto  colorIndex = renderTarget.get_output_attachments().front();
+        const auto  depthIndex = renderTarget.get_depth_attachment();
+        const auto& colorView  = views[colorIndex];
+
+        image_layout_transition(commandBuffer, colorView.get_image().handle(),
+                                vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                                vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                                {}, vk::AccessFlagBits::eColorAttachmentWrite,
+                                vk::ImageLayout::eUndefined, vk::ImageLayout::eColorAttachmentOptimal,
+                                colorView.get_subresource_range());
+
+        std::vector<LoadStoreInfo>  loadStoreInfos(views.size());
+        std::vector<vk::ClearValue> renderingClearValues(views.size());
+        renderingClearValues[colorIndex] = reinterpret_cast<const vk::ClearValue&>(clearValues[0]);
+
+        if (depthIndex >= 0) {
+            const auto& depthView  = views[depthIndex];
+            const auto  depthRange = depthView.get_subresource_range();
+
+            image_layout_transition(commandBuffer, depthView.get_image().handle(),
+                                    vk::PipelineStageFlagBits::eEarlyFragmentTests |
+                                    vk::PipelineStageFlagBits::eLateFragmentTests,
+                                    vk::PipelineStageFlagBits::eEarlyFragmentTests |
+                                    vk::PipelineStageFlagBits::eLateFragmentTests,
+                                    vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                                    vk::AccessFlagBits::eDepthStencilAttachmentRead |
+                                    vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                                    vk::ImageLayout::eUndefined, vk::ImageLayout::eDepthStencilAttachmentOptimal,
+                                    depthRange);
+
+            loadStoreInfos[depthIndex].store_op = vk::AttachmentStoreOp::eDontCare;
+            renderingClearValues[depthIndex]    = reinterpret_cast<const vk::ClearValue&>(clearValues[1]);
+        }
+
+        begin_rendering(commandBuffer, renderTarget, loadStoreInfos, renderingClearValues);
+    }
+
+    void endDynamicRendering(VkCommandBuffer commandBuffer, const vk_render_target& renderTarget)
+    {
+        end_rendering(commandBuffer);
+
+        const auto& colorView = renderTarget.get_views()[renderTarget.get_output_attachments().front()];
+
+        image_layout_transition(commandBuffer, colorView.get_image().handle(),
+                                vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                                vk::PipelineStageFlagBits::eBottomOfPipe,
+                                vk::AccessFlagBits::eColorAttachmentWrite, {},
+                                vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::ePresentSrcKHR,
+                                colorView.get_subresource_range());
+    }
+
     void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
     {
         VkCommandBufferBeginInfo beginInfo{};
@@ -883,50 +1529,106 @@ private:
             throw std::runtime_error("failed to begin recording command buffer!");
         }
 
-        VkRenderPassBeginInfo renderPassInfo{};
-        renderPassInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInfo.renderPass        = renderPass;
-        renderPassInfo.framebuffer       = framebuffers[imageIndex].get_handle();
-        renderPassInfo.renderArea.offset = {0, 0};
-        renderPassInfo.renderArea.extent = swapChainExtent;
+        vk_counter_session* counters = counterSessions.empty() ? nullptr : counterSessions[currentFrame].get();
+        if (counters) {
+            counters->reset(commandBuffer);
+            counters->begin_scope(commandBuffer, "drawFrame");
+        }
+
+        if (gpuDriven) {
+            if (meshletCulling) {
+                meshletRenderer->record_cull(commandBuffer, currentFrame, cullMatrix, cameraModelPosition);
+            } else if (asyncCulling) {
+                gpuCuller->record_acquire(commandBuffer, currentFrame);
+            } else {
+                gpuCuller->record_cull(commandBuffer, currentFrame, cullMatrix);
+            }
+        }
 
         std::array<VkClearValue, 2> clearValues{};
         clearValues[0].color        = {{0.0f, 0.0f, 0.0f, 1.0f}};
         clearValues[1].depthStencil = {1.0f, 0};
 
-        renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-        renderPassInfo.pClearValues    = clearValues.data();
+        const auto& renderTarget = render_context->get_render_frames()[imageIndex]->get_render_target();
 
-        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        if (dynamicRendering) {
+            beginDynamicRendering(commandBuffer, renderTarget, clearValues);
+        } else {
+            VkRenderPassBeginInfo renderPassInfo{};
+            renderPassInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderPassInfo.renderPass        = renderPass;
+            renderPassInfo.framebuffer       = framebuffers[imageIndex].get_handle();
+            renderPassInfo.renderArea.offset = {0, 0};
+            renderPassInfo.renderArea.extent = swapChainExtent;
+            renderPassInfo.clearValueCount   = static_cast<uint32_t>(clearValues.size());
+            renderPassInfo.pClearValues      = clearValues.data();
+
+            vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        }
 
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+        // 只跟踪经由它发出的命令；其他模块直接对句柄录制绑定后，若还要经由它录制需先 invalidate()
+        vk_command_recorder recorder{commandBuffer};
 
-        VkViewport viewport{};
+        recorder.bind_pipeline(vk::PipelineBindPoint::eGraphics, graphicsPipeline);
+
+        vk::Viewport viewport{};
         viewport.x        = 0.0f;
         viewport.y        = 0.0f;
         viewport.width    = (float) swapChainExtent.width;
         viewport.height   = (float) swapChainExtent.height;
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
-        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        recorder.set_viewport(0, viewport);
 
-        VkRect2D scissor{};
-        scissor.offset = {0, 0};
-        scissor.extent = swapChainExtent;
-        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+        vk::Rect2D scissor{{0, 0}, swapChainExtent};
+        recorder.set_scissor(0, scissor);
 
-        VkBuffer     vertexBuffers[] = {vertexBuffer1->handle()};
-        VkDeviceSize offsets[]       = {0};
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+        // set 1 为分簇光照，set 2 为逐实例数据，两者每帧由帧的描述符缓存提供
+        std::array<vk::DescriptorSet, 2> frameSets{lightDescriptorSet, instanceDescriptorSet};
+        recorder.bind_descriptor_sets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 1, frameSets);
 
-        vkCmdBindIndexBuffer(commandBuffer, indexBuffer1->handle(), 0, VK_INDEX_TYPE_UINT32);
+        // 所有绘制共用一个描述符集，只有当前帧 UBO 的动态偏移不同
+        auto uniformOffset = static_cast<uint32_t>(uniformSlices[currentFrame].get_offset());
 
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
-                                &descriptorSets[currentFrame], 0, nullptr);
+        if (gpuDriven) {
+            recorder.bind_descriptor_sets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 0,
+                                          vk::DescriptorSet{descriptorSet}, uniformOffset);
+            recorder.push_constants(pipelineLayout, vk::ShaderStageFlags{drawConstantStages}, 0,
+                                    sizeof(DrawPushConstants), &drawConstants);
 
-        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+            if (meshletCulling) {
+                meshletRenderer->record_draw(commandBuffer, currentFrame);
+            } else {
+                geometryArena->bind(commandBuffer, modelGeometry.page);
+                gpuCuller->record_draw(commandBuffer, currentFrame);
+            }
+        } else {
+            // 批次间描述符集与管线常常不变，由录制器跳过重复的绑定；
+            // 回调之间夹着几何池直接录制的顶点/索引绑定，但它们不在录制器跟踪的状态内
+            drawBatcher.record(recorder, *geometryArena,
+                               [this, uniformOffset](vk_command_recorder& recorder, VkPipeline pipeline,
+                                                     uint64_t material) {
+                                   recorder.bind_pipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+                                   recorder.bind_descriptor_sets(vk::PipelineBindPoint::eGraphics, pipelineLayout,
+                                                                 0, vk::DescriptorSet{descriptorSet}, uniformOffset);
+
+                                   // 材质下标随推送常量更新，无需额外的缓冲区分配
+                                   DrawPushConstants constants = drawConstants;
+                                   constants.material = static_cast<uint32_t>(material);
+                                   recorder.push_constants(pipelineLayout, vk::ShaderStageFlags{drawConstantStages}, 0,
+                                                           sizeof(DrawPushConstants), &constants);
+                               });
+        }
 
-        vkCmdEndRenderPass(commandBuffer);
+        if (dynamicRendering) {
+            endDynamicRendering(commandBuffer, renderTarget);
+        } else {
+            vkCmdEndRenderPass(commandBuffer);
+        }
+
+        if (counters) {
+            counters->end_scope(commandBuffer);
+        }
 
         if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
             throw std::runtime_error("failed to record command buffer!");
@@ -957,6 +1659,50 @@ private:
         }
     }
 
+    void createCounterSessions()
+    {
+        const uint32_t family = device->get_suitable_graphics_queue().get_family_index();
+
+        // 每个 in-flight 帧一个会话，避免重置仍在 GPU 上使用的查询
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            auto session = std::make_unique<vk_counter_session>(*device, family);
+
+            if (session->get_mode() == vk_counter_session::Mode::Unsupported) {
+                break;
+            }
+            if (session->get_pass_count() > 1) {
+                LOGI("选择的计数器需要 {} 个 pass，无法逐帧采集，请使用 vk_counter_session::replay",
+                     session->get_pass_count());
+                break;
+            }
+            if (!session->acquire_profiling_lock()) {
+                break;
+            }
+
+            counterSessions.push_back(std::move(session));
+        }
+
+        if (counterSessions.size() != MAX_FRAMES_IN_FLIGHT) {
+            counterSessions.clear();
+        }
+    }
+
+    void createDefragmenter()
+    {
+        defragmenter = std::make_unique<vk_defragmenter>(*device);
+
+        // 纹理视图或缓冲区被移动后，重写持有旧句柄的描述符
+        defragmenter->add_listener([this](const DefragmentationRemap& remap) {
+            writeDescriptorSets();
+            gpuCuller->update_descriptor_sets();
+            meshletRenderer->update_descriptor_sets();
+
+            for (auto& frame: render_context->get_render_frames()) {
+                frame->remap_descriptor_resources(remap.buffers, remap.image_views);
+            }
+        });
+    }
+
     void updateUniformBuffer(uint32_t currentImage)
     {
         static auto startTime = std::chrono::high_resolution_clock::now();
@@ -964,21 +1710,124 @@ private:
         auto  currentTime = std::chrono::high_resolution_clock::now();
         float time        = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
 
+        const glm::vec3 eye{2.0f, 2.0f, 2.0f};
+
+        glm::mat4 model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+
         UniformBufferObject ubo{};
-        ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        ubo.view  = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        ubo.proj  = glm::perspective(glm::radians(45.0f), swapChainExtent.width / (float) swapChainExtent.height, 0.1f,
-                                     10.0f);
+        ubo.view  = glm::lookAt(eye, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        ubo.proj  = glm::perspective(glm::radians(45.0f), swapChainExtent.width / (float) swapChainExtent.height,
+                                     SCENE_NEAR_PLANE, SCENE_FAR_PLANE);
         ubo.proj[1][1] *= -1;
 
-        uniformBuffers1[currentImage]->update(&ubo, sizeof(ubo));
+        viewMatrix = ubo.view;
+        projMatrix = ubo.proj;
+
+        // 剔除使用原始模型空间包围球，不含反量化变换
+        cullMatrix = ubo.proj * ubo.view * model;
+        cameraModelPosition = glm::vec3(glm::inverse(model) * glm::vec4(eye, 1.0f));
+
+        // 按投影误差选择 LOD，距离取到包围球表面；模型矩阵不含缩放，网格空间误差即世界空间误差
+        float distance        = glm::length(cameraModelPosition - glm::vec3(modelBoundingSphere)) - modelBoundingSphere.w;
+        float projectionScale = std::abs(ubo.proj[1][1]) * static_cast<float>(swapChainExtent.height) * 0.5f;
+        currentLod = select_lod(modelLods, distance, projectionScale);
+
+        drawConstants.model = model;
+
+        uniformSlices[currentImage].update(ubo);
+    }
+
+    void submitAsyncCulling(vk_render_frame& frame)
+    {
+        PROFILE_SCOPE("submit_async_culling");
+
+        auto& computeCmd = frame.request_command_buffer(render_context->get_compute_queue());
+        computeCmd.begin(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+        gpuCuller->record_cull(computeCmd.handle(), currentFrame, cullMatrix, true);
+        computeCmd.end();
+
+        render_context->submit_compute(frame, {&computeCmd}, vk::PipelineStageFlagBits::eDrawIndirect);
+    }
+
+    void buildDrawBatches(vk_render_frame& frame)
+    {
+        // 场景只有一种材质（下标 0），材质下标通过推送常量提供
+        cpuCuller->cull(Frustum::from_matrix(&cullMatrix[0][0]), visibleObjects);
+
+        GeometryRange lodRange = modelGeometry;
+        lodRange.first_index += modelLods[currentLod].first_index;
+        lodRange.index_count = modelLods[currentLod].index_count;
+
+        // 对象 id 即副本在 instanceOffsets 中的下标，网格、管线、材质都相同的副本合并为一次绘制
+        drawBatcher.clear();
+        for (uint32_t object: visibleObjects) {
+            const glm::vec3& offset = instanceOffsets[object];
+
+            InstanceData instance;
+            instance.model = glm::translate(glm::mat4(1.0f), offset) * dequantizeMatrix;
+
+            // 深度取副本包围球中心到相机的距离，按投影的远平面归一化
+            float depth = glm::length(cameraModelPosition - (glm::vec3(modelBoundingSphere) + offset)) / SCENE_FAR_PLANE;
+
+            drawBatcher.submit(graphicsPipeline, 0, lodRange, instance, depth);
+        }
+        drawBatcher.build(frame);
+    }
+
+    /**
+     * @brief 请求 set 2 的逐实例数据描述符集；GPU 路径与没有可见副本时只提供一个不带偏移的实例
+     */
+    void updateInstanceDescriptorSet(vk_render_frame& frame)
+    {
+        VkDescriptorBufferInfo bufferInfo{VK_NULL_HANDLE, 0, 0};
+
+        if (!gpuDriven) {
+            buildDrawBatches(frame);
+            bufferInfo = drawBatcher.get_instance_buffer_info();
+        }
+
+        if (bufferInfo.buffer == VK_NULL_HANDLE) {
+            InstanceData instance;
+            instance.model = dequantizeMatrix;
+
+            auto allocation = frame.allocate_buffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, sizeof(InstanceData));
+            if (allocation.empty()) {
+                throw std::runtime_error("failed to allocate instance data!");
+            }
+            allocation.update(instance);
+
+            bufferInfo = {allocation.get_buffer().handle(), allocation.get_offset(), sizeof(InstanceData)};
+        }
+
+        BindingMap<VkDescriptorBufferInfo> bufferInfos;
+        bufferInfos[0][0] = bufferInfo;
+
+        instanceDescriptorSet = frame.request_descriptor_set(graphicsPipelineLayout->get_descriptor_set_layout(2),
+                                                             bufferInfos, {}, false);
     }
 
     void drawFrame()
     {
-        vkWaitForFences(device->handle(), 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        PROFILE_SCOPE("drawFrame");
+
+        {
+            PROFILE_SCOPE("wait_fences");
+            vkWaitForFences(device->handle(), 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        }
+
+        // 帧边界：替换热重载完成的管线，销毁不再被任何帧使用的旧管线
+        if (shaderReloader) {
+            shaderReloader->update();
+        }
+
+        if (!counterSessions.empty()) {
+            counterSessions[currentFrame]->resolve();
+        }
 
-        auto [result1, imageIndex] = render_context->get_swapchain().acquire(imageAvailableSemaphores[currentFrame]);
+        auto [result1, imageIndex] = [this]() {
+            PROFILE_SCOPE("acquire");
+            return render_context->get_swapchain().acquire(imageAvailableSemaphores[currentFrame]);
+        }();
 
         auto result = VkResult(result1);
         if (result == VK_ERROR_OUT_OF_DATE_KHR) {
@@ -990,31 +1839,46 @@ private:
 
         updateUniformBuffer(currentFrame);
 
-        vkResetFences(device->handle(), 1, &inFlightFences[currentFrame]);
+        // 帧资源在 in-flight 栅栏等待之后才能复用
+        auto& frame = *render_context->get_render_frames()[currentFrame];
+        frame.reset();
 
-        vkResetCommandBuffer(commandBuffers[currentFrame], /*VkCommandBufferResetFlagBits*/ 0);
-        recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+        updateLightClusters(frame);
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        updateInstanceDescriptorSet(frame);
 
-        VkSemaphore          waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
-        VkPipelineStageFlags waitStages[]     = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        submitInfo.waitSemaphoreCount = 1;
-        submitInfo.pWaitSemaphores    = waitSemaphores;
-        submitInfo.pWaitDstStageMask  = waitStages;
+        if (gpuDriven && asyncCulling && !meshletCulling) {
+            submitAsyncCulling(frame);
+        }
 
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers    = &commandBuffers[currentFrame];
+        vkResetFences(device->handle(), 1, &inFlightFences[currentFrame]);
+
+        {
+            PROFILE_SCOPE("record");
+            vkResetCommandBuffer(commandBuffers[currentFrame], /*VkCommandBufferResetFlagBits*/ 0);
+            recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+        }
+
+        std::vector<SemaphoreSubmit> waitSemaphores = {
+            {imageAvailableSemaphores[currentFrame], 0, vk::PipelineStageFlagBits2::eColorAttachmentOutput}};
+
+        for (const auto& dependency: render_context->consume_compute_dependencies()) {
+            waitSemaphores.push_back({dependency.semaphore, dependency.value, to_stage_flags2(dependency.stage)});
+        }
 
         VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores    = signalSemaphores;
 
-        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
-            throw std::runtime_error("failed to submit draw command buffer!");
+        {
+            // 帧的刷新点：与同一队列上本帧已入队的工作（共用队列时的剔除计算）合并为一次提交
+            PROFILE_SCOPE("submit");
+            auto& batcher = device->get_submit_batcher(device->get_suitable_graphics_queue());
+            batcher.enqueue({commandBuffers[currentFrame]}, waitSemaphores, {{signalSemaphores[0]}});
+            batcher.flush(inFlightFences[currentFrame]);
         }
 
+        device->end_submit_frame();
+        vk_command_recorder::end_frame();
+
         VkPresentInfoKHR presentInfo{};
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
@@ -1027,7 +1891,10 @@ private:
 
         presentInfo.pImageIndices = &imageIndex;
 
-        result = vkQueuePresentKHR(presentQueue, &presentInfo);
+        {
+            PROFILE_SCOPE("present");
+            result = vkQueuePresentKHR(presentQueue, &presentInfo);
+        }
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized) {
             framebufferResized = false;
@@ -1039,12 +1906,12 @@ private:
         currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
     }
 
-    VkShaderModule createShaderModule(const std::vector<char>& code)
+    VkShaderModule createShaderModule(const std::vector<uint32_t>& code) const
     {
         VkShaderModuleCreateInfo createInfo{};
         createInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = code.size();
-        createInfo.pCode    = reinterpret_cast<const uint32_t*>(code.data());
+        createInfo.codeSize = code.size() * sizeof(uint32_t);
+        createInfo.pCode    = code.data();
 
         VkShaderModule shaderModule;
         if (vkCreateShaderModule(device->handle(), &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
@@ -1128,29 +1995,64 @@ private:
 
         return true;
     }
+};
 
-    static std::vector<char> readFile(const std::string& filename)
-    {
-        std::ifstream file(filename, std::ios::ate | std::ios::binary);
+int main(int argc, char* argv[])
+{
+    // --benchmark [object_count]: 运行 CPU 视锥剔除基准，不创建窗口与设备
+    if (argc > 1 && std::strcmp(argv[1], "--benchmark") == 0) {
+        size_t object_count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+        run_frustum_culling_benchmark(object_count);
+        return EXIT_SUCCESS;
+    }
 
-        if (!file.is_open()) {
-            throw std::runtime_error("failed to open file!");
-        }
+    // --benchmark-sort [draw_count]: 运行绘制队列排序基准
+    if (argc > 1 && std::strcmp(argv[1], "--benchmark-sort") == 0) {
+        size_t draw_count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+        run_render_queue_benchmark(draw_count);
+        return EXIT_SUCCESS;
+    }
 
-        size_t            fileSize = (size_t) file.tellg();
-        std::vector<char> buffer(fileSize);
+    // --benchmark-clusters: 运行 CPU 光源分簇基准
+    if (argc > 1 && std::strcmp(argv[1], "--benchmark-clusters") == 0) {
+        run_light_clustering_benchmark();
+        return EXIT_SUCCESS;
+    }
 
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
+    // --benchmark-mesh [grid_size]: 运行导入期网格优化基准
+    if (argc > 1 && std::strcmp(argv[1], "--benchmark-mesh") == 0) {
+        uint32_t grid_size = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 512;
+        run_mesh_optimizer_benchmark(grid_size);
+        return EXIT_SUCCESS;
+    }
 
-        file.close();
+    // --benchmark-spirv [iterations]: 比较场景着色器在各优化级别下的 SPIR-V 大小与编译耗时
+    if (argc > 1 && std::strcmp(argv[1], "--benchmark-spirv") == 0) {
+        uint32_t iterations = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 20;
+        run_spirv_optimization_benchmark({{VK_SHADER_STAGE_VERTEX_BIT, SCENE_VERTEX_SHADER},
+                                          {VK_SHADER_STAGE_FRAGMENT_BIT, SCENE_FRAGMENT_SHADER}},
+                                         std::max(iterations, 1u));
+        return EXIT_SUCCESS;
+    }
 
-        return buffer;
+    // --hot-reload [dir]: 场景着色器从 dir（默认 shaders）读取并监视修改
+    if (argc > 1 && std::strcmp(argv[1], "--hot-reload") == 0) {
+        shaderDirectory = argc > 2 ? argv[2] : "shaders";
+    }
+
+    // --benchmark-lights [frames]: 创建窗口与设备，扫描 16 ~ 16384 个光源并输出平均帧时间
+    if (argc > 1 && std::strcmp(argv[1], "--benchmark-lights") == 0) {
+        lightBenchmarkFrames = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 200;
+        lightBenchmarkFrames = std::max(lightBenchmarkFrames, 1u);
+    }
+
+    // --dynamic-rendering: 以 vkCmdBeginRendering 代替渲染通道与帧缓冲，可与其他参数同时使用
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--dynamic-rendering") == 0) {
+            dynamicRendering = true;
+        }
     }
-};
 
-int main()
-{
     VK_CHECK(volkInitialize());
 
     static vk::DynamicLoader dl;